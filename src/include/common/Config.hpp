@@ -32,18 +32,67 @@ typedef unsigned int *BufType;
 #define HASH_PRIME_2 89
 
 // Cache
-#define CACHE_CAPACITY 6000
+#define CACHE_CAPACITY 6000  // 默认缓存页数, 可在运行时指定
+#define HUGE_PAGE_SIZE (2 << 20)  // BYTE
+#define FLUSH_BATCH_PAGES 256     // 后台写回每批最多的页数
+#define FLUSH_MIN_AGE 64          // 后台写回跳过最近访问过的页
+#define READ_AHEAD_PAGES 32       // 顺序扫描时一次预读的页数
+
+// File Manager
+#define FD_TABLE_CHUNK_SIZE 1024
+#define FD_TABLE_CHUNK_NUM 4096  // 最多同时打开 4M 个文件
+#define IO_URING_DEPTH 64        // 批量读写同时在途的请求数
 
 // Record Manager
 #define RECORD_META_DATA_LENGTH 80  // BYTE
 #define RECORD_META_DATA_HEAD 32    // BYTE
-#define MAX_COLUMN_NUM 102
+#define MAX_COLUMN_NUM 101
 #define RECORD_PAGE_HEADER 64  // BYTE
-#define MAX_ITEM_PER_PAGE 512
+#define MAX_ITEM_PER_PAGE 480  // 页头最后一个 buf 留给空闲页链表
+// 空闲页链表: 页 0 最后一列元数据之后的 buf 存放标记和链表头,
+// 数据页页头的最后一个 buf 存放下一个空闲页 (0 表示不在链表中)
+#define RECORD_FREE_LIST_BUF \
+    ((RECORD_META_DATA_HEAD + MAX_COLUMN_NUM * RECORD_META_DATA_LENGTH) / \
+     BYTE_PER_BUF)
+#define RECORD_FREE_LIST_MAGIC 0x4653504dU  // "FSPM"
+#define RECORD_FREE_LINK_BUF (RECORD_PAGE_HEADER / BYTE_PER_BUF - 1)
+#define RECORD_FREE_LINK_END 0xffffffffU
+// 记录格式版本, 位于页 0 空闲页链表之后
+// 0: 旧格式, 槽长为实际长度的两倍; 1: 紧凑格式, 槽长等于实际长度
+#define RECORD_FORMAT_BUF (RECORD_FREE_LIST_BUF + 2)
+#define RECORD_FORMAT_COMPACT 1
+// 2: 变长格式, 页头之后为槽目录, 记录从页尾向前存放, 过长的 VARCHAR 放入溢出页
+#define RECORD_FORMAT_SLOTTED 2
+// 3: PAX 格式, 槽数与紧凑格式相同, 但页内每个字段 (id, null 位图, 各列)
+// 各自连续存放在一个 minipage 中, 第 i 条记录的字段在 minipage 的第 i 个位置
+#define RECORD_FORMAT_PAX 3
+// 有 varchar_space 不小于此值的列时建表使用变长格式
+#define RECORD_SLOTTED_VARCHAR_SPACE 64
+// 槽目录: 第一个 buf 为槽数和数据区起点, 之后每个 buf 为一条记录的偏移和长度
+#define RECORD_SLOT_DIR_BUF (RECORD_PAGE_HEADER / BYTE_PER_BUF)
+// 一条记录在页内的最大长度 (BYTE), 超过时最长的 VARCHAR 依次移入溢出页
+#define RECORD_SLOTTED_INLINE_MAX ((PAGE_SIZE - RECORD_PAGE_HEADER) / 4)
+// 溢出页的 RECORD_FREE_LINK_BUF 处的标记, 扫描和空闲页链表都跳过这些页
+#define RECORD_OVERFLOW_PAGE 0xfffffffeU
+// 溢出页: 页头之后为下一页号和本页字节数, 之后为数据
+#define RECORD_OVERFLOW_HEADER (RECORD_PAGE_HEADER + 8)  // BYTE
+// 空闲溢出页链表的头, 位于页 0
+#define RECORD_OVERFLOW_LIST_BUF (RECORD_FREE_LIST_BUF + 3)
+// 变长格式中 VARCHAR 长度为此值时数据在溢出页中
+#define RECORD_VARCHAR_OVERFLOW 0xffff
+// 导入 CSV 时每个线程一次解析的字节数, 以及最多的解析线程数
+#define CSV_CHUNK_SIZE (1 << 20)  // BYTE
+#define CSV_MAX_THREADS 8
 
 // Index Manager
 #define INDEX_HEADER_BYTE_LEN 16         // BYTE
 #define INDEX_BITMAP_PAGE_BYTE_LEN 8188  // BYTE
+// 批量建索引时每个节点填入的子节点数占 M 的比例, 留出空间给之后的插入
+#define INDEX_BULK_FILL_FACTOR 0.9
+// VARCHAR 列在索引键中只保留的前缀字节数, 须为 BYTE_PER_BUF 的倍数
+#define INDEX_VARCHAR_PREFIX_BYTE_LEN 16  // BYTE
+// 按索引查找时每批从索引读出的记录位置数
+#define INDEX_SCAN_BATCH 1024
 
 // Data Path
 #define DATABASE_PATH "./data"
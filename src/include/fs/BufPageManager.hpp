@@ -1,9 +1,14 @@
 #pragma once
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include "fs/FileManager.hpp"
 #include "fs/FindReplace.hpp"
+#include "fs/PageTable.hpp"
 #include "utils/BitMap.hpp"
-#include "utils/HashMap.hpp"
 
 namespace dbs {
 namespace fs {
@@ -12,9 +17,6 @@ struct PageLocation {
     int fileID, pageID;
     PageLocation() : fileID(-1), pageID(-1) {} 
     PageLocation(int fileID_, int pageID_) : fileID(fileID_), pageID(pageID_) {}
-    utils::HashItemTwoInt toHashItem() {
-        return utils::HashItemTwoInt(fileID, pageID);
-    }
 };
 
 class BufPageManager {
@@ -22,14 +24,25 @@ public:
     /**
      * @brief Construct a new Buf Page Manager object
      * @param fm file manager
+     * @param capacity_ number of page frames in the buffer
+     * @param policy replacement policy of the buffer
+     * @param huge_pages back the frames with huge pages if possible
+     * @param read_only_ read-only mode: files that are not empty when
+     * first visited are mmaped, getPage returns pointers into the mapping
+     * with index -1 and the pages must not be modified; files created in
+     * this session (e.g. temporary files) still use the buffer
      */
-    BufPageManager(FileManager* fm);
+    BufPageManager(FileManager* fm, int capacity_ = CACHE_CAPACITY,
+                   ReplacePolicy policy = ReplacePolicy::LRU,
+                   bool huge_pages = false, bool read_only_ = false);
     /**
      * @brief Destroy the Buf Page Manager object
      */
     ~BufPageManager();
     /**
      * @brief Get the Page object
+     * the frame is pinned until the following access or markDirty,
+     * the background writer does not copy pinned frames
      * 
      * @param fileID file id 
      * @param pageID page num
@@ -38,13 +51,16 @@ public:
      */
     BufType getPage(int fileID, int pageID, int& index);
     /**
-     * @brief must be called after visit the page (identified by the index)
+     * @brief must be called after visit the page (identified by the index),
+     * unpins the frame, the page must not be modified afterwards
+     * index -1 (mapped page in read-only mode) is ignored
      * 
      * @param index 
      */
     void access(int index);
     /**
-     * @brief must be called after modify the page (identified by the index)
+     * @brief must be called after modify the page (identified by the index),
+     * unpins the frame, every modification must be made before this call
      * if called markDirty, no need to call access
      * 
      * @param index 
@@ -54,18 +70,131 @@ public:
      * @brief release every opened page, must be called when exisiting the program 
      */
     void close();
+    /**
+     * @brief write back every dirty page but keep them in the buffer
+     * (checkpoint), the cache stays warm for the following statements
+     */
+    void flush();
+    /**
+     * @brief write back and release the pages of one file,
+     * must be called before closing the file
+     *
+     * @param fileID
+     */
+    void closeFile(int fileID);
+    /**
+     * @brief read pages [pageID, pageID + count) that are not yet buffered
+     * into the buffer, adjacent pages are read with a single preadv
+     * (scan hint, called before walking the pages one by one)
+     *
+     * @param fileID
+     * @param pageID first page
+     * @param count number of pages, at most a quarter of the buffer is used
+     */
+    void prefetch(int fileID, int pageID, int count);
+    /**
+     * @brief read the given pages of a file that are not yet buffered,
+     * the runs of adjacent pages are submitted as one batch
+     * (e.g. the leaves covered by an index range scan)
+     *
+     * @param fileID
+     * @param pageIDs pages in any order, at most a quarter of the buffer
+     * and READ_AHEAD_PAGES pages are read
+     */
+    void prefetchPages(int fileID, std::vector<int> pageIDs);
+    /**
+     * @brief start the background writer thread, which writes dirty pages
+     * back every interval_ms milliseconds, or earlier when a quarter of the
+     * buffer is dirty, so that evictions seldom have to write
+     *
+     * @param interval_ms
+     */
+    void startFlusher(int interval_ms);
+    /**
+     * @brief stop the background writer thread
+     */
+    void stopFlusher();
+    /**
+     * @brief Get the hit/miss/eviction counters of the buffer
+     */
+    ReplaceStats getStats() const { return replace->getStats(); }
+    /**
+     * @brief Get the number of page frames in the buffer
+     */
+    int getCapacity() const { return capacity; }
+    /**
+     * @brief whether the buffer is in read-only (mmap) mode
+     */
+    bool isReadOnly() const { return read_only; }
 private:
+    struct FileMapping {
+        int state;      // 0 未访问, 1 已映射, 2 使用缓存 (首次访问时为空文件)
+        BufType base;
+        size_t length;
+        size_t pages;   // 映射中的完整页数
+        int next_page;  // 顺序访问检测
+        bool sequential;
+    };
+    FileMapping* getMapping(int fileID);
+    BufType mappedPage(int fileID, int pageID);
+    void unmapFile(int fileID);
+    struct FlushEntry {
+        int fileID, pageID, index;
+        unsigned long long version;
+    };
+    std::unique_lock<std::mutex> lockIfShared(std::mutex& m);
+    void touch(int index);
+    void unpin(int index);
+    int readAhead(int fileID, int pageID, int count, int demand_page);
+    int loadPages(int fileID, int demand_page);
+    void installPage(int fileID, int pageID, int index);
+    void flusherLoop();
+    int flushBatch();
     BufType fetchPage(int fileID, int pageID, int& index);
-    BufType allocMem();
+    BufType allocArena(bool huge_pages);
     void release(int index);
     void writeBack(int index);
     FindReplace* replace;
     utils::BitMap* dirty;
+    BufType arena;  // 所有帧所在的连续内存
+    size_t arena_size;
     BufType* addr;
     FileManager* fileManager;
-    utils::HashMap<utils::HashItemTwoInt>* hash;
+    PageTable* hash;
     PageLocation* pageLocation;
     int last_visit_index;
+    int capacity;
+    int dirty_num;
+
+    // 顺序访问检测: 上一次缺页所在的文件和下一页, 以及连续缺页次数
+    int seq_file_id, seq_next_page, seq_run;
+    std::vector<int> prefetch_frames;
+    std::vector<BufType> prefetch_bufs;
+    std::vector<int> prefetch_pages;
+    std::vector<PageRequest> prefetch_reqs;
+
+    // 后台写回线程, 为空时所有操作在调用线程中完成且不加锁
+    // mutex 保护缓存的元数据, io_mutex 保证同一页的写回按顺序落盘
+    // 加锁顺序总是 mutex -> io_mutex
+    std::thread* flusher;
+    std::mutex mutex, io_mutex;
+    std::condition_variable flusher_cv;
+    bool flusher_stop;
+    int flush_interval;
+    unsigned long long* dirty_version;  // 每次 markDirty 加一
+    int* pin_count;  // getPage 之后 access/markDirty 之前, 调用者可能在写该帧
+    unsigned long long* last_access;    // 最近一次访问时的 access_clock
+    unsigned long long access_clock;    // 访问不同的页时加一
+    std::vector<FlushEntry> flush_entries;
+    std::vector<PageRequest> flush_reqs;
+    BufType staging;  // 写回前的页快照
+    BufType* staging_bufs;
+    int flush_cursor;
+
+    // 只读模式: 按 fileID 下标的文件映射
+    bool read_only;
+    std::vector<FileMapping> mappings;
+    BufType zero_page;  // 文件末尾之后的页, 只读且全 0
 };
 
 }  // namespace fs
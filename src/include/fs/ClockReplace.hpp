@@ -0,0 +1,30 @@
+#pragma once
+
+#include "fs/FindReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief CLOCK (second chance) 替换策略
+ * 每帧一个访问位, 指针循环扫描, 跳过访问位为 1 的帧并清零
+ */
+class ClockReplace : public FindReplace {
+public:
+    ClockReplace(int capacity_);
+    ~ClockReplace();
+
+protected:
+    void onInsert(int index) override;
+    void onAccess(int index) override;
+    int evict() override;
+    void onRemove(int index) override;
+
+private:
+    bool* referenced;
+    bool* resident;
+    int hand;
+};
+
+}  // namespace fs
+}  // namespace dbs
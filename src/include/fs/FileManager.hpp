@@ -1,21 +1,51 @@
 #pragma once
 
 #include <iostream>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
 #include <cstdio>
-#include <map>
+#include <cstring>
+#include <mutex>
+#include <vector>
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
 #include <dirent.h>
 
 #include "common/Config.hpp"
+#include "fs/IOUring.hpp"
 
 namespace dbs {
 namespace fs{
 
+/**
+ * @brief 页读写的系统调用次数
+ */
+struct IOStats {
+    long long read_calls;
+    long long write_calls;
+    long long ring_calls;  // io_uring_enter
+};
+
+/**
+ * @brief 批量读写中的一段连续页
+ */
+struct PageRequest {
+    int fileID, pageID;
+    BufType* bufs;  // page pageID + i <-> bufs[i]
+    int count;      // 不超过 FLUSH_BATCH_PAGES
+    int done;       // 完成后为成功读写的页数
+};
+
 class FileManager {
 public:
+    FileManager();
+    ~FileManager();
+
     /**
      * @brief write to page, 将buf+off开始的2048个四字节整数(8kb信息)
      * 写入fileID和pageID指定的文件页中
@@ -27,6 +57,17 @@ public:
      */
     bool writePage(int fileID, int pageID, BufType buf, int off);
 
+    /**
+     * @brief write count consecutive pages starting at pageID
+     * with as few pwritev calls as possible
+     * @param fileID: file id
+     * @param pageID: first page id
+     * @param bufs: buffers of the pages, bufs[i] is written to pageID + i
+     * @param count: number of pages
+     * @return true if success, false otherwise
+     */
+    bool writePages(int fileID, int pageID, BufType* bufs, int count);
+
     /**
      * @brief read from page, 将fileID和pageID指定的文件页中
      * 2048个四字节整数(8kb)读入到buf+off开始的内存中
@@ -38,6 +79,54 @@ public:
      */
     bool readPage(int fileID, int pageID, BufType buf, int off);
 
+    /**
+     * @brief read count consecutive pages starting at pageID
+     * with as few preadv calls as possible
+     * @param fileID: file id
+     * @param pageID: first page id
+     * @param bufs: buffers of the pages, page pageID + i is read into bufs[i]
+     * @param count: number of pages
+     * @return number of pages fully read (less than count at the end of file)
+     */
+    int readPages(int fileID, int pageID, BufType* bufs, int count);
+
+    /**
+     * @brief read several runs of consecutive pages at once, the runs are
+     * submitted together through io_uring if enabled, otherwise read one
+     * by one with readPages
+     * @param reqs: runs to read, reqs[i].done is set to the number of pages
+     * fully read
+     * @param n: number of runs
+     */
+    void readPagesBatch(PageRequest* reqs, int n);
+
+    /**
+     * @brief write several runs of consecutive pages at once, see
+     * readPagesBatch
+     * @param reqs: runs to write, reqs[i].done is set to the number of pages
+     * written
+     * @param n: number of runs
+     * @return true if every page is written, false otherwise
+     */
+    bool writePagesBatch(PageRequest* reqs, int n);
+
+    /**
+     * @brief submit batched page io through io_uring
+     * @param depth: queue depth
+     * @return false if io_uring is not available, the batches are then
+     * done with synchronous calls
+     */
+    bool enableAsyncIO(unsigned depth = IO_URING_DEPTH);
+
+    /**
+     * @brief map a whole file read-only (PROT_READ, MAP_SHARED)
+     * @param fileID: file id
+     * @param length: set to the length of the mapping
+     * @return start of the mapping, nullptr if the file is empty or
+     * cannot be mapped, unmap with munmap(base, length)
+     */
+    BufType mapFile(int fileID, size_t& length);
+
     /**
      * @brief close file, 关闭文件，关闭前务必保证调用过bpm->close()
      */
@@ -92,9 +181,34 @@ public:
      * @return true if success, false otherwise
      */
     bool deleteFolder(const char* path);
+    /**
+     * @brief Get the number of read/write system calls issued for pages
+     */
+    IOStats getIOStats() const {
+        return IOStats{read_calls, write_calls, ring_calls};
+    }
 private:
-    std::map<int, int> fd;
-    uint file_id = 0;
+    int getFd(int fileID);
+    void setFd(int fileID, int f);
+    bool preadFull(int f, void* buf, size_t len, off_t offset);
+    bool pwriteFull(int f, const void* buf, size_t len, off_t offset);
+    void submitBatch(PageRequest* reqs, int n, bool write);
+    // fileID -> fd, 按块分配, 块一旦分配就不再移动
+    // 后台写回线程不加锁地查表, 所以块指针和表项都是原子变量
+    std::atomic<std::atomic<int>*> fd_table[FD_TABLE_CHUNK_NUM];
+    // 关闭的 fileID 留给之后打开的文件, 表只随同时打开的文件数增长
+    // 打开和关闭文件由 id_mutex 保护
+    std::mutex id_mutex;
+    std::vector<int> free_ids;
+    int next_file_id = 0;
+    std::atomic<long long> read_calls{0}, write_calls{0}, ring_calls{0};
+    // io_uring, 为空时批量读写退回同步调用
+    // 前台和后台写回线程都可能提交, 由 ring_mutex 保护
+    IOUring* ring = nullptr;
+    std::mutex ring_mutex;
+    std::vector<struct iovec> ring_iovs;
+    std::vector<IOUring::Request> ring_reqs;
+    std::vector<int> ring_owner, ring_results;
 };
 
 }  // namespace fs
@@ -1,23 +1,96 @@
 #pragma once
 
-#include "utils/LinkList.hpp"
+#include <string>
 
 namespace dbs {
 namespace fs {
 
-class FindReplace{
+/**
+ * @brief 缓存命中统计
+ */
+struct ReplaceStats {
+    long long hits = 0;
+    long long misses = 0;
+    long long evictions = 0;   // 换出仍在使用中的帧的次数
+    long long prefetches = 0;  // 预读装入的页数, 不计入 misses
+};
+
+/**
+ * @brief 缓存替换策略
+ */
+enum class ReplacePolicy { LRU, CLOCK, LRU_K, TWO_Q };
+
+/**
+ * @brief 由名字解析替换策略 (lru, clock, lru2, 2q)
+ * @return true if success, false otherwise
+ */
+bool parseReplacePolicy(const std::string& name, ReplacePolicy& policy);
+
+/**
+ * @brief 替换策略基类
+ * 空闲帧由基类维护 (优先复用), 只有缓存满时才交给具体策略选出换出的帧
+ * 所有操作不分配内存
+ */
+class FindReplace {
 public:
     FindReplace(int capacity_);
-    ~FindReplace();
-    int find();
+    virtual ~FindReplace();
+    /**
+     * @brief 创建指定策略的替换器
+     */
+    static FindReplace* create(ReplacePolicy policy, int capacity);
+    /**
+     * @brief 缺页时选出用于装入新页的帧
+     * @param prefetch 是否为预读
+     * @return 帧下标
+     */
+    int find(bool prefetch = false);
+    /**
+     * @brief 释放帧, 之后优先复用
+     */
     void free(int index);
+    /**
+     * @brief 访问帧
+     */
     void access(int index);
+    /**
+     * @brief 记录一次缓存命中
+     */
+    void hit() { stats.hits++; }
+    /**
+     * @brief Get the hit/miss/eviction counters
+     */
+    ReplaceStats getStats() const { return stats; }
+    /**
+     * @brief reset the counters
+     */
+    void resetStats() { stats = ReplaceStats(); }
 
-private:
-    utils::LinkList<int> *list;
-    utils::LinkListNode<int> **node;
+protected:
+    /**
+     * @brief 新页装入帧 index
+     */
+    virtual void onInsert(int index) = 0;
+    /**
+     * @brief 帧 index 被再次访问
+     */
+    virtual void onAccess(int index) = 0;
+    /**
+     * @brief 选出换出的帧并将其移出策略的数据结构
+     */
+    virtual int evict() = 0;
+    /**
+     * @brief 帧 index 被释放, 将其移出策略的数据结构
+     */
+    virtual void onRemove(int index) = 0;
     int capacity;
+
+private:
+    int* free_frames;  // 空闲帧栈
+    int free_num;
+    bool* used;
+    ReplaceStats stats;
 };
 
 }  // namespace fs
-}  // namespace dbs
\ No newline at end of file
+}  // namespace dbs
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief 基于 io_uring 的批量向量读写, 直接使用系统调用, 不依赖 liburing
+ * 内核或头文件不支持时 create 返回 nullptr, 调用者应退回同步读写
+ * 不是线程安全的, 由调用者加锁
+ */
+class IOUring {
+public:
+    /**
+     * @brief 一次向量读写请求
+     */
+    struct Request {
+        int fd;
+        bool write;
+        const struct iovec* iov;  // 完成之前必须保持有效
+        int iovcnt;
+        off_t offset;
+    };
+    /**
+     * @brief Create an io_uring instance
+     * @param entries 队列深度
+     * @return nullptr if io_uring is not available
+     */
+    static IOUring* create(unsigned entries);
+    /**
+     * @brief Destroy the IOUring object
+     */
+    ~IOUring();
+    /**
+     * @brief 提交一批请求并等待全部完成, 同时在途的请求不超过队列深度
+     * @param reqs requests
+     * @param n number of requests
+     * @param results results[i] 为第 i 个请求传输的字节数, 出错时为 -errno
+     * @return number of io_uring_enter calls
+     */
+    int submitAndWait(const Request* reqs, int n, int* results);
+
+private:
+    IOUring();
+    bool setup(unsigned entries);
+    int ring_fd;
+    unsigned depth;
+    void* sq_ring;
+    void* cq_ring;
+    size_t sq_ring_size, cq_ring_size;
+    void* sqe_mem;
+    size_t sqe_mem_size;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    void* sqes;  // struct io_uring_sqe*
+    void* cqes;  // struct io_uring_cqe*
+};
+
+}  // namespace fs
+}  // namespace dbs
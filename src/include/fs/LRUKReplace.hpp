@@ -0,0 +1,43 @@
+#pragma once
+
+#include "fs/FindReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief LRU-K (K = 2) 替换策略
+ * 换出倒数第 2 次访问最早的帧; 只被访问过一次的帧距离视为无穷大, 按 LRU 优先换出
+ * 只访问一次的帧放在链表中, 访问过两次以上的帧放在以倒数第 2 次访问时间为键的小根堆中
+ * 帧被换出后不保留其历史
+ */
+class LRUKReplace : public FindReplace {
+public:
+    LRUKReplace(int capacity_);
+    ~LRUKReplace();
+
+protected:
+    void onInsert(int index) override;
+    void onAccess(int index) override;
+    int evict() override;
+    void onRemove(int index) override;
+
+private:
+    void unlink(int index);
+    void linkHead(int index);
+    void heapSwap(int a, int b);
+    void heapUp(int pos);
+    void heapDown(int pos);
+    void heapRemove(int pos);
+    long long timestamp;
+    long long* last;         // 最近一次访问时间
+    long long* second_last;  // 倒数第 2 次访问时间, -1 表示只访问过一次
+    int* prev;
+    int* next;  // 只访问一次的帧链表, 下标 capacity 为哨兵
+    int* heap;
+    int* heap_pos;
+    int heap_size;
+};
+
+}  // namespace fs
+}  // namespace dbs
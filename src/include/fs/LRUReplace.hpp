@@ -0,0 +1,31 @@
+#pragma once
+
+#include "fs/FindReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief LRU 替换策略, 用预分配的 prev/next 下标数组维护帧链表
+ * 表头为最近访问的帧, 表尾为下一个被替换的帧
+ */
+class LRUReplace : public FindReplace {
+public:
+    LRUReplace(int capacity_);
+    ~LRUReplace();
+
+protected:
+    void onInsert(int index) override;
+    void onAccess(int index) override;
+    int evict() override;
+    void onRemove(int index) override;
+
+private:
+    void unlink(int index);
+    void linkHead(int index);
+    int* prev;
+    int* next;  // 下标 capacity 为哨兵
+};
+
+}  // namespace fs
+}  // namespace dbs
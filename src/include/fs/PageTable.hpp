@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "common/Config.hpp"
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief 缓存页表, 以 (fileID, pageID) 为键, 缓存帧下标为值
+ * 开放寻址 + 线性探测, 删除时后移回填 (backward shift), 不使用墓碑
+ * 槽数为不小于 2 * capacity 的 2 的幂, 负载因子不超过 0.5
+ * 构造后不再分配内存
+ */
+class PageTable {
+public:
+    /**
+     * @brief Construct a new Page Table object
+     * @param capacity_ 最多同时存放的页数 (即缓存帧数)
+     */
+    PageTable(int capacity_);
+    /**
+     * @brief Destroy the Page Table object
+     */
+    ~PageTable();
+    /**
+     * @brief 查找页所在的缓存帧
+     * @param fileID file id
+     * @param pageID page id
+     * @return 缓存帧下标, 不存在时返回 -1
+     */
+    int find(int fileID, int pageID) const {
+        uint64_t key = makeKey(fileID, pageID);
+        for (uint32_t pos = hash(key);; pos = (pos + 1) & mask) {
+            const Slot& slot = slots[pos];
+            if (slot.val == -1) return -1;
+            if (slot.key == key) return slot.val;
+        }
+    }
+    /**
+     * @brief 插入一条映射, 调用者保证该页不在表中且表未满
+     * @param fileID file id
+     * @param pageID page id
+     * @param index 缓存帧下标
+     */
+    void insert(int fileID, int pageID, int index);
+    /**
+     * @brief 删除一条映射
+     * @param fileID file id
+     * @param pageID page id
+     * @return true 删除成功, false 该页不在表中
+     */
+    bool del(int fileID, int pageID);
+    /**
+     * @brief 清空页表
+     */
+    void clear();
+
+private:
+    struct Slot {
+        uint64_t key;
+        int val;  // -1 表示空槽
+    };
+    static uint64_t makeKey(int fileID, int pageID) {
+        return ((uint64_t)(uint32_t)fileID << 32) | (uint32_t)pageID;
+    }
+    uint32_t hash(uint64_t key) const {
+        // Fibonacci hashing, 取乘积的高位
+        return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> shift);
+    }
+    Slot* slots;
+    uint32_t mask;
+    int shift;
+    int capacity;
+};
+
+}  // namespace fs
+}  // namespace dbs
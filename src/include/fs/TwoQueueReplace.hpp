@@ -0,0 +1,35 @@
+#pragma once
+
+#include "fs/FindReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+/**
+ * @brief 2Q 替换策略 (simplified 2Q)
+ * 新装入的页进入先进先出队列 A1, 在 A1 中再次被访问时移入 LRU 队列 Am
+ * A1 超过容量的 1/4 时优先从 A1 换出, 顺序扫描的页因此不会挤掉 Am 中的热页
+ */
+class TwoQueueReplace : public FindReplace {
+public:
+    TwoQueueReplace(int capacity_);
+    ~TwoQueueReplace();
+
+protected:
+    void onInsert(int index) override;
+    void onAccess(int index) override;
+    int evict() override;
+    void onRemove(int index) override;
+
+private:
+    void unlink(int index);
+    void linkHead(int head, int index);
+    int a1_head, am_head;  // 两个链表的哨兵下标
+    int a1_size, a1_limit;
+    int* prev;
+    int* next;
+    bool* in_a1;
+};
+
+}  // namespace fs
+}  // namespace dbs
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "index/IndexType.hpp"
+
+namespace dbs {
+namespace index {
+
+class IndexManager;
+
+/**
+ * @brief 在索引上按键从小到大逐项读出 [low, high] 范围内的索引项
+ * 只记住当前的叶节点和位置, 每次 next 在页上读一项, 不把结果全部读出
+ * 使用期间不能修改这个索引
+ */
+class IndexCursor {
+   public:
+    /**
+     * @brief Construct a new Index Cursor object
+     * @param im_ index manager, 生命周期要长于 IndexCursor
+     */
+    IndexCursor(IndexManager* im_);
+
+    /**
+     * @brief 定位到第一个不小于 search_value_low 的索引项
+     * @return true success， false fail (key数量不符)
+     */
+    bool seek(const char* file_path, const IndexValue& search_value_low,
+              const IndexValue& search_value_high);
+    /**
+     * @brief 读出当前项并移到下一项
+     * @return false 表示没有更多不大于 search_value_high 的项
+     */
+    bool next(IndexValue& index_value);
+    /**
+     * @brief 结束查找, 之后 next 返回 false
+     */
+    void close();
+
+   private:
+    IndexManager* im;
+    std::string file_path;
+    int index_key_num;
+    std::vector<int> search_key_high;
+    // 下一项所在的叶节点和位置, 叶节点为 -1 时已经结束
+    int leaf_page_id;
+    int pos;
+};
+
+}  // namespace index
+}  // namespace dbs
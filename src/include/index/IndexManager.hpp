@@ -11,6 +11,8 @@ namespace dbs {
 namespace index {
 
 class IndexManager {
+    friend class IndexCursor;
+
    public:
     /**
      * @brief Construct a new Index Manager object
@@ -45,6 +47,19 @@ class IndexManager {
      */
     bool insertIndex(const char* file_path, const IndexValue& index_value);
 
+    /**
+     * @brief 用排好序的索引项自底向上重建整个索引, 原有的索引项全部丢弃
+     * 叶节点和各层内部节点依次写入连续的新页, 每个节点按填充率装满
+     *
+     * @param file_path index file path
+     * @param index_values 按 sortIndexValues 的顺序排列
+     * @param fill_factor 每个节点的子节点数占 M 的比例
+     * @return true success false fail (key数量不符)
+     */
+    bool bulkLoadIndex(const char* file_path,
+                       const std::vector<IndexValue>& index_values,
+                       double fill_factor = INDEX_BULK_FILL_FACTOR);
+
     /**
      * @brief delete index, 如果匹配的有多个，删除第一个；exact
      * match尽量选false，效率更高
@@ -82,6 +97,20 @@ class IndexManager {
                              const IndexValue& search_value_high,
                              std::vector<IndexValue>& search_results);
 
+    /**
+     * @brief 批量查找多个键是否在索引中 (key exact match)
+     * 键按从小到大的顺序沿叶节点链表查找, 下一个键仍在当前或下一个叶节点中时
+     * 不再从根节点向下查找
+     *
+     * @param file_path index file path
+     * @param search_keys 按字典序从小到大排列
+     * @param found 返回每个键是否存在
+     * @return true success， false fail (key数量不符)
+     */
+    bool searchIndexBatch(const char* file_path,
+                          const std::vector<std::vector<int>>& search_keys,
+                          std::vector<bool>& found);
+
     /**
      * @brief delete an index file
      *
@@ -97,48 +126,6 @@ class IndexManager {
     void closeAllCurrentFile();
 
    private:
-    /**
-     * @brief write a tree interal node into a buftype b,
-     * 调用之后需要显式调用markdirty
-     * @param b
-     * @param node
-     * @param index_key_num
-     */
-    void writeBPlusTreeInternalNode2Page(BufType b,
-                                         const BPlusTreeInternalNode& node,
-                                         int index_key_num);
-
-    /**
-     * @brief write a tree leaf node into a buftype b,
-     * 调用之后需要显式调用markdirty
-     * @param b
-     * @param node
-     * @param index_key_num
-     */
-    void writeBPlusTreeLeafNode2Page(BufType b, const BPlusTreeLeafNode& node,
-                                     int index_key_num);
-
-    /**
-     * @brief read a tree interal node from a buftype b,
-     * 调用之后需要显式调用access
-     * @param b
-     * @param node
-     * @param index_key_num
-     */
-    void readBPlusTreeInternalNodeFromPage(BufType b,
-                                           BPlusTreeInternalNode& node,
-                                           int index_key_num);
-
-    /**
-     * @brief read a tree leaf node from a buftype b,
-     * 调用之后需要显式调用access
-     * @param b
-     * @param node
-     * @param index_key_num
-     */
-    void readBPlusTreeLeafNodeFromPage(BufType b, BPlusTreeLeafNode& node,
-                                       int index_key_num);
-
     /**
      * @brief 创建一个空的bitmap页，如果页上有值，则全部覆盖
      *
@@ -193,109 +180,78 @@ class IndexManager {
     void closeFirstFile();
     void closeFileIfExist(const char* file_path);
 
+    /**
+     * @brief 为同一层的node_num个节点分配页面
+     * @param first_page_id 不为-1时第一个节点使用该页面
+     * @param page_ids 返回各节点的页号
+     */
+    void allocateNodePages(int file_id, int node_num, int first_page_id,
+                           std::vector<int>& page_ids);
+
     /**
      * @brief 从page_id对应的节点向下找，插入叶节点
      * 不会处理调用根节点的上溢问题，需要调用者自行处理
+     * 每层在页上二分查找子节点, 插入时移动后面的子节点, 不读出整个节点
      * @param file_id
      * @param page_id
-     * @param insert_item
+     * @param insert_value
      * @param index_key_num
      * @param b_plus_tree_m
      */
-    void insertNode(int file_id, int page_id,
-                    const BPlusTreeLeafChild& insert_item, int index_key_num,
-                    int b_plus_tree_m);
+    void insertNode(int file_id, int page_id, const IndexValue& insert_value,
+                    int index_key_num, int b_plus_tree_m);
 
     /**
      * @brief
      * 返回第一个大于等于search_value的叶节点的位置
      * @param file_id
      * @param page_id
-     * @param index_value
-     * @param leaf_result
+     * @param search_key
+     * @param leaf_page_id 找到的叶节点页号
+     * @param search_key_high 范围查询的上界, 不为空时预读范围内的其余叶节点
      * @return true 成功 false 失败 （没有找到）
      */
-    bool searchNode(int file_id, int page_id,
-                    const BPlusTreeLeafChild& search_value, int index_key_num,
-                    BPlusTreeLeafNode& leaf_result);
-
-    bool deleteNode(int file_id, int page_id,
-                    const BPlusTreeLeafChild& delete_value, bool exact_match,
-                    int index_key_num, int b_plus_tree_m);
+    bool searchNode(int file_id, int page_id, const int* search_key,
+                    int index_key_num, int& leaf_page_id,
+                    const int* search_key_high = nullptr);
 
     /**
-     * @brief
-     * 检查插入子节点的时候，子节点是否出现了上溢；
-     * 如果没有，返回false，代表当前节点不需要修改；
-     * 如果有，相应的修改node，返回true；
-     * 如果当前节点因为子节点的上溢而上溢，则split成当前节点和一个新节点，
-     * 新节点写入文件，修改同级页面内的链表指针，
-     * 相应修改node和tmp_tree_internal_child和node，返回true；
-     *
-     * @param file_id
-     * @param page_id 原节点所在的页号
-     * @param node 原节点
-     * @param insert_pos 插入孩子的位置
-     * @param index_key_num 键的数量
-     * @param b_plus_tree_m B+树的M值
-     * @return
+     * @brief 范围查询时, 若内部节点页b的第pos个子节点是叶节点, 预读之后
+     * 上界search_key_high之前的叶节点
      */
-    bool handleInternalNodeOverflow(
-        int file_id, int page_id, BPlusTreeInternalNode& node,
-        const std::list<BPlusTreeInternalChild>::iterator& insert_pos,
-        int index_key_num, int b_plus_tree_m);
+    void prefetchLeaves(int file_id, BufType b, int pos,
+                        const int* search_key_high, int index_key_num);
+
+    bool deleteNode(int file_id, int page_id, const IndexValue& delete_value,
+                    bool exact_match, int index_key_num, int b_plus_tree_m);
 
     /**
      * @brief
-     * 检查插入叶节点的时候，叶节点是否出现了上溢；
-     * 如果没有，返回false，代表当前节点不需要修改；
-     * 如果有，相应的修改node，返回true；
-     * 如果当前节点上溢，则split成当前节点和一个新节点，
-     * 新节点写入文件，修改同级页面内的链表指针，
-     * 相应修改node和tmp_tree_internal_child和node，返回true；
-     *
+     * 节点page_id上溢时, 从中间(M + 1) / 2处分成两个节点,
+     * 后一半移入新的页面，修改同级页面内的链表指针，
+     * 并设置tmp_tree_internal_child为分裂后的两个节点
      * @param file_id
      * @param page_id
-     * @param node
-     * @param index_key_num
-     * @param b_plus_tree_m
-     */
-    void handleLeafNodeOverflow(int file_id, int page_id,
-                                BPlusTreeLeafNode& node, int index_key_num,
-                                int b_plus_tree_m);
-
-    /**
-     * @brief 把origin_node从中间(M + 1) /
-     * 2处分成两个节点，修改相应的page链表值，
-     * 并修改tmp_tree_internal_child
-     * @param origin_node
-     * @param origin_node_page_id
-     * @param new_node
-     * @param new_node_page_id
      * @param index_key_num
      * @param b_plus_tree_m
      */
-    void splitInternalNode(BPlusTreeInternalNode& origin_node,
-                           BPlusTreeInternalNode& new_node,
-                           int origin_node_page_id, int new_node_page_id,
-                           int index_key_num, int b_plus_tree_m);
+    void splitNode(int file_id, int page_id, int index_key_num,
+                   int b_plus_tree_m);
 
     /**
-     * @brief  把origin_node从中间(M + 1) /
-     * 2处分成两个节点，修改相应的page链表值，
-     * 并修改tmp_tree_internal_child
-     * @param origin_node
-     * @param new_node
-     * @param origin_node_page_id
-     * @param new_node_page_id
+     * @brief
+     * 删除节点page_id的第pos个子节点；
+     * 如果不足半满且有下一个同级节点，能合并则合并进下一个节点，否则借一个子节点；
+     * 合并或最后一个节点被删空时释放该页面并设置tmp_tree_underflow；
+     * 最大值变化时设置tmp_tree_internal_child[0]，否则其page_id为-1
+     * @param file_id
+     * @param page_id
+     * @param pos
      * @param index_key_num
      * @param b_plus_tree_m
-     * @return
      */
-    void splitLeafNode(BPlusTreeLeafNode& origin_node,
-                       BPlusTreeLeafNode& new_node, int origin_node_page_id,
-                       int new_node_page_id, int index_key_num,
-                       int b_plus_tree_m);
+    void removeChild(int file_id, int page_id, int pos, int index_key_num,
+                     int b_plus_tree_m);
 
     /**
      * @brief 在已有页面上写入节点链表中prev指针的值，mark dirty，其他不做修改
@@ -326,28 +282,30 @@ class IndexManager {
                                      int index_key_num);
 
     /**
-     * @brief
-     * 从base开始向后查找小于等于search_value_high的所有节点，递归放进search_results里
-     *
-     * @param file_id
-     * @param base_node
-     * @param base_slot_itr
-     * @param index_key_num
-     * @param search_value_high
-     * @param search_results
+     * @brief IndexCursor::seek 的实现, 找到第一个不小于search_value_low的
+     * 叶节点位置, 没有时leaf_page_id为-1
+     * @return true success， false fail (key数量不符)
+     */
+    bool seekLeafChild(const char* file_path,
+                       const IndexValue& search_value_low,
+                       const IndexValue& search_value_high,
+                       int& index_key_num, int& leaf_page_id, int& pos);
+
+    /**
+     * @brief IndexCursor::next 的实现, 从叶节点leaf_page_id的第pos项起
+     * 沿叶节点链表读出一项, 并把位置移到下一项
+     * @return false 没有更多小于等于search_key_high的项
      */
-    void searchForward(int file_id, const BPlusTreeLeafNode& base_node,
-                       int index_key_num,
-                       const BPlusTreeLeafChild& search_value_low,
-                       const BPlusTreeLeafChild& search_value_high,
-                       std::vector<IndexValue>& search_results);
+    bool nextLeafChild(const char* file_path, int index_key_num,
+                       const int* search_key_high, int& leaf_page_id,
+                       int& pos, IndexValue& index_value);
 
     fs::FileManager* fm;
     fs::BufPageManager* bpm;
 
     std::vector<char*> current_opening_file_paths;
     std::vector<int> current_opening_file_ids;
-    const int opening_cache_capacity = 10;
+    const int opening_cache_capacity = 64;
 
     // 插入时表示子节点是否上溢，上溢的话溢出的是哪两个节点
     // 删除时表示maxval是否变化了，仅第一项有效
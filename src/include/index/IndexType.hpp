@@ -2,7 +2,6 @@
 
 #include <climits>
 #include <iostream>
-#include <list>
 #include <vector>
 
 #include "common/Config.hpp"
@@ -38,6 +37,34 @@ struct IndexValue {
 void indexValueToRecordLocation(const std::vector<IndexValue>& index_values,
                                 std::vector<record::RecordLocation>& locations);
 
+/**
+ * @brief 一列在索引键中占的 int 数: INT 为 1, FLOAT 和 DATE 为 2,
+ * VARCHAR 为 INDEX_VARCHAR_PREFIX_BYTE_LEN / BYTE_PER_BUF
+ */
+int getIndexKeyLength(record::DataTypeName type_name);
+
+/**
+ * @brief 把一列的值编码后追加到 key 末尾, 编码后按 int 逐个比较的大小关系
+ * 与值的大小关系一致 (a <= b 时编码也 <=), INT 的编码就是值本身
+ * VARCHAR 只保留前缀, 不同的值编码可能相同, 查找后要再检查原值
+ * null 编码为全部 INT_MIN
+ */
+void appendIndexKey(const record::DataValue& value, std::vector<int>& key);
+
+/**
+ * @brief 追加一列的最小 (全部 INT_MIN) 或最大 (全部 INT_MAX) 编码,
+ * 用作范围查询中没有约束的列的上下界
+ */
+void appendIndexKeyBound(record::DataTypeName type_name, bool high,
+                         std::vector<int>& key);
+
+/**
+ * @brief 按键排序, 键相同时按原顺序的逆序,
+ * 与逐条 insertIndex 后叶节点中的顺序相同, 供 bulkLoadIndex 使用
+ */
+void sortIndexValues(std::vector<IndexValue>& index_values);
+
+// 内部节点的一个子节点, 节点在页上的存储见 IndexManager
 struct BPlusTreeInternalChild {
     std::vector<int> max_key;
     int page_id;
@@ -46,66 +73,5 @@ struct BPlusTreeInternalChild {
     BPlusTreeInternalChild(int page_id_, std::vector<int> max_key_);
 };
 
-struct BPlusTreeInternalNode {
-    int prev_page_id, next_page_id;  // 同级节点
-    std::list<BPlusTreeInternalChild> children;
-    BPlusTreeInternalNode();
-    BPlusTreeInternalNode(int prev_page_id_, int next_page_id_);
-};
-
-struct BPlusTreeLeafChild {
-    std::vector<int> key;
-    int page_id, slot_id;
-    BPlusTreeLeafChild(IndexValue index_value);
-    BPlusTreeLeafChild(int page_id_, int slot_id_, int index_key_num_);
-    bool operator<(const BPlusTreeLeafChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] < other.key[i]) return true;
-            if (key[i] > other.key[i]) return false;
-        }
-        return false;
-    }
-    bool operator<=(const BPlusTreeLeafChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] < other.key[i]) return true;
-            if (key[i] > other.key[i]) return false;
-        }
-        return true;
-    }
-    bool operator==(const BPlusTreeLeafChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] != other.key[i]) return false;
-        }
-        return true;
-    }
-    bool operator<(const BPlusTreeInternalChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] < other.max_key[i]) return true;
-            if (key[i] > other.max_key[i]) return false;
-        }
-        return false;
-    }
-    bool operator<=(const BPlusTreeInternalChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] < other.max_key[i]) return true;
-            if (key[i] > other.max_key[i]) return false;
-        }
-        return true;
-    }
-    bool exact_match(const BPlusTreeLeafChild& other) const {
-        for (size_t i = 0; i < key.size(); i++) {
-            if (key[i] != other.key[i]) return false;
-        }
-        return page_id == other.page_id && slot_id == other.slot_id;
-    }
-};
-
-struct BPlusTreeLeafNode {
-    int prev_page_id, next_page_id;  // 同级节点
-    std::list<BPlusTreeLeafChild> children;
-    BPlusTreeLeafNode();
-    BPlusTreeLeafNode(int prev_page_id_, int next_page_id_);
-};
-
 }  // namespace index
 }  // namespace dbs
\ No newline at end of file
@@ -20,12 +20,14 @@ class Parser {
     ~Parser();
     bool parse(std::string sSQL);
     void setOutputMode(bool mode);  // false batch
+    void setReadOnly(bool read_only_);  // 拒绝修改数据或模式的语句
 
    private:
     record::RecordManager* rm;
     index::IndexManager* im;
     system::SystemManager* sm;
     bool output_mode;
+    bool read_only = false;
 };
 
 }  // namespace parser
@@ -42,8 +42,10 @@ class ParseResult {
 class SQLMyVisitor : public antlr4::SQLBaseVisitor {
    public:
     bool output_mode;
+    bool read_only;  // 只读模式, 拒绝修改数据或模式的语句
     SQLMyVisitor(record::RecordManager *rm_, index::IndexManager *im_,
-                 system::SystemManager *sm_, bool output_mode_);
+                 system::SystemManager *sm_, bool output_mode_,
+                 bool read_only_ = false);
     ~SQLMyVisitor();
     std::any aggregateResult(std::any result, std::any nextResult) override;
     std::any visitProgram(antlr4::SQLParser::ProgramContext *ctx) override;
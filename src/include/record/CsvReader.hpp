@@ -0,0 +1,67 @@
+#pragma once
+
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "record/DataType.hpp"
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief 把 CSV 文件映射到内存, 切成以行首开始的块, 由多个线程并行解析
+ * 解析出的行按文件中的顺序交给调用者, 调用者处理一批时下一批已在解析
+ * 每行的字段按 column_types 的顺序排列, 数值用 std::from_chars 解析
+ */
+class CsvReader {
+   public:
+    /**
+     * @brief Construct a new Csv Reader object
+     * @param column_types_ 所有列的类型, 生命周期要长于 CsvReader
+     * @param delimeter_ 字段分隔符
+     */
+    CsvReader(const std::vector<ColumnType>& column_types_, char delimeter_);
+    ~CsvReader();
+
+    /**
+     * @brief 打开并映射文件
+     * @return false 表示文件无法打开
+     */
+    bool open(const char* csv_path);
+    /**
+     * @brief 文件的字节数
+     */
+    size_t size() const { return length; }
+    /**
+     * @brief 按行的顺序对每行调用 consume, 不能在 consume 中保留 data_item
+     * @return 行数, -1 表示格式错误 (错误行之前的行已交给 consume)
+     */
+    int read(const std::function<void(const DataItem& data_item)>& consume);
+    /**
+     * @brief 解析一行 (不含换行符) 到 data_item, 复用其中已有的空间
+     * @return false 表示字段数不对或数值无法解析
+     */
+    bool parseLine(std::string_view line, DataItem& data_item) const;
+
+   private:
+    // 一个线程解析的一段文件, data_items 在各批之间复用
+    struct Chunk {
+        const char* begin;
+        const char* end;
+        std::vector<DataItem> data_items;
+        int row_num;
+        bool error;
+    };
+
+    void parseChunk(Chunk& chunk) const;
+
+    const std::vector<ColumnType>& column_types;
+    char delimeter;
+    int fd;
+    const char* data;
+    size_t length;
+};
+
+}  // namespace record
+}  // namespace dbs
@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 
+#include "record/SmallString.hpp"
+
 namespace dbs {
 namespace record {
 
@@ -32,14 +34,21 @@ struct DateValue {
     DateValue(int year_, int month_, int day_);
 };
 
+/**
+ * @brief 一个值, 由 type_name 决定 value 中哪个字段有效
+ * 定长的值共用一个 union, 字符串用 SmallString, 整个结构 40 字节
+ */
 struct DataValue {
     DataTypeName type_name;
     bool is_null;
-    struct {
-        int int_value;
-        double float_value;
-        std::string char_value;
-        DateValue date_value;
+    struct Value {
+        union {
+            int int_value;
+            double float_value;
+            DateValue date_value;
+        };
+        SmallString char_value;
+        Value() : int_value(0) {}
     } value;
     void print() const;
     DataValue();
@@ -47,7 +56,7 @@ struct DataValue {
     DataValue(DataTypeName type_name_, bool is_null_, int int_value_);
     DataValue(DataTypeName type_name_, bool is_null_, double float_value_);
     DataValue(DataTypeName type_name_, bool is_null_,
-              const std::string& char_value_);
+              std::string_view char_value_);
     DataValue(DataTypeName type_name_, bool is_null_, DateValue date_value_);
     bool same(const DataValue& data_value) const;
     std::string toString() const;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "record/DataType.hpp"
+#include "system/SystemColumns.hpp"
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief 定长或 PAX 格式的页上一列的位置
+ * 第 i 个槽的值在 column[i * stride], null 位在 null_word[i * null_stride]
+ */
+struct ColumnStripe {
+    const unsigned int* column;     // 第 0 个槽中该列的值
+    const unsigned int* null_word;  // 第 0 个槽中该列的 null 位所在的 buf
+    unsigned int null_mask;
+    int stride;       // 以buf为单位, 定长格式为槽长, PAX 格式为列宽
+    int null_stride;  // 以buf为单位
+};
+
+/**
+ * @brief 把 DATE 编码为一个整数, 大小关系与按 (year, month, day) 的字典序相同
+ */
+long long dateOrderKey(int year, int month, int day);
+
+/**
+ * @brief 对一页中的一列批量求值, 把不满足的槽从 selection 中去掉
+ * selection 是 slot_num 位的位图, 传入时一般为页头的占用位图
+ * 支持 AVX2 时一次处理 8 个槽, 否则逐个比较, 结果与 RecordFilter::match 相同
+ */
+void filterNull(const ColumnStripe& stripe, bool is_null, int slot_num,
+                unsigned int* selection);
+void filterInt(const ColumnStripe& stripe,
+               system::ConstraintType constraint_type, int value,
+               int slot_num, unsigned int* selection);
+void filterFloat(const ColumnStripe& stripe,
+                 system::ConstraintType constraint_type, double value,
+                 int slot_num, unsigned int* selection);
+void filterDate(const ColumnStripe& stripe,
+                system::ConstraintType constraint_type, const DateValue& value,
+                int slot_num, unsigned int* selection);
+
+}  // namespace record
+}  // namespace dbs
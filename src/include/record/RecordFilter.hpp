@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vector>
+
+#include "record/DataType.hpp"
+#include "record/FilterKernels.hpp"
+#include "record/RecordView.hpp"
+#include "record/ZoneMap.hpp"
+#include "system/SystemColumns.hpp"
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief 把一次查询的约束编译成按列类型比较的条件, 直接在页上过滤记录
+ * 列下标和比较方式在构造时确定, 每行只读约束涉及的列
+ * 结果与逐条调用 system::validConstraint 相同
+ */
+class RecordFilter {
+   public:
+    /**
+     * @brief Construct a new Record Filter object
+     * @param constraints 约束, 之后可以释放
+     * @param view 要过滤的文件的 RecordView
+     */
+    RecordFilter(const std::vector<system::SearchConstraint>& constraints,
+                 const RecordView& view);
+    /**
+     * @brief view 当前指向的记录是否满足所有约束
+     * 约束涉及的 VARCHAR 溢出时结果不可靠, 调用者应先检查 view.hasOverflow()
+     */
+    bool match(const RecordView& view) const;
+    /**
+     * @brief 定长和 PAX 格式下对整页批量检查 null 和 INT/FLOAT/DATE 条件
+     * @param b 页
+     * @param slot_num 每页的槽数
+     * @param selection 传入页头占用位图的副本, 返回时只保留满足这些条件的槽
+     * 其余条件要对选中的槽调用 matchRemaining
+     */
+    void filterPage(BufType b, int slot_num, unsigned int* selection) const;
+    /**
+     * @brief 检查 filterPage 没有处理的条件, 变长格式下即为所有条件
+     */
+    bool matchRemaining(const RecordView& view) const {
+        return matchFrom(view, page_term_num);
+    }
+    /**
+     * @brief 按页摘要判断页 page_id 中是否可能有满足所有约束的记录
+     */
+    bool mayMatchPage(const ZoneMap& zone_map, int page_id) const;
+    bool empty() const { return terms.empty(); }
+
+   private:
+    enum TermKind {
+        IS_NULL,
+        NOT_NULL,
+        INT_COMPARE,
+        DATE_COMPARE,
+        FLOAT_COMPARE,
+        VARCHAR_COMPARE,
+        GENERIC_COMPARE,  // 约束值与列的类型不同, 按 DataValue 的运算符比较
+    };
+    struct Term {
+        TermKind kind;
+        int column_index;
+        system::ConstraintType constraint_type;
+        DataValue value;
+    };
+    static bool compare(system::ConstraintType constraint_type, bool less,
+                        bool equal);
+    bool matchFrom(const RecordView& view, int first_term) const;
+
+    std::vector<Term> terms;
+    // 定长和 PAX 格式下前 page_term_num 个条件由 filterPage 处理
+    int page_term_num;
+    // 这些条件的列在页上的位置 (以buf为单位), 见 RecordView::fixedLayout
+    struct TermStripe {
+        int column_offset, column_stride;
+        int null_offset, null_stride;
+    };
+    std::vector<TermStripe> stripes;
+};
+
+}  // namespace record
+}  // namespace dbs
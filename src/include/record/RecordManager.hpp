@@ -1,13 +1,18 @@
 #pragma once
 
 #include <fstream>
+#include <functional>
 #include <map>
 #include <vector>
 
 #include "common/Config.hpp"
 #include "fs/BufPageManager.hpp"
 #include "fs/FileManager.hpp"
+#include "record/CsvReader.hpp"
 #include "record/DataType.hpp"
+#include "record/RecordFilter.hpp"
+#include "record/RecordView.hpp"
+#include "record/ZoneMap.hpp"
 #include "system/SystemColumns.hpp"
 #include "utils/BitOperations.hpp"
 #include "utils/FilePath.hpp"
@@ -32,9 +37,12 @@ class RecordManager {
      *
      * @param file_path 文件路径，需要保证文件所在的文件夹是存在的
      * @param column_types 所有列的类型
+     * @param record_format RECORD_FORMAT_COMPACT 或 RECORD_FORMAT_PAX,
+     * 有宽 VARCHAR 时总是使用变长格式
      */
     void initializeRecordFile(const char* file_path,
-                              const std::vector<ColumnType>& column_types);
+                              const std::vector<ColumnType>& column_types,
+                              int record_format = RECORD_FORMAT_COMPACT);
 
     // upd 新接口↓
     void updateColumnUnique(const char* file_path, int column_id, bool unique);
@@ -47,12 +55,18 @@ class RecordManager {
      */
     void getColumnTypes(const char* file_path,
                         std::vector<ColumnType>& column_types);
+    /**
+     * @brief 页 0 中记录的列数 (含已删除的列), 即下一列的编号
+     * 超过 MAX_COLUMN_NUM 时列的元数据与空闲页链表重叠, 文件不可用
+     */
+    int getColumnSlotNum(const char* file_path);
     /**
      * @brief
      * 插入一条记录，会进行类型检查&varchar长度&null值检查，
      * 但不会检查主键外键unique约束，这几个应该由上层模块调用元数据record和索引去检查；如果插入失败不会对数据造成影响
      * 插入的条目必须所有值都有，default相关的问题由parser模块或系统管理模块调用getColumnType进行处理
      * insert顺序可以不按照column_types的顺序，只需要保证data_item的column_id和column_types的column_id一致
+     * 有空位的页由记录文件中的空闲页链表给出，不需要扫描所有页
      *
      * @param file_path 文件路径
      * @param data_item 插入的数据，需要保证数据的合法性
@@ -65,15 +79,31 @@ class RecordManager {
      * 但不会检查主键外键unique约束，这几个应该由上层模块调用元数据record和索引去检查；如果插入失败不会对数据造成影响
      * 插入的条目必须所有值都有，default相关的问题由parser模块或系统管理模块调用getColumnType进行处理
      * insert顺序可以不按照column_types的顺序，只需要保证data_item的column_id和column_types的column_id一致
+     * 有空位的页由记录文件中的空闲页链表给出，不需要扫描所有页
+     *
+     * CSV 文件映射到内存后由多个线程分块解析, 解析的同时依次填入页
      *
      * @param file_path 文件路径
-     * @param data_items 插入的数据，需要保证数据的合法性
-     * @return RecordLocation, -1, -1表示插入失败
+     * @param csv_path CSV 文件路径, 每行的字段按列的顺序排列
+     * @param on_insert 不为空时按行的顺序对每行及其位置调用,
+     * 用于同时收集索引项, 其中不能读写缓存中的页
+     * @return 每页的槽数 (变长格式为上界), -1表示插入失败
      */
-    int insertRecordsToEmptyRecord(const char* file_path, const char* csv_path,
-                                   const char* delimeter, bool output);
+    int insertRecordsToEmptyRecord(
+        const char* file_path, const char* csv_path, const char* delimeter,
+        bool output,
+        const std::function<void(const DataItem&, const RecordLocation&)>&
+            on_insert = nullptr);
 
     int getTotalPageNum(const char* file_path);
+
+    /**
+     * @brief 将记录紧密地重排到紧凑格式 (PAX 格式保持不变), 旧格式文件由此迁移
+     * 记录的位置会改变, 调用者需要重建该表的索引
+     * @param file_path
+     * @return int 重排后的页数
+     */
+    int compactRecordFile(const char* file_path);
     /**
      * @brief 删除一条记录
      *
@@ -109,10 +139,20 @@ class RecordManager {
     bool getRecord(const char* file_path, const RecordLocation& record_location,
                    DataItem& data_item);
 
+    /**
+     * @brief 扫描所有记录, 约束直接在页上检查, 只读出满足约束的记录
+     *
+     * @param file_path 文件路径
+     * @param data_items 返回的数据
+     * @param record_locations 返回的位置
+     * @param constraints 约束
+     * @param output_column_ids 不为空时只读出这些列 (有溢出页的记录仍读出整条)
+     */
     void getAllRecordWithConstraint(
         const char* file_path, std::vector<DataItem>& data_items,
         std::vector<RecordLocation>& record_locations,
-        const std::vector<system::SearchConstraint>& constraints);
+        const std::vector<system::SearchConstraint>& constraints,
+        const std::vector<int>* output_column_ids = nullptr);
 
     /**
      * @brief Get the Records object （vector的形式，多个）
@@ -125,6 +165,21 @@ class RecordManager {
     bool getRecords(const char* file_path,
                     const std::vector<RecordLocation>& record_locations,
                     std::vector<DataItem>& data_items);
+    /**
+     * @brief 按位置读取记录, 只读出满足约束的记录, 约束直接在页上检查
+     *
+     * @param file_path 文件路径
+     * @param record_locations 记录的位置, 不存在的记录被跳过
+     * @param constraints 约束
+     * @param data_items 返回的数据
+     * @param result_locations 返回的数据的位置
+     */
+    void getRecordsWithConstraint(
+        const char* file_path,
+        const std::vector<RecordLocation>& record_locations,
+        const std::vector<system::SearchConstraint>& constraints,
+        std::vector<DataItem>& data_items,
+        std::vector<RecordLocation>& result_locations);
     /**
      * @brief Get the All Records object
      *
@@ -175,25 +230,16 @@ class RecordManager {
      * @param b
      * @param slot_id
      * @param slot_length
-     * @param record_id
      * @param null_bitmap_buf_size 以buf为单位
+     * @param record_id
      * @param data_item
+     * @param pax 是否为 PAX 格式, 否则为定长格式
      */
-    void setSlotItem(BufType b, int slot_id, int slot_length, int record_id,
-                     int null_bitmap_buf_size, const DataItem& data_item,
-                     const std::vector<ColumnType>& column_types);
-    /**
-     * @brief get the slot item
-     * @param b
-     * @param slot_id
-     * @param slot_length
-     * @param null_bitmap_buf_size
-     * @param column_types
-     * @return DataItem
-     */
-    DataItem getSlotItem(BufType b, int slot_id, int slot_length,
-                         int null_bitmap_buf_size,
-                         const std::vector<ColumnType>& column_types);
+    void setSlotItem(BufType b, int slot_id, int slot_length,
+                     int null_bitmap_buf_size, int record_id,
+                     const DataItem& data_item,
+                     const std::vector<ColumnType>& column_types,
+                     bool pax);
     /**
      * @brief get the data item length
      * @param column_types
@@ -202,6 +248,167 @@ class RecordManager {
      */
     int dataItemLength(const std::vector<ColumnType>& column_types,
                        int null_bitmap_size);
+    /**
+     * @brief get the slot length of a record file
+     * @param column_types
+     * @param null_bitmap_buf_size 以buf为单位
+     * @param record_format 页 0 中的格式版本
+     * @return int (Byte)
+     */
+    int slotLength(const std::vector<ColumnType>& column_types,
+                   int null_bitmap_buf_size, int record_format);
+    /**
+     * @brief 按文件格式读出一条记录
+     * @param file_id
+     * @param page_id
+     * @param b 当前页, 读溢出页后会重新取页
+     * @param slot_id
+     * @param view 该文件的 RecordView, 会指向这条记录
+     * @return DataItem
+     */
+    DataItem readSlotItem(int file_id, int page_id, BufType& b, int slot_id,
+                          RecordView& view);
+    /**
+     * @brief 插入一条已经排好序并检查过的记录
+     * @param file_id
+     * @param data_item
+     * @param column_types
+     * @param zone_map 文件的页摘要, 为空时不维护
+     * @return RecordLocation
+     */
+    RecordLocation insertItem(int file_id, const DataItem& data_item,
+                              const std::vector<ColumnType>& column_types,
+                              ZoneMap* zone_map);
+    /**
+     * @brief 变长格式中一个 VARCHAR 占用的长度
+     * @param varchar_length 字符串长度, null 为 0
+     * @return int (Byte) 4的倍数, 至少为8
+     */
+    int varcharFieldLength(int varchar_length);
+    /**
+     * @brief 把一条记录编码为变长格式
+     * @param file_id 用于分配溢出页
+     * @param record 输出
+     * @param record_id
+     * @param null_bitmap_buf_size
+     * @param data_item
+     * @param column_types
+     * @param max_length 超过时最长的 VARCHAR 依次移入溢出页
+     * @return int 编码后的长度 (Byte)
+     */
+    int encodeSlottedItem(int file_id, BufType record, int record_id,
+                          int null_bitmap_buf_size, const DataItem& data_item,
+                          const std::vector<ColumnType>& column_types,
+                          int max_length);
+    /**
+     * @brief 一条变长记录用到的溢出页链表
+     * @param page_ids 每个溢出的 VARCHAR 的第一页
+     */
+    void getOverflowPages(BufType b, int slot_id, int null_bitmap_buf_size,
+                          const std::vector<ColumnType>& column_types,
+                          std::vector<int>& page_ids);
+    /**
+     * @brief 更新一条变长记录, 槽号不变
+     * 页内放不下时把 VARCHAR 移入溢出页
+     */
+    void updateSlottedItem(int file_id, const RecordLocation& record_location,
+                           const DataItem& data_item, int null_bitmap_buf_size,
+                           const std::vector<ColumnType>& column_types);
+    /**
+     * @brief 初始化一个变长格式的页
+     */
+    void initSlottedPage(BufType b);
+    /**
+     * @brief 变长格式页整理后的剩余空间
+     * @param dir_end 槽目录结束的位置 (以buf为单位)
+     * @return int (Byte)
+     */
+    int slottedFreeSpace(BufType b, int dir_end);
+    /**
+     * @brief 在变长格式页中找能放下 length 字节记录的槽
+     * @return slot id, -1 if the page is full
+     */
+    int findSlottedSlot(BufType b, int length);
+    /**
+     * @brief 把编码好的记录写入变长格式页, 调用前需确认放得下
+     */
+    void writeSlottedItem(BufType b, int slot_id, BufType record, int length);
+    /**
+     * @brief 整理变长格式页, 记录移到页尾, 槽号不变
+     * @return int 新的数据区起点 (Byte)
+     */
+    int defragSlottedPage(BufType b);
+    /**
+     * @brief 取一个空闲的溢出页, 没有时追加一页
+     */
+    int allocOverflowPage(int file_id);
+    /**
+     * @brief 把字符串写入溢出页链表
+     * @return int 第一页的页号
+     */
+    int writeOverflow(int file_id, std::string_view value);
+    void readOverflow(int file_id, int page_id, SmallString& value);
+    /**
+     * @brief 把溢出页链表放回空闲溢出页链表
+     */
+    void freeOverflow(int file_id, int page_id);
+    /**
+     * @brief 页 0 中记录的格式
+     * 没有空闲页链表标记的旧文件从未写过格式所在的 buf, 其中可能是任意值,
+     * 这时按格式 0 处理
+     */
+    int getRecordFormat(BufType b);
+    /**
+     * @brief 在页 0 中写入记录的格式, 旧文件同时写入空闲页链表标记,
+     * 空闲页链表和溢出页链表为空
+     */
+    void setRecordFormat(BufType b, int record_format);
+    /**
+     * @brief find the first free slot of a record page
+     * @param b
+     * @param data_item_per_page
+     * @return slot id, -1 if the page is full
+     */
+    int findFreeSlot(BufType b, int data_item_per_page);
+    /**
+     * @brief 扫描所有页重建空闲页链表 (没有链表的旧文件第一次插入时)
+     * @param file_id
+     * @param page_num
+     * @param data_item_per_page
+     */
+    void rebuildFreeList(int file_id, int page_num, int data_item_per_page);
+    /**
+     * @brief 预读从 page_id 开始的 READ_AHEAD_PAGES 页 (不超过 page_num)
+     * @param skip_pages 不为空时不预读其中标记的页
+     * @return int 预读范围的最后一页
+     */
+    int prefetchPages(int file_id, int page_id, int page_num,
+                      const std::vector<bool>* skip_pages);
+    /**
+     * @brief 扫描所有页, 对每条满足约束的记录调用 on_match
+     * 有页摘要时跳过不可能满足约束的页, 没有时在这次扫描中建立
+     * @param on_match 参数为位于当前记录的 view, 有溢出的 VARCHAR 时
+     * 读出并检查过的整条记录 (否则为 nullptr), 以及记录的位置
+     */
+    void scanWithConstraint(
+        const char* file_path,
+        const std::vector<system::SearchConstraint>& constraints,
+        const std::function<void(const RecordView&, DataItem*,
+                                 const RecordLocation&)>& on_match);
+
+    /**
+     * @brief 文件的页摘要, 还没有建立时返回 nullptr
+     */
+    ZoneMap* findZoneMap(const char* file_path);
+    /**
+     * @brief 为文件建立一个没有任何页的摘要, 替换原有的
+     */
+    ZoneMap* resetZoneMap(const char* file_path,
+                          const std::vector<ColumnType>& column_types);
+    /**
+     * @brief 删除文件的页摘要, 记录位置改变或文件被删除时调用
+     */
+    void dropZoneMap(const char* file_path);
 
     void closeFirstFile();
     void closeFileIfExist(const char* file_path);
@@ -216,11 +423,20 @@ class RecordManager {
 
     std::vector<char*> current_opening_file_paths;
     std::vector<int> current_opening_file_ids;
-    const int opening_cache_capacity = 10;
+    const int opening_cache_capacity = 64;
 
     std::vector<char*> current_column_types_file_paths;
     std::vector<std::vector<ColumnType>> current_column_types;
     const int column_types_cache_capacity = 10;
+
+    // 记录文件的页摘要, 在创建, 导入或第一次带约束扫描时建立, 之后随修改维护
+    struct ZoneMapEntry {
+        ZoneMap zone_map;
+        long long last_use;  // 满时换出最久没有用到的
+    };
+    std::map<std::string, ZoneMapEntry> zone_maps;
+    long long zone_map_timestamp = 0;
+    const size_t zone_map_capacity = 16;
 };
 
 }  // namespace record
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <string_view>
+#include <vector>
+
+#include "common/Config.hpp"
+#include "record/DataType.hpp"
+#include "utils/BitOperations.hpp"
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief 直接在页上读取一条记录, 不生成 DataItem
+ * 每次扫描构造一次, 之后每行只调用 reset, 各列按需读取
+ * 只在页被固定 (不会被换出) 期间有效, 字符串视图指向页内的字节
+ */
+class RecordView {
+   public:
+    /**
+     * @brief Construct a new Record View object
+     * @param column_types_ 所有列的类型, 生命周期要长于 RecordView
+     * @param null_bitmap_buf_size_ 以buf为单位
+     * @param record_format_ 页 0 中的格式版本
+     * @param slot_length_ 定长和 PAX 格式的槽长 (Byte)
+     */
+    RecordView(const std::vector<ColumnType>& column_types_,
+               int null_bitmap_buf_size_, int record_format_,
+               int slot_length_);
+    /**
+     * @brief 指向页 b 中的第 slot_id 条记录
+     */
+    void reset(BufType b, int slot_id);
+
+    int columnNum() const { return column_types.size(); }
+    /**
+     * @brief 是否为定长或 PAX 格式, 此时每个字段在页内的位置只取决于槽号:
+     * 第 slot_id 条记录的字段位于页头之后 offset + slot_id * stride 处
+     */
+    bool fixedLayout() const { return !slotted; }
+    /**
+     * @brief 定长或 PAX 格式下列的 offset 和 stride (以buf为单位)
+     */
+    int columnOffset(int column_index) const { return offsets[column_index]; }
+    int columnStride(int column_index) const { return strides[column_index]; }
+    /**
+     * @brief 定长或 PAX 格式下列的 null 位所在 buf 的 offset 和 stride
+     */
+    int nullOffset(int column_index) const {
+        return null_offset + (column_index >> LOG_BIT_PER_BUF);
+    }
+    int nullStride() const { return null_stride; }
+    /**
+     * @brief column_id 对应的列下标, 不存在时返回 -1
+     */
+    int columnIndex(int column_id) const;
+    DataTypeName typeName(int column_index) const {
+        return column_types[column_index].type_name;
+    }
+    unsigned int dataId() const { return record[row * id_stride]; }
+    bool isNull(int column_index) const {
+        return utils::getBitFromNum(
+            record[null_offset + row * null_stride +
+                   (column_index >> LOG_BIT_PER_BUF)],
+            column_index & BIT_PER_BUF_MASK);
+    }
+    /**
+     * @brief 有 VARCHAR 存在溢出页中, 这些列只能由 RecordManager 读出
+     */
+    bool hasOverflow() const { return has_overflow; }
+    bool isOverflow(int column_index) const;
+    /**
+     * @brief 溢出的 VARCHAR 所在的第一个溢出页
+     */
+    int overflowPage(int column_index) const {
+        return record[position(column_index) + 1];
+    }
+
+    int getInt(int column_index) const {
+        return utils::bit322int(record[position(column_index)]);
+    }
+    double getFloat(int column_index) const {
+        int column_position = position(column_index);
+        return utils::bit322float(record[column_position],
+                                  record[column_position + 1]);
+    }
+    std::string_view getVarchar(int column_index) const {
+        int varchar_position = position(column_index);
+        return std::string_view(
+            (const char*)(record + varchar_position) + 2,
+            utils::get2Bytes(record[varchar_position], 0));
+    }
+    DateValue getDate(int column_index) const;
+    /**
+     * @brief 读出一列, 溢出的 VARCHAR 返回空串
+     */
+    DataValue getValue(int column_index) const;
+    /**
+     * @brief 读出整条记录
+     */
+    void materialize(DataItem& data_item) const;
+    /**
+     * @brief 只读出 column_ids 中的列
+     */
+    void materialize(const std::vector<int>& column_ids,
+                     DataItem& data_item) const;
+    /**
+     * @brief 按 DataValue::toString 的格式写出一列, 不能用于溢出的 VARCHAR
+     */
+    void appendString(int column_index, std::string& output) const;
+
+   private:
+    int position(int column_index) const {
+        return offsets[column_index] + row * strides[column_index];
+    }
+
+    const std::vector<ColumnType>& column_types;
+    int null_bitmap_buf_size;
+    bool slotted;
+    int slot_length;
+    bool has_overflow;
+    // 定长和 PAX 格式指向页头之后, row 为槽号;
+    // 变长格式指向记录起点, row 为 0
+    BufType record;
+    int row;
+    // 每列的位置为 offsets + row * strides (以buf为单位), 定长和 PAX
+    // 格式构造时算好, 变长格式在 reset 时重算
+    std::vector<int> offsets;
+    std::vector<int> strides;
+    int id_stride;
+    int null_offset, null_stride;
+};
+
+}  // namespace record
+}  // namespace dbs
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief DataValue 中的字符串, 16 字节
+ * 不超过 15 个字符时直接存在对象里, 更长的才在堆上分配
+ * 移动只复制 16 字节
+ */
+class SmallString {
+   public:
+    static const int INLINE_CAPACITY = 15;
+
+    SmallString() { setInlineSize(0); }
+    SmallString(std::string_view value) {
+        setInlineSize(0);
+        assign(value.data(), value.size());
+    }
+    SmallString(const std::string& value)
+        : SmallString(std::string_view(value)) {}
+    SmallString(const char* value) : SmallString(std::string_view(value)) {}
+    SmallString(const SmallString& other) {
+        if (other.isInline()) {
+            storage = other.storage;
+        } else {
+            setInlineSize(0);
+            assign(other.data(), other.size());
+        }
+    }
+    SmallString(SmallString&& other) noexcept {
+        storage = other.storage;
+        other.setInlineSize(0);
+    }
+    ~SmallString() {
+        if (!isInline()) delete[] storage.heap.data;
+    }
+    SmallString& operator=(const SmallString& other) {
+        if (this != &other) assign(other.data(), other.size());
+        return *this;
+    }
+    SmallString& operator=(SmallString&& other) noexcept {
+        if (this != &other) {
+            if (!isInline()) delete[] storage.heap.data;
+            storage = other.storage;
+            other.setInlineSize(0);
+        }
+        return *this;
+    }
+    SmallString& operator=(std::string_view value) {
+        assign(value.data(), value.size());
+        return *this;
+    }
+    SmallString& operator=(const std::string& value) {
+        return *this = std::string_view(value);
+    }
+    SmallString& operator=(const char* value) {
+        return *this = std::string_view(value);
+    }
+
+    size_t size() const {
+        return isInline()
+                   ? INLINE_CAPACITY - storage.inline_data[INLINE_CAPACITY]
+                   : storage.heap.size;
+    }
+    bool empty() const { return size() == 0; }
+    const char* data() const {
+        return isInline() ? storage.inline_data : storage.heap.data;
+    }
+    const char* c_str() const { return data(); }
+    char operator[](size_t i) const { return data()[i]; }
+
+    void clear() { assign(nullptr, 0); }
+    void assign(const char* value, size_t length);
+    void append(const char* value, size_t length);
+    void push_back(char c) { append(&c, 1); }
+
+    std::string str() const { return std::string(data(), size()); }
+    operator std::string_view() const {
+        return std::string_view(data(), size());
+    }
+
+    friend bool operator==(const SmallString& a, const SmallString& b) {
+        return std::string_view(a) == std::string_view(b);
+    }
+    friend bool operator==(const SmallString& a, std::string_view b) {
+        return std::string_view(a) == b;
+    }
+    friend bool operator==(const SmallString& a, const std::string& b) {
+        return std::string_view(a) == std::string_view(b);
+    }
+    friend bool operator==(const SmallString& a, const char* b) {
+        return std::string_view(a) == std::string_view(b);
+    }
+    friend bool operator<(const SmallString& a, const SmallString& b) {
+        return std::string_view(a) < std::string_view(b);
+    }
+    friend std::ostream& operator<<(std::ostream& os, const SmallString& s) {
+        return os << std::string_view(s);
+    }
+
+   private:
+    bool isInline() const {
+        return (storage.inline_data[INLINE_CAPACITY] & 0x80) == 0;
+    }
+    // 内联时最后一个字节存 INLINE_CAPACITY - size, 装满时正好是结尾的 '\0'
+    void setInlineSize(size_t length) {
+        storage.inline_data[length] = '\0';
+        storage.inline_data[INLINE_CAPACITY] = INLINE_CAPACITY - length;
+    }
+
+    union Storage {
+        char inline_data[INLINE_CAPACITY + 1];
+        // 在堆上时 capacity 的最高位为 1 (小端下即最后一个字节的最高位)
+        struct {
+            char* data;
+            uint32_t size;
+            uint32_t capacity;
+        } heap;
+    } storage;
+};
+
+}  // namespace record
+}  // namespace dbs
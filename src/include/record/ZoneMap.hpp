@@ -0,0 +1,83 @@
+#pragma once
+
+#include <vector>
+
+#include "record/DataType.hpp"
+#include "record/RecordView.hpp"
+#include "system/SystemColumns.hpp"
+
+namespace dbs {
+namespace record {
+
+/**
+ * @brief 记录文件每页的摘要: 记录数, 以及每个定长列 (INT/FLOAT/DATE)
+ * 的最小值, 最大值和 null 数, 扫描时用来跳过不可能满足约束的页
+ * 由 RecordManager 保存在内存中, 在插入, 更新和删除时维护
+ * 删除后最小最大值不收缩, 因此总是包含页中实际的值
+ */
+class ZoneMap {
+   public:
+    /**
+     * @brief Construct a new Zone Map object, 此时没有任何页
+     * @param column_types 所有列的类型
+     */
+    ZoneMap(const std::vector<ColumnType>& column_types);
+    /**
+     * @brief 页 page_id 中加入一条记录
+     * @param data_item data_values 按列的顺序排列
+     */
+    void add(int page_id, const DataItem& data_item);
+    /**
+     * @brief 页 page_id 中加入 view 当前指向的记录
+     */
+    void add(int page_id, const RecordView& view);
+    /**
+     * @brief 页 page_id 中删除一条记录
+     */
+    void remove(int page_id, const DataItem& data_item);
+    void remove(int page_id, const RecordView& view);
+
+    /**
+     * @brief 页中是否没有记录, 没有摘要的页 (如溢出页) 不算空
+     */
+    bool empty(int page_id) const;
+    /**
+     * @brief 页中是否可能有满足 IS NULL (is_null) 或 IS NOT NULL 的记录
+     */
+    bool mayMatchNull(int page_id, int column_index, bool is_null) const;
+    /**
+     * @brief 页中是否可能有满足 column constraint_type value 的记录
+     * @param value 非 null, 类型与列相同
+     */
+    bool mayMatch(int page_id, int column_index,
+                  system::ConstraintType constraint_type,
+                  const DataValue& value) const;
+
+   private:
+    struct ColumnSummary {
+        double min, max;  // 按 orderKey 比较
+        int null_num;
+        bool has_nan;  // NaN 不参与大小比较, 有 NaN 时不跳过
+    };
+
+    /**
+     * @brief 把值映射为 double, 大小关系不变, DATE 用 dateOrderKey
+     */
+    static double orderKey(const DataValue& value);
+    /**
+     * @brief 页 page_id 的摘要, 不存在时追加空的摘要
+     */
+    ColumnSummary* pageSummary(int page_id);
+    const ColumnSummary* findPageSummary(int page_id) const;
+    static void addValue(ColumnSummary& summary, double key);
+
+    // 每列在页摘要中的下标, 不是定长列时为 -1
+    std::vector<int> summary_index;
+    std::vector<DataTypeName> type_names;
+    int summary_num;
+    std::vector<int> row_nums;  // 下标为页号
+    std::vector<ColumnSummary> summaries;  // 页 p 的摘要从 p * summary_num 开始
+};
+
+}  // namespace record
+}  // namespace dbs
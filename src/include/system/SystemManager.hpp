@@ -7,6 +7,7 @@
 #include "common/Config.hpp"
 #include "fs/BufPageManager.hpp"
 #include "fs/FileManager.hpp"
+#include "index/IndexCursor.hpp"
 #include "index/IndexManager.hpp"
 #include "record/DataType.hpp"
 #include "record/RecordManager.hpp"
@@ -84,6 +85,13 @@ class SystemManager {
                      const std::vector<std::string>& primary_keys,
                      const std::vector<ForeignKeyInputInfo>& foreign_keys);
 
+    /**
+     * @brief 设置之后 createTable 建的表使用的记录格式
+     *
+     * @param record_format_ RECORD_FORMAT_COMPACT 或 RECORD_FORMAT_PAX
+     */
+    void setTableRecordFormat(int record_format_);
+
     bool addForeignKey(const char* table_name,
                        const ForeignKeyInfo& new_foreign_key);
 
@@ -117,6 +125,14 @@ class SystemManager {
                   const std::vector<int>& column_ids, bool check_unique);
 
     bool dropIndex(const char* table_name, const std::string& index_name);
+
+    /**
+     * @brief 将表的记录文件重排为紧凑格式, 并重建该表的所有索引
+     * 输出重排前后的页数和每页行数
+     * @param table_name
+     * @return true if success
+     */
+    bool compactTable(const char* table_name);
     /**
      * @brief Drop a Table
      *
@@ -229,11 +245,20 @@ class SystemManager {
     bool addUnique(const char* table_name, const std::string& unique_name,
                    const std::vector<int>& column_ids);
 
+    /**
+     * @brief 按约束查找记录
+     * @param output_column_ids 不为空时结果可以只含这些列,
+     * 走全表扫描时只读出这些列
+     * @param limit 最多返回的记录数, -1 表示不限;
+     * 走索引时读到 limit 条记录即停止
+     */
     bool search(int table_id, std::vector<SearchConstraint>& constraints,
                 std::vector<record::DataItem>& result_datas,
                 std::vector<record::ColumnType>& column_types,
                 std::vector<record::RecordLocation>& record_location_results,
-                int sort_by);
+                int sort_by,
+                const std::vector<int>* output_column_ids = nullptr,
+                int limit = -1);
 
     bool searchAndSave(int table_id,
                        std::vector<record::ColumnType>& column_types,
@@ -276,11 +301,60 @@ class SystemManager {
                      std::vector<std::pair<int, std::vector<int>>>& index_ids,
                      std::vector<std::string>& index_names);
 
+    /**
+     * @brief 索引键的 int 数, 即索引的各列按类型编码后的长度之和
+     */
+    int getIndexKeyNum(int table_id, const std::vector<int>& index_column_ids);
+
+    /**
+     * @brief 按索引的列从 data_item 中取值, 编码后追加到 key
+     */
+    void getIndexKey(const record::DataItem& data_item,
+                     const std::vector<int>& index_column_ids,
+                     std::vector<int>& key);
+
+    /**
+     * @brief 排好序的索引项中是否有两项对应的记录在索引的各列上相同
+     * 键相同时, 若索引含 VARCHAR 列 (键中只有前缀), 再比较 data_items 中的原值
+     * @param index_values 由 data_items 生成, 按 sortIndexValues 的顺序排列
+     * @param record_locations data_items 各记录的位置
+     */
+    bool hasDuplicateIndexKey(
+        const std::vector<index::IndexValue>& index_values,
+        const std::vector<record::DataItem>& data_items,
+        const std::vector<record::RecordLocation>& record_locations,
+        const std::vector<int>& index_column_ids,
+        const std::vector<record::ColumnType>& column_types);
+
+    /**
+     * @brief 由约束得到在索引上查找的范围 [index_range_low, index_range_high]
+     * 前 constrained_num 列用约束的上下界, 其余列不限制;
+     * 范围包含所有满足约束的项, 但也可能有不满足的, 找到后要再检查约束
+     */
+    void getIndexRange(const std::vector<int>& index_column_ids,
+                       int constrained_num,
+                       const std::vector<SearchConstraint>& constraints,
+                       const std::vector<record::ColumnType>& column_types,
+                       index::IndexValue& index_range_low,
+                       index::IndexValue& index_range_high);
+
+    /**
+     * @brief 表 table_id 中是否有列 column_ids 依次等于 keys[i] 的记录
+     * 有以这些 INT 列为键的索引时, 排好序后在索引上一次有序地查找,
+     * 否则逐个调用 search
+     * @param keys 每个键依次为 column_ids 各列的值, 不含 null
+     * @param found 返回每个键是否存在
+     */
+    void searchKeysExist(int table_id, const std::vector<int>& column_ids,
+                         const std::vector<std::vector<int>>& keys,
+                         std::vector<bool>& found);
+
     fs::FileManager* fm;
     record::RecordManager* rm;
     index::IndexManager* im;
 
     int current_database_id;
+    int table_record_format;
 };
 
 }  // namespace system
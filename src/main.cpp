@@ -1,3 +1,4 @@
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -15,6 +16,31 @@ int main(int argc, char *argv[]) {
     std::string file_path = "";
     std::string table_name = "";
     std::string database_name = "";
+    dbs::fs::ReplacePolicy replace_policy = dbs::fs::ReplacePolicy::LRU;
+    // 缓存大小: 命令行参数优先于环境变量
+    int buffer_pages = CACHE_CAPACITY;
+    bool huge_pages = false;
+    // 批量读写 (预读, 后台写回) 使用 io_uring, 不可用时退回同步读写
+    bool io_uring = false;
+    // 只读模式: 数据文件直接 mmap, 拒绝修改语句
+    bool read_only = false;
+    // 将 -t 指定的表重排为紧凑记录格式并重建索引
+    bool compact = false;
+    // 新建的表使用 PAX 记录格式, 扫描时只读查询用到的列
+    bool pax = false;
+    // 每执行多少条语句将脏页写回磁盘 (0 表示只在退出时写回), -1 表示使用默认值
+    int checkpoint_interval = -1;
+    // 后台写回线程的唤醒间隔 (毫秒), 0 表示不启用
+    int flush_interval = 0;
+    if (getenv("DBS_BUFFER_PAGES") != nullptr) {
+        buffer_pages = atoi(getenv("DBS_BUFFER_PAGES"));
+    }
+    if (getenv("DBS_HUGE_PAGES") != nullptr) {
+        huge_pages = strcmp(getenv("DBS_HUGE_PAGES"), "0") != 0;
+    }
+    if (getenv("DBS_IO_URING") != nullptr) {
+        io_uring = strcmp(getenv("DBS_IO_URING"), "0") != 0;
+    }
     for (int i = 1; i < argc; i++) {
         auto param = std::string(argv[i]);
         if (param == "--init") {
@@ -27,6 +53,29 @@ int main(int argc, char *argv[]) {
             table_name = std::string(argv[++i]);
         } else if (param == "--database" || param == "-d") {
             database_name = std::string(argv[++i]);
+        } else if (param == "--replace") {
+            auto policy_name = std::string(argv[++i]);
+            if (!dbs::fs::parseReplacePolicy(policy_name, replace_policy)) {
+                std::cout << "unknown replace policy: " << policy_name
+                          << std::endl;
+                return -1;
+            }
+        } else if (param == "--buffer-pages") {
+            buffer_pages = atoi(argv[++i]);
+        } else if (param == "--huge-pages") {
+            huge_pages = true;
+        } else if (param == "--io-uring") {
+            io_uring = true;
+        } else if (param == "--read-only") {
+            read_only = true;
+        } else if (param == "--compact") {
+            compact = true;
+        } else if (param == "--pax") {
+            pax = true;
+        } else if (param == "--checkpoint") {
+            checkpoint_interval = atoi(argv[++i]);
+        } else if (param == "--flush-interval") {
+            flush_interval = atoi(argv[++i]);
         } else {
             std::cout << "unknown param: " << param << std::endl;
             i++;
@@ -34,6 +83,17 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (buffer_pages <= 0) {
+        std::cout << "invalid buffer size: " << buffer_pages << std::endl;
+        return -1;
+    }
+
+    if (compact && (table_name == "" || read_only)) {
+        std::cout << "--compact requires -t and cannot be used with --read-only"
+                  << std::endl;
+        return -1;
+    }
+
     if (init) {
         dbs::fs::FileManager *fm = new dbs::fs::FileManager();
         dbs::fs::BufPageManager *bpm = new dbs::fs::BufPageManager(fm);
@@ -51,12 +111,18 @@ int main(int argc, char *argv[]) {
         return 0;
     }
     dbs::fs::FileManager *fm = new dbs::fs::FileManager();
-    dbs::fs::BufPageManager *bpm = new dbs::fs::BufPageManager(fm);
+    if (io_uring) fm->enableAsyncIO();
+    dbs::fs::BufPageManager *bpm =
+        new dbs::fs::BufPageManager(fm, buffer_pages, replace_policy,
+                                    huge_pages, read_only);
+    if (flush_interval > 0) bpm->startFlusher(flush_interval);
     dbs::record::RecordManager *rm = new dbs::record::RecordManager(fm, bpm);
     dbs::index::IndexManager *im = new dbs::index::IndexManager(fm, bpm);
     dbs::system::SystemManager *sm = new dbs::system::SystemManager(fm, rm, im);
     dbs::parser::Parser *parser = new dbs::parser::Parser(rm, im, sm);
+    parser->setReadOnly(read_only);
     sm->initializeSystem();
+    if (pax) sm->setTableRecordFormat(RECORD_FORMAT_PAX);
     if (database_name != "") {
         sm->useDatabase(database_name.c_str());
     }
@@ -66,6 +132,19 @@ int main(int argc, char *argv[]) {
         auto result = parser->parse(input.c_str());
         std::cout << "@ " << (result ? "success" : "fail") << std::endl;
     }
+    if (compact) {
+        auto result = sm->compactTable(table_name.c_str());
+        std::cout << "@ " << (result ? "success" : "fail") << std::endl;
+    }
+    // 交互模式默认每条语句后写回, 批处理模式默认只在退出时写回
+    // 写回不释放缓存页, 后续语句仍可命中
+    if (checkpoint_interval < 0) checkpoint_interval = batch ? 0 : 1;
+    int statement_num = 0;
+    auto checkpoint = [&]() {
+        statement_num++;
+        if (checkpoint_interval > 0 && statement_num % checkpoint_interval == 0)
+            bpm->flush();
+    };
     if (batch) {
         // while 输入一行
         parser->setOutputMode(false);
@@ -77,6 +156,7 @@ int main(int argc, char *argv[]) {
             auto result = parser->parse(input);
             // print type of result
             std::cout << "@ " << (result ? "success" : "fail") << std::endl;
+            checkpoint();
         }
     } else {
         // while 输入一行 string
@@ -94,10 +174,12 @@ int main(int argc, char *argv[]) {
                 input = input + input_continue;
             }
             auto result = parser->parse(input);
-            bpm->close();
+            checkpoint();
             std::cout << "mysql> " << std::flush;
         }
     }
+    bpm->stopFlusher();
+    bpm->close();
     delete parser;
     delete sm;
     delete im;
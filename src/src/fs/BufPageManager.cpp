@@ -1,101 +1,479 @@
 #include "fs/BufPageManager.hpp"
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
 namespace dbs {
 namespace fs {
 
-BufPageManager::BufPageManager(FileManager* fm) {
+BufPageManager::BufPageManager(FileManager* fm, int capacity_,
+                               ReplacePolicy policy, bool huge_pages,
+                               bool read_only_) {
+    assert(capacity_ > 0);
     fileManager = fm;
-    replace = new FindReplace(CACHE_CAPACITY);
-    dirty = new utils::BitMap(CACHE_CAPACITY, false);
-    addr = new BufType[CACHE_CAPACITY];
-    for (int i = 0; i < CACHE_CAPACITY; i++) addr[i] = nullptr;
-    hash = new utils::HashMap<utils::HashItemTwoInt>();
-    pageLocation = new PageLocation[CACHE_CAPACITY];
+    capacity = capacity_;
+    replace = FindReplace::create(policy, capacity);
+    dirty = new utils::BitMap(capacity, false);
+    arena = allocArena(huge_pages);
+    addr = new BufType[capacity];
+    for (int i = 0; i < capacity; i++)
+        addr[i] = arena + (size_t)i * BUF_PER_PAGE;
+    hash = new PageTable(capacity);
+    pageLocation = new PageLocation[capacity];
     last_visit_index = -1;
+    dirty_num = 0;
+    flusher = nullptr;
+    flusher_stop = false;
+    flush_interval = 0;
+    dirty_version = new unsigned long long[capacity];
+    last_access = new unsigned long long[capacity];
+    pin_count = new int[capacity];
+    for (int i = 0; i < capacity; i++) {
+        dirty_version[i] = last_access[i] = 0;
+        pin_count[i] = 0;
+    }
+    access_clock = 0;
+    staging = nullptr;
+    staging_bufs = nullptr;
+    flush_cursor = 0;
+    seq_file_id = seq_next_page = -1;
+    seq_run = 0;
+    prefetch_frames.reserve(READ_AHEAD_PAGES);
+    prefetch_bufs.reserve(READ_AHEAD_PAGES);
+    prefetch_pages.reserve(READ_AHEAD_PAGES);
+    prefetch_reqs.reserve(READ_AHEAD_PAGES);
+    read_only = read_only_;
+    zero_page = nullptr;
+    if (read_only) {
+        void* p = mmap(nullptr, PAGE_SIZE, PROT_READ,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(p != MAP_FAILED);
+        zero_page = (BufType)p;
+    }
 }
 
 BufPageManager::~BufPageManager() {
+    stopFlusher();
+    for (int i = 0; i < (int)mappings.size(); i++) unmapFile(i);
+    if (zero_page != nullptr) munmap(zero_page, PAGE_SIZE);
     fileManager = nullptr;
     delete replace;
     delete dirty;
     delete[] addr;
+    munmap(arena, arena_size);
     delete hash;
     delete[] pageLocation;
+    delete[] dirty_version;
+    delete[] last_access;
+    delete[] pin_count;
+}
+
+BufType BufPageManager::allocArena(bool huge_pages) {
+    // 匿名映射按页对齐, 物理内存在首次写入时才分配
+    arena_size = (size_t)capacity * PAGE_SIZE;
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    if (huge_pages) {
+        size_t huge_size = (arena_size + HUGE_PAGE_SIZE - 1) &
+                           ~(size_t)(HUGE_PAGE_SIZE - 1);
+        p = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) arena_size = huge_size;
+    }
+#endif
+    if (p == MAP_FAILED) {
+        // 没有预留的大页时退回普通页, 并建议内核使用透明大页
+        p = mmap(nullptr, arena_size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(p != MAP_FAILED);
+#ifdef MADV_HUGEPAGE
+        if (huge_pages) madvise(p, arena_size, MADV_HUGEPAGE);
+#endif
+    }
+    return (BufType)p;
 }
 
-BufType BufPageManager::allocMem() {
-    return new unsigned int[(PAGE_SIZE >> 2)];
+std::unique_lock<std::mutex> BufPageManager::lockIfShared(std::mutex& m) {
+    if (flusher == nullptr)
+        return std::unique_lock<std::mutex>(m, std::defer_lock);
+    return std::unique_lock<std::mutex>(m);
+}
+
+void BufPageManager::installPage(int fileID, int pageID, int index) {
+    if (pageLocation[index].fileID != -1) {
+        writeBack(index);
+        bool deleted =
+            hash->del(pageLocation[index].fileID, pageLocation[index].pageID);
+        assert(deleted == true);
+    }
+    hash->insert(fileID, pageID, index);
+    pageLocation[index] = PageLocation(fileID, pageID);
 }
 
 BufType BufPageManager::fetchPage(int fileID, int pageID, int& index) {
-    BufType b;
     index = replace->find();
-    b = addr[index];
-    if (b == nullptr) {
-        b = allocMem();
-        addr[index] = b;
-    } else {
-        if (dirty->getBit(index)) {
-            fileManager->writePage(pageLocation[index].fileID,
-                                   pageLocation[index].pageID, b, 0);
-            dirty->setBit(index, false);
+    installPage(fileID, pageID, index);
+    return addr[index];
+}
+
+int BufPageManager::readAhead(int fileID, int pageID, int count,
+                              int demand_page) {
+    // 预读最多占用四分之一的缓存, 避免换出调用者手上的页
+    if (count > capacity / 4) count = capacity / 4;
+    if (count > READ_AHEAD_PAGES) count = READ_AHEAD_PAGES;
+    prefetch_pages.clear();
+    for (int k = 0; k < count; k++) prefetch_pages.push_back(pageID + k);
+    return loadPages(fileID, demand_page);
+}
+
+int BufPageManager::loadPages(int fileID, int demand_page) {
+    // prefetch_pages 升序, 未缓存的页按连续段分组, 各段一起提交
+    prefetch_frames.clear();
+    prefetch_bufs.clear();
+    prefetch_reqs.clear();
+    for (int pageID : prefetch_pages) {
+        if (hash->find(fileID, pageID) != -1) continue;
+        int index = replace->find(pageID != demand_page);
+        installPage(fileID, pageID, index);
+        last_access[index] = access_clock;
+        if (!prefetch_reqs.empty() &&
+            prefetch_reqs.back().pageID + prefetch_reqs.back().count ==
+                pageID) {
+            prefetch_reqs.back().count++;
+        } else {
+            prefetch_reqs.push_back(
+                PageRequest{fileID, pageID, nullptr, 1, 0});
         }
-        assert(hash->del(pageLocation[index].toHashItem()) == true);
+        prefetch_frames.push_back(index);
+        prefetch_bufs.push_back(addr[index]);
     }
-    hash->insert(utils::HashItemTwoInt(fileID, pageID, index));
-    pageLocation[index] = PageLocation(fileID, pageID);
-    return b;
+    int pos = 0;
+    for (auto& req : prefetch_reqs) {
+        req.bufs = prefetch_bufs.data() + pos;
+        pos += req.count;
+    }
+    {
+        auto io_lock = lockIfShared(io_mutex);
+        fileManager->readPagesBatch(prefetch_reqs.data(),
+                                    prefetch_reqs.size());
+    }
+    int loaded = 0;
+    pos = 0;
+    for (auto& req : prefetch_reqs) {
+        loaded += req.done;
+        // 超出文件末尾的页不保留, 当前页留给调用者按原方式读入
+        for (int k = req.done; k < req.count; k++) {
+            if (req.pageID + k != demand_page)
+                release(prefetch_frames[pos + k]);
+        }
+        pos += req.count;
+    }
+    return loaded;
 }
 
-void BufPageManager::access(int index) {
+void BufPageManager::prefetch(int fileID, int pageID, int count) {
+    auto lock = lockIfShared(mutex);
+    if (read_only) {
+        FileMapping* mapping = getMapping(fileID);
+        if (mapping->state == 1) {
+            if (pageID < 0 || pageID >= (int)mapping->pages) return;
+            if (count > (int)mapping->pages - pageID)
+                count = mapping->pages - pageID;
+            madvise(mapping->base + (size_t)pageID * BUF_PER_PAGE,
+                    (size_t)count * PAGE_SIZE, MADV_WILLNEED);
+            return;
+        }
+    }
+    readAhead(fileID, pageID, count, -1);
+}
+
+void BufPageManager::prefetchPages(int fileID, std::vector<int> pageIDs) {
+    auto lock = lockIfShared(mutex);
+    std::sort(pageIDs.begin(), pageIDs.end());
+    pageIDs.erase(std::unique(pageIDs.begin(), pageIDs.end()), pageIDs.end());
+    int limit = std::min(capacity / 4, READ_AHEAD_PAGES);
+    if ((int)pageIDs.size() > limit) pageIDs.resize(limit);
+    if (read_only) {
+        FileMapping* mapping = getMapping(fileID);
+        if (mapping->state == 1) {
+            for (int pageID : pageIDs) {
+                if (pageID >= 0 && pageID < (int)mapping->pages)
+                    madvise(mapping->base + (size_t)pageID * BUF_PER_PAGE,
+                            PAGE_SIZE, MADV_WILLNEED);
+            }
+            return;
+        }
+    }
+    prefetch_pages.swap(pageIDs);
+    loadPages(fileID, -1);
+}
+
+void BufPageManager::touch(int index) {
     if (index != last_visit_index) {
         replace->access(index);
         last_visit_index = index;
+        access_clock++;
     }
+    last_access[index] = access_clock;
+}
+
+void BufPageManager::unpin(int index) {
+    // 没有成对调用时不减到负数, 多出来的 pin 只会让后台写回跳过该帧
+    if (pin_count[index] > 0) pin_count[index]--;
+}
+
+void BufPageManager::access(int index) {
+    if (index < 0) return;
+    auto lock = lockIfShared(mutex);
+    touch(index);
+    unpin(index);
 }
 
 BufType BufPageManager::getPage(int fileID, int pageID, int& index) {
-    utils::HashItemTwoInt find_item(fileID, pageID);
-    find_item = hash->find(find_item);
-    index = find_item.val;
+    auto lock = lockIfShared(mutex);
+    if (read_only) {
+        BufType b = mappedPage(fileID, pageID);
+        if (b != nullptr) {
+            index = -1;
+            return b;
+        }
+    }
+    index = hash->find(fileID, pageID);
     if (index != -1) {
-        access(index);
+        replace->hit();
+        touch(index);
+        pin_count[index]++;
         return addr[index];
-    } else {
-        BufType b = fetchPage(fileID, pageID, index);
-        fileManager->readPage(fileID, pageID, b, 0);
-        return b;
     }
+    // 同一文件连续缺页时预读后面的页, 当前页也在同一次读入中
+    if (fileID == seq_file_id && pageID == seq_next_page)
+        seq_run++;
+    else
+        seq_run = 1;
+    seq_file_id = fileID;
+    seq_next_page = pageID + 1;
+    if (seq_run >= 2) {
+        int loaded = readAhead(fileID, pageID, READ_AHEAD_PAGES, pageID);
+        index = hash->find(fileID, pageID);
+        if (loaded > 0) {
+            seq_next_page = pageID + loaded;
+            last_access[index] = ++access_clock;
+            last_visit_index = index;
+            pin_count[index]++;
+            return addr[index];
+        }
+        // 读到文件末尾 (例如正在追加新页), 暂停一段时间的预读
+        seq_run = -READ_AHEAD_PAGES;
+    }
+    BufType b =
+        index != -1 ? addr[index] : fetchPage(fileID, pageID, index);
+    last_access[index] = ++access_clock;
+    // 新装入的页已在替换策略中记为最近访问, 紧随的 access 不再重复计数
+    last_visit_index = index;
+    pin_count[index]++;
+    auto io_lock = lockIfShared(io_mutex);
+    fileManager->readPage(fileID, pageID, b, 0);
+    return b;
 }
 
 void BufPageManager::markDirty(int index) {
-    dirty->setBit(index, true);
-    access(index);
+    // 只读模式下映射的页不能修改
+    assert(index >= 0);
+    auto lock = lockIfShared(mutex);
+    if (!dirty->getBit(index)) {
+        dirty->setBit(index, true);
+        dirty_num++;
+        if (flusher != nullptr && dirty_num == capacity / 4)
+            flusher_cv.notify_one();
+    }
+    dirty_version[index]++;
+    touch(index);
+    unpin(index);
 }
 
 void BufPageManager::writeBack(int index) {
     if (dirty->getBit(index)) {
+        auto io_lock = lockIfShared(io_mutex);
         fileManager->writePage(pageLocation[index].fileID,
                                pageLocation[index].pageID, addr[index], 0);
         dirty->setBit(index, false);
+        dirty_num--;
     }
 }
 
 void BufPageManager::release(int index) {
     writeBack(index);
     replace->free(index);
-    hash->del(pageLocation[index].toHashItem());
+    hash->del(pageLocation[index].fileID, pageLocation[index].pageID);
+    pageLocation[index] = PageLocation();
 }
 
 void BufPageManager::close() {
-    for (int i = 0; i < CACHE_CAPACITY; ++i) {
-        if (addr[i] != nullptr) {
-            release(i);
-            delete[] addr[i];
-            addr[i] = nullptr;
+    auto lock = lockIfShared(mutex);
+    for (int i = 0; i < (int)mappings.size(); i++) unmapFile(i);
+    for (int i = 0; i < capacity; ++i) {
+        if (pageLocation[i].fileID != -1) release(i);
+    }
+}
+
+void BufPageManager::flush() {
+    auto lock = lockIfShared(mutex);
+    for (int i = 0; i < capacity; ++i) {
+        if (pageLocation[i].fileID != -1) writeBack(i);
+    }
+}
+
+void BufPageManager::closeFile(int fileID) {
+    auto lock = lockIfShared(mutex);
+    if (fileID >= 0 && fileID < (int)mappings.size()) unmapFile(fileID);
+    for (int i = 0; i < capacity; ++i) {
+        if (pageLocation[i].fileID == fileID) release(i);
+    }
+}
+
+BufPageManager::FileMapping* BufPageManager::getMapping(int fileID) {
+    assert(fileID >= 0);
+    if (fileID >= (int)mappings.size())
+        mappings.resize(fileID + 1, FileMapping{0, nullptr, 0, 0, 0, false});
+    FileMapping* mapping = &mappings[fileID];
+    if (mapping->state == 0) {
+        // 首次访问时为空的文件正在被创建 (如临时文件), 仍然使用缓存
+        mapping->base = fileManager->mapFile(fileID, mapping->length);
+        mapping->pages = mapping->length >> PAGE_SIZE_IDX;
+        mapping->state = mapping->base != nullptr ? 1 : 2;
+        if (mapping->base != nullptr)
+            madvise(mapping->base, mapping->length, MADV_RANDOM);
+    }
+    return mapping;
+}
+
+BufType BufPageManager::mappedPage(int fileID, int pageID) {
+    FileMapping* mapping = getMapping(fileID);
+    if (mapping->state != 1) return nullptr;
+    if (pageID < 0 || pageID >= (int)mapping->pages) return zero_page;
+    // 连续访问时改为顺序预读, 由内核完成
+    if (!mapping->sequential && pageID != 0 && pageID == mapping->next_page) {
+        madvise(mapping->base, mapping->pages * PAGE_SIZE, MADV_SEQUENTIAL);
+        mapping->sequential = true;
+    }
+    mapping->next_page = pageID + 1;
+    return mapping->base + (size_t)pageID * BUF_PER_PAGE;
+}
+
+void BufPageManager::unmapFile(int fileID) {
+    FileMapping& mapping = mappings[fileID];
+    if (mapping.state == 1) munmap(mapping.base, mapping.length);
+    mapping = FileMapping{0, nullptr, 0, 0, 0, false};
+}
+
+void BufPageManager::startFlusher(int interval_ms) {
+    if (flusher != nullptr) return;
+    flush_interval = interval_ms > 0 ? interval_ms : 1;
+    flusher_stop = false;
+    staging = new unsigned int[(size_t)FLUSH_BATCH_PAGES * BUF_PER_PAGE];
+    staging_bufs = new BufType[FLUSH_BATCH_PAGES];
+    flush_entries.reserve(FLUSH_BATCH_PAGES);
+    flush_reqs.reserve(FLUSH_BATCH_PAGES);
+    flusher = new std::thread(&BufPageManager::flusherLoop, this);
+}
+
+void BufPageManager::stopFlusher() {
+    if (flusher == nullptr) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        flusher_stop = true;
+    }
+    flusher_cv.notify_one();
+    flusher->join();
+    delete flusher;
+    flusher = nullptr;
+    delete[] staging;
+    delete[] staging_bufs;
+    staging = nullptr;
+    staging_bufs = nullptr;
+}
+
+void BufPageManager::flusherLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!flusher_stop) {
+        flusher_cv.wait_for(lock, std::chrono::milliseconds(flush_interval));
+        if (flusher_stop) break;
+        lock.unlock();
+        while (flushBatch() == FLUSH_BATCH_PAGES) {
+        }
+        lock.lock();
+    }
+}
+
+int BufPageManager::flushBatch() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (flusher_stop) return 0;
+    // 从上次停下的位置继续收集脏页
+    // 调用者只在 getPage 到 access/markDirty 之间写页, 跳过这样被 pin 住的帧,
+    // 其余的帧在持有 mutex 时不会被修改, 可以安全地复制快照;
+    // 最近访问过的页很可能马上又被修改, 等又有 FLUSH_MIN_AGE 次其它页访问再写回
+    flush_entries.clear();
+    for (int k = 0; k < capacity && (int)flush_entries.size() <
+                                        FLUSH_BATCH_PAGES;
+         k++) {
+        int i = flush_cursor;
+        flush_cursor = (flush_cursor + 1 == capacity) ? 0 : flush_cursor + 1;
+        if (pageLocation[i].fileID != -1 && dirty->getBit(i) &&
+            pin_count[i] == 0 &&
+            access_clock - last_access[i] >= FLUSH_MIN_AGE) {
+            flush_entries.push_back(FlushEntry{pageLocation[i].fileID,
+                                               pageLocation[i].pageID, i,
+                                               dirty_version[i]});
+        }
+    }
+    int n = flush_entries.size();
+    if (n == 0) return 0;
+    std::sort(flush_entries.begin(), flush_entries.end(),
+              [](const FlushEntry& a, const FlushEntry& b) {
+                  return a.fileID != b.fileID ? a.fileID < b.fileID
+                                              : a.pageID < b.pageID;
+              });
+    for (int k = 0; k < n; k++) {
+        staging_bufs[k] = staging + (size_t)k * BUF_PER_PAGE;
+        memcpy(staging_bufs[k], addr[flush_entries[k].index], PAGE_SIZE);
+    }
+
+    // 先拿到 io_mutex 再放开 mutex, 保证快照先于之后的同步写回落盘
+    std::unique_lock<std::mutex> io_lock(io_mutex);
+    lock.unlock();
+    // 相邻的页合并成一段, 所有段一起提交
+    flush_reqs.clear();
+    for (int start = 0; start < n;) {
+        int end = start + 1;
+        while (end < n && flush_entries[end].fileID ==
+                              flush_entries[start].fileID &&
+               flush_entries[end].pageID == flush_entries[end - 1].pageID + 1)
+            end++;
+        flush_reqs.push_back(PageRequest{flush_entries[start].fileID,
+                                         flush_entries[start].pageID,
+                                         staging_bufs + start, end - start,
+                                         0});
+        start = end;
+    }
+    fileManager->writePagesBatch(flush_reqs.data(), flush_reqs.size());
+    io_lock.unlock();
+
+    // 写回期间没有被再次修改的页才能标记为干净, 修改总以 markDirty 结束
+    lock.lock();
+    for (auto& entry : flush_entries) {
+        int i = entry.index;
+        if (pageLocation[i].fileID == entry.fileID &&
+            pageLocation[i].pageID == entry.pageID &&
+            dirty_version[i] == entry.version && dirty->getBit(i)) {
+            dirty->setBit(i, false);
+            dirty_num--;
         }
     }
+    return n;
 }
 
 }  // namespace fs
-}  // namespace dbs
\ No newline at end of file
+}  // namespace dbs
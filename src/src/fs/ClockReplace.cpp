@@ -0,0 +1,46 @@
+#include "fs/ClockReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+ClockReplace::ClockReplace(int capacity_) : FindReplace(capacity_) {
+    referenced = new bool[capacity];
+    resident = new bool[capacity];
+    for (int i = 0; i < capacity; i++) referenced[i] = resident[i] = false;
+    hand = 0;
+}
+
+ClockReplace::~ClockReplace() {
+    delete[] referenced;
+    delete[] resident;
+}
+
+void ClockReplace::onInsert(int index) {
+    resident[index] = true;
+    referenced[index] = true;
+}
+
+void ClockReplace::onAccess(int index) { referenced[index] = true; }
+
+int ClockReplace::evict() {
+    // 缓存已满时所有帧都在使用中, 至多扫描两圈
+    while (true) {
+        int index = hand;
+        hand = (hand + 1 == capacity) ? 0 : hand + 1;
+        if (!resident[index]) continue;
+        if (referenced[index]) {
+            referenced[index] = false;
+        } else {
+            resident[index] = false;
+            return index;
+        }
+    }
+}
+
+void ClockReplace::onRemove(int index) {
+    resident[index] = false;
+    referenced[index] = false;
+}
+
+}  // namespace fs
+}  // namespace dbs
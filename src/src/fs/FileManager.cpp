@@ -3,31 +3,255 @@
 namespace dbs {
 namespace fs {
 
+FileManager::FileManager() {
+    for (int i = 0; i < FD_TABLE_CHUNK_NUM; i++) fd_table[i] = nullptr;
+}
+
+FileManager::~FileManager() {
+    for (int i = 0; i < FD_TABLE_CHUNK_NUM; i++) delete[] fd_table[i].load();
+    delete ring;
+}
+
+bool FileManager::enableAsyncIO(unsigned depth) {
+    std::lock_guard<std::mutex> lock(ring_mutex);
+    if (ring == nullptr) ring = IOUring::create(depth);
+    return ring != nullptr;
+}
+
+int FileManager::getFd(int fileID) {
+    if (fileID < 0) return -1;
+    int chunk = fileID / FD_TABLE_CHUNK_SIZE;
+    if (chunk >= FD_TABLE_CHUNK_NUM) return -1;
+    std::atomic<int>* table = fd_table[chunk].load(std::memory_order_acquire);
+    if (table == nullptr) return -1;
+    return table[fileID % FD_TABLE_CHUNK_SIZE].load(std::memory_order_acquire);
+}
+
+void FileManager::setFd(int fileID, int f) {
+    // 调用者持有 id_mutex, fileID 一定在表的范围内
+    int chunk = fileID / FD_TABLE_CHUNK_SIZE;
+    std::atomic<int>* table = fd_table[chunk].load(std::memory_order_relaxed);
+    if (table == nullptr) {
+        // 新块填好之后才发布, 已有的块从不移动, 读者无需加锁
+        table = new std::atomic<int>[FD_TABLE_CHUNK_SIZE];
+        for (int i = 0; i < FD_TABLE_CHUNK_SIZE; i++)
+            table[i].store(-1, std::memory_order_relaxed);
+        fd_table[chunk].store(table, std::memory_order_release);
+    }
+    table[fileID % FD_TABLE_CHUNK_SIZE].store(f, std::memory_order_release);
+}
+
+bool FileManager::preadFull(int f, void* buf, size_t len, off_t offset) {
+    char* p = (char*)buf;
+    while (len > 0) {
+        ssize_t got = pread(f, p, len, offset);
+        read_calls++;
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (got == 0) {
+            // 文件末尾之后的部分视为全 0
+            memset(p, 0, len);
+            return true;
+        }
+        p += got;
+        len -= got;
+        offset += got;
+    }
+    return true;
+}
+
+bool FileManager::pwriteFull(int f, const void* buf, size_t len,
+                             off_t offset) {
+    const char* p = (const char*)buf;
+    while (len > 0) {
+        ssize_t written = pwrite(f, p, len, offset);
+        write_calls++;
+        // 一个字节都没写进去时重试也不会有进展
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) continue;
+            return false;
+        }
+        p += written;
+        len -= written;
+        offset += written;
+    }
+    return true;
+}
+
 bool FileManager::writePage(int fileID, int pageID, BufType buf, int off) {
-    int f = fd[fileID];
+    int f = getFd(fileID);
+    if (f == -1) return false;
     off_t offset = pageID;
     offset = (offset << PAGE_SIZE_IDX);
-    off_t error = lseek(f, offset, SEEK_SET);
-    if (error != offset) return false;
-    BufType b = buf + off;
-    error = write(f, (void*)b, PAGE_SIZE);
+    return pwriteFull(f, (void*)(buf + off), PAGE_SIZE, offset);
+}
+
+bool FileManager::writePages(int fileID, int pageID, BufType* bufs,
+                             int count) {
+    int f = getFd(fileID);
+    if (f == -1) return false;
+    struct iovec iov[FLUSH_BATCH_PAGES];
+    while (count > 0) {
+        int n = count < FLUSH_BATCH_PAGES ? count : FLUSH_BATCH_PAGES;
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = (void*)bufs[i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset = pageID;
+        offset = (offset << PAGE_SIZE_IDX);
+        ssize_t written = pwritev(f, iov, n, offset);
+        write_calls++;
+        if (written <= 0) {
+            if (written < 0 && errno == EINTR) continue;
+            return false;
+        }
+        // 短写时补齐写了一半的页, 再从下一页继续
+        int done = written >> PAGE_SIZE_IDX;
+        int rest = written & (PAGE_SIZE - 1);
+        if (rest != 0 || done == 0) {
+            if (!pwriteFull(f, (char*)bufs[done] + rest, PAGE_SIZE - rest,
+                            offset + ((off_t)done << PAGE_SIZE_IDX) + rest))
+                return false;
+            done++;
+        }
+        bufs += done;
+        pageID += done;
+        count -= done;
+    }
     return true;
 }
 
 bool FileManager::readPage(int fileID, int pageID, BufType buf, int off) {
-    int f = fd[fileID];
+    int f = getFd(fileID);
+    if (f == -1) return false;
     off_t offset = pageID;
     offset = (offset << PAGE_SIZE_IDX);
-    off_t error = lseek(f, offset, SEEK_SET);
-    if (error != offset) return false;
-    BufType b = buf + off;
-    error = read(f, (void*)b, PAGE_SIZE);
+    return preadFull(f, (void*)(buf + off), PAGE_SIZE, offset);
+}
+
+int FileManager::readPages(int fileID, int pageID, BufType* bufs,
+                           int count) {
+    int f = getFd(fileID);
+    if (f == -1) return 0;
+    struct iovec iov[FLUSH_BATCH_PAGES];
+    int read_num = 0;
+    while (read_num < count) {
+        int n = count - read_num;
+        if (n > FLUSH_BATCH_PAGES) n = FLUSH_BATCH_PAGES;
+        for (int i = 0; i < n; i++) {
+            iov[i].iov_base = (void*)bufs[read_num + i];
+            iov[i].iov_len = PAGE_SIZE;
+        }
+        off_t offset = pageID + read_num;
+        offset = (offset << PAGE_SIZE_IDX);
+        ssize_t got = preadv(f, iov, n, offset);
+        read_calls++;
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        int done = got >> PAGE_SIZE_IDX;
+        int rest = got & (PAGE_SIZE - 1);
+        read_num += done;
+        if (rest != 0) {
+            // 短读: 补齐读了一半的页, 到文件末尾则停止
+            off_t page_offset = (off_t)(pageID + read_num) << PAGE_SIZE_IDX;
+            char* p = (char*)bufs[read_num];
+            ssize_t more = 0;
+            while (rest < PAGE_SIZE) {
+                more = pread(f, p + rest, PAGE_SIZE - rest, page_offset + rest);
+                read_calls++;
+                if (more < 0 && errno == EINTR) continue;
+                if (more <= 0) break;
+                rest += more;
+            }
+            if (rest < PAGE_SIZE) break;
+            read_num++;
+        }
+    }
+    return read_num;
+}
+
+void FileManager::readPagesBatch(PageRequest* reqs, int n) {
+    submitBatch(reqs, n, false);
+}
+
+bool FileManager::writePagesBatch(PageRequest* reqs, int n) {
+    submitBatch(reqs, n, true);
+    for (int i = 0; i < n; i++)
+        if (reqs[i].done != reqs[i].count) return false;
     return true;
 }
 
+void FileManager::submitBatch(PageRequest* reqs, int n, bool write) {
+    for (int i = 0; i < n; i++) reqs[i].done = 0;
+    if (ring != nullptr) {
+        std::lock_guard<std::mutex> lock(ring_mutex);
+        int pages = 0;
+        for (int i = 0; i < n; i++) {
+            assert(reqs[i].count <= FLUSH_BATCH_PAGES);
+            pages += reqs[i].count;
+        }
+        ring_iovs.resize(pages);
+        ring_reqs.clear();
+        ring_owner.clear();
+        int iov_pos = 0;
+        for (int i = 0; i < n; i++) {
+            int f = getFd(reqs[i].fileID);
+            if (f == -1 || reqs[i].count <= 0) continue;
+            struct iovec* iov = ring_iovs.data() + iov_pos;
+            for (int k = 0; k < reqs[i].count; k++) {
+                iov[k].iov_base = (void*)reqs[i].bufs[k];
+                iov[k].iov_len = PAGE_SIZE;
+            }
+            iov_pos += reqs[i].count;
+            ring_reqs.push_back(IOUring::Request{
+                f, write, iov, reqs[i].count,
+                (off_t)reqs[i].pageID << PAGE_SIZE_IDX});
+            ring_owner.push_back(i);
+        }
+        ring_results.resize(ring_reqs.size());
+        ring_calls += ring->submitAndWait(ring_reqs.data(), ring_reqs.size(),
+                                          ring_results.data());
+        for (size_t k = 0; k < ring_reqs.size(); k++) {
+            int res = ring_results[k];
+            if (res > 0) reqs[ring_owner[k]].done = res >> PAGE_SIZE_IDX;
+        }
+    }
+    // 没有 io_uring, 或短读短写、出错时, 剩下的页用同步调用完成
+    for (int i = 0; i < n; i++) {
+        PageRequest& req = reqs[i];
+        if (req.done >= req.count) continue;
+        if (write) {
+            if (writePages(req.fileID, req.pageID + req.done,
+                           req.bufs + req.done, req.count - req.done))
+                req.done = req.count;
+        } else {
+            req.done += readPages(req.fileID, req.pageID + req.done,
+                                  req.bufs + req.done, req.count - req.done);
+        }
+    }
+}
+
+BufType FileManager::mapFile(int fileID, size_t& length) {
+    length = 0;
+    int f = getFd(fileID);
+    if (f == -1) return nullptr;
+    struct stat st;
+    if (fstat(f, &st) != 0 || st.st_size == 0) return nullptr;
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, f, 0);
+    if (p == MAP_FAILED) return nullptr;
+    length = st.st_size;
+    return (BufType)p;
+}
+
 void FileManager::closeFile(int fileID) {
-    close(fd[fileID]);
-    fd.erase(fileID);
+    std::lock_guard<std::mutex> lock(id_mutex);
+    int f = getFd(fileID);
+    if (f == -1) return;
+    close(f);
+    setFd(fileID, -1);
+    free_ids.push_back(fileID);
 }
 
 bool FileManager::createFile(const char* name) {
@@ -41,13 +265,24 @@ bool FileManager::createFile(const char* name) {
 }
 
 int FileManager::openFile(const char* name) {
-    int fileID = file_id++;
     int f = open(name, O_RDWR);
     if (f == -1) {
         std::cerr << "Failed opening file " << name << std::endl;
         return -1;
     }
-    fd[fileID] = f;
+    std::lock_guard<std::mutex> lock(id_mutex);
+    int fileID;
+    if (!free_ids.empty()) {
+        fileID = free_ids.back();
+        free_ids.pop_back();
+    } else if (next_file_id < FD_TABLE_CHUNK_NUM * FD_TABLE_CHUNK_SIZE) {
+        fileID = next_file_id++;
+    } else {
+        std::cerr << "Too many open files" << std::endl;
+        close(f);
+        return -1;
+    }
+    setFd(fileID, f);
     return fileID;
 }
 
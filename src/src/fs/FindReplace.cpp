@@ -1,47 +1,84 @@
 #include "fs/FindReplace.hpp"
 
+#include "fs/ClockReplace.hpp"
+#include "fs/LRUKReplace.hpp"
+#include "fs/LRUReplace.hpp"
+#include "fs/TwoQueueReplace.hpp"
+
 namespace dbs {
 namespace fs {
 
+bool parseReplacePolicy(const std::string& name, ReplacePolicy& policy) {
+    if (name == "lru") {
+        policy = ReplacePolicy::LRU;
+    } else if (name == "clock") {
+        policy = ReplacePolicy::CLOCK;
+    } else if (name == "lru2" || name == "lru-k") {
+        policy = ReplacePolicy::LRU_K;
+    } else if (name == "2q") {
+        policy = ReplacePolicy::TWO_Q;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+FindReplace* FindReplace::create(ReplacePolicy policy, int capacity) {
+    switch (policy) {
+        case ReplacePolicy::CLOCK:
+            return new ClockReplace(capacity);
+        case ReplacePolicy::LRU_K:
+            return new LRUKReplace(capacity);
+        case ReplacePolicy::TWO_Q:
+            return new TwoQueueReplace(capacity);
+        default:
+            return new LRUReplace(capacity);
+    }
+}
+
 FindReplace::FindReplace(int capacity_) {
     capacity = capacity_;
-    list = new utils::LinkList<int>();
-    node = new utils::LinkListNode<int>*[capacity];
-    for (int i = 0; i < capacity; i++) {
-        list->insertHead(i);
-        node[i] = list->getHead();
+    free_frames = new int[capacity];
+    used = new bool[capacity];
+    free_num = 0;
+    for (int i = capacity - 1; i >= 0; i--) {
+        free_frames[free_num++] = i;
+        used[i] = false;
     }
 }
 
 FindReplace::~FindReplace() {
-    delete list;
-    for (int i = 0; i < capacity; i++)
-        node[i] = nullptr;
-    delete[] node;
+    delete[] free_frames;
+    delete[] used;
 }
 
-int FindReplace::find() {
-    int index = list->getTail()->data;
-    list->del(node[index]);
-    node[index] = nullptr;
-    list->insertHead(index);
-    node[index] = list->getHead();
+int FindReplace::find(bool prefetch) {
+    int index;
+    if (prefetch)
+        stats.prefetches++;
+    else
+        stats.misses++;
+    if (free_num > 0) {
+        index = free_frames[--free_num];
+    } else {
+        index = evict();
+        stats.evictions++;
+    }
+    used[index] = true;
+    onInsert(index);
     return index;
 }
 
 void FindReplace::access(int index) {
-    list->del(node[index]);
-    node[index] = nullptr;
-    list->insertHead(index);
-    node[index] = list->getHead();
+    if (used[index]) onAccess(index);
 }
 
 void FindReplace::free(int index) {
-    list->del(node[index]);
-    node[index] = nullptr;
-    list->insertTail(index);
-    node[index] = list->getTail();
+    if (!used[index]) return;
+    used[index] = false;
+    onRemove(index);
+    free_frames[free_num++] = index;
 }
 
 }  // namespace fs
-}  // namespace dbs
\ No newline at end of file
+}  // namespace dbs
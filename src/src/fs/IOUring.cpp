@@ -0,0 +1,175 @@
+#include "fs/IOUring.hpp"
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define DBS_HAS_IO_URING 1
+#endif
+
+namespace dbs {
+namespace fs {
+
+#ifdef DBS_HAS_IO_URING
+
+static int ioUringSetup(unsigned entries, struct io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete,
+                        unsigned flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, nullptr, 0);
+}
+
+#endif
+
+IOUring::IOUring()
+    : ring_fd(-1),
+      depth(0),
+      sq_ring(MAP_FAILED),
+      cq_ring(MAP_FAILED),
+      sq_ring_size(0),
+      cq_ring_size(0),
+      sqe_mem(MAP_FAILED),
+      sqe_mem_size(0) {}
+
+IOUring* IOUring::create(unsigned entries) {
+    IOUring* ring = new IOUring();
+    if (!ring->setup(entries)) {
+        delete ring;
+        return nullptr;
+    }
+    return ring;
+}
+
+IOUring::~IOUring() {
+    if (sqe_mem != MAP_FAILED) munmap(sqe_mem, sqe_mem_size);
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+        munmap(cq_ring, cq_ring_size);
+    if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+    if (ring_fd != -1) close(ring_fd);
+}
+
+bool IOUring::setup(unsigned entries) {
+#ifdef DBS_HAS_IO_URING
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    ring_fd = ioUringSetup(entries, &p);
+    if (ring_fd < 0) {
+        // ENOSYS: 内核不支持, EPERM: 被 seccomp 或 sysctl 禁用
+        ring_fd = -1;
+        return false;
+    }
+    depth = p.sq_entries;
+    sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_ring_size =
+        p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap && cq_ring_size > sq_ring_size)
+        sq_ring_size = cq_ring_size;
+    sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) return false;
+    if (single_mmap) {
+        cq_ring = sq_ring;
+    } else {
+        cq_ring = mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+        if (cq_ring == MAP_FAILED) return false;
+    }
+    sqe_mem_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    sqe_mem = mmap(nullptr, sqe_mem_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+    if (sqe_mem == MAP_FAILED) return false;
+
+    char* sq = (char*)sq_ring;
+    sq_head = (unsigned*)(sq + p.sq_off.head);
+    sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    sq_mask = (unsigned*)(sq + p.sq_off.ring_mask);
+    sq_array = (unsigned*)(sq + p.sq_off.array);
+    char* cq = (char*)cq_ring;
+    cq_head = (unsigned*)(cq + p.cq_off.head);
+    cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    cq_mask = (unsigned*)(cq + p.cq_off.ring_mask);
+    cqes = cq + p.cq_off.cqes;
+    sqes = sqe_mem;
+    return true;
+#else
+    (void)entries;
+    return false;
+#endif
+}
+
+int IOUring::submitAndWait(const Request* reqs, int n, int* results) {
+#ifdef DBS_HAS_IO_URING
+    struct io_uring_sqe* sqe_array = (struct io_uring_sqe*)sqes;
+    struct io_uring_cqe* cqe_array = (struct io_uring_cqe*)cqes;
+    int enter_calls = 0;
+    int queued = 0;     // 已放入提交队列的请求数
+    int completed = 0;  // 已完成的请求数
+    unsigned to_submit = 0;
+    while (completed < n) {
+        // 在途请求不超过队列深度, 完成队列也就不会溢出
+        unsigned tail = *sq_tail;
+        while (queued < n && (unsigned)(queued - completed) < depth) {
+            unsigned pos = tail & *sq_mask;
+            struct io_uring_sqe* sqe = &sqe_array[pos];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = reqs[queued].write ? IORING_OP_WRITEV
+                                             : IORING_OP_READV;
+            sqe->fd = reqs[queued].fd;
+            sqe->addr = (unsigned long long)reqs[queued].iov;
+            sqe->len = reqs[queued].iovcnt;
+            sqe->off = reqs[queued].offset;
+            sqe->user_data = queued;
+            sq_array[pos] = pos;
+            tail++;
+            queued++;
+            to_submit++;
+        }
+        __atomic_store_n(sq_tail, tail, __ATOMIC_RELEASE);
+
+        int ret = ioUringEnter(ring_fd, to_submit, 1, IORING_ENTER_GETEVENTS);
+        enter_calls++;
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+            // 无法继续提交: 撤回还没被内核取走的请求, 连同其余请求按失败处理,
+            // 只等待已在途的请求完成
+            int err = errno;
+            unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+            unsigned pending = *sq_tail - head;
+            __atomic_store_n(sq_tail, head, __ATOMIC_RELEASE);
+            for (int k = queued - (int)pending; k < n; k++) results[k] = -err;
+            completed += n - (queued - (int)pending);
+            queued = n;
+            to_submit = 0;
+        } else {
+            to_submit -= (unsigned)ret < to_submit ? (unsigned)ret : to_submit;
+        }
+
+        unsigned head = *cq_head;
+        unsigned cq_tail_now = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        while (head != cq_tail_now) {
+            struct io_uring_cqe* cqe = &cqe_array[head & *cq_mask];
+            results[cqe->user_data] = cqe->res;
+            completed++;
+            head++;
+        }
+        __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+    }
+    return enter_calls;
+#else
+    for (int i = 0; i < n; i++) results[i] = -ENOSYS;
+    (void)reqs;
+    return 0;
+#endif
+}
+
+}  // namespace fs
+}  // namespace dbs
@@ -0,0 +1,120 @@
+#include "fs/LRUKReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+LRUKReplace::LRUKReplace(int capacity_) : FindReplace(capacity_) {
+    timestamp = 0;
+    last = new long long[capacity];
+    second_last = new long long[capacity];
+    prev = new int[capacity + 1];
+    next = new int[capacity + 1];
+    prev[capacity] = next[capacity] = capacity;
+    heap = new int[capacity];
+    heap_pos = new int[capacity];
+    heap_size = 0;
+}
+
+LRUKReplace::~LRUKReplace() {
+    delete[] last;
+    delete[] second_last;
+    delete[] prev;
+    delete[] next;
+    delete[] heap;
+    delete[] heap_pos;
+}
+
+void LRUKReplace::unlink(int index) {
+    next[prev[index]] = next[index];
+    prev[next[index]] = prev[index];
+}
+
+void LRUKReplace::linkHead(int index) {
+    prev[index] = capacity;
+    next[index] = next[capacity];
+    prev[next[capacity]] = index;
+    next[capacity] = index;
+}
+
+void LRUKReplace::heapSwap(int a, int b) {
+    int t = heap[a];
+    heap[a] = heap[b];
+    heap[b] = t;
+    heap_pos[heap[a]] = a;
+    heap_pos[heap[b]] = b;
+}
+
+void LRUKReplace::heapUp(int pos) {
+    while (pos > 0) {
+        int parent = (pos - 1) >> 1;
+        if (second_last[heap[parent]] <= second_last[heap[pos]]) break;
+        heapSwap(parent, pos);
+        pos = parent;
+    }
+}
+
+void LRUKReplace::heapDown(int pos) {
+    while (true) {
+        int smallest = pos;
+        int l = pos * 2 + 1, r = pos * 2 + 2;
+        if (l < heap_size &&
+            second_last[heap[l]] < second_last[heap[smallest]])
+            smallest = l;
+        if (r < heap_size &&
+            second_last[heap[r]] < second_last[heap[smallest]])
+            smallest = r;
+        if (smallest == pos) break;
+        heapSwap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+void LRUKReplace::heapRemove(int pos) {
+    heap_size--;
+    if (pos == heap_size) return;
+    heapSwap(pos, heap_size);
+    heapUp(pos);
+    heapDown(pos);
+}
+
+void LRUKReplace::onInsert(int index) {
+    last[index] = ++timestamp;
+    second_last[index] = -1;
+    linkHead(index);
+}
+
+void LRUKReplace::onAccess(int index) {
+    bool once = second_last[index] == -1;
+    second_last[index] = last[index];
+    last[index] = ++timestamp;
+    if (once) {
+        unlink(index);
+        heap[heap_size] = index;
+        heap_pos[index] = heap_size;
+        heapUp(heap_size++);
+    } else {
+        heapDown(heap_pos[index]);
+    }
+}
+
+int LRUKReplace::evict() {
+    int index;
+    if (next[capacity] != capacity) {
+        index = prev[capacity];
+        unlink(index);
+    } else {
+        index = heap[0];
+        heapRemove(0);
+    }
+    return index;
+}
+
+void LRUKReplace::onRemove(int index) {
+    if (second_last[index] == -1)
+        unlink(index);
+    else
+        heapRemove(heap_pos[index]);
+}
+
+}  // namespace fs
+}  // namespace dbs
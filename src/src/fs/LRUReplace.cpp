@@ -0,0 +1,45 @@
+#include "fs/LRUReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+LRUReplace::LRUReplace(int capacity_) : FindReplace(capacity_) {
+    prev = new int[capacity + 1];
+    next = new int[capacity + 1];
+    prev[capacity] = next[capacity] = capacity;
+}
+
+LRUReplace::~LRUReplace() {
+    delete[] prev;
+    delete[] next;
+}
+
+void LRUReplace::unlink(int index) {
+    next[prev[index]] = next[index];
+    prev[next[index]] = prev[index];
+}
+
+void LRUReplace::linkHead(int index) {
+    prev[index] = capacity;
+    next[index] = next[capacity];
+    prev[next[capacity]] = index;
+    next[capacity] = index;
+}
+
+void LRUReplace::onInsert(int index) { linkHead(index); }
+
+void LRUReplace::onAccess(int index) {
+    unlink(index);
+    linkHead(index);
+}
+
+int LRUReplace::evict() {
+    int index = prev[capacity];
+    unlink(index);
+    return index;
+}
+
+void LRUReplace::onRemove(int index) { unlink(index); }
+
+}  // namespace fs
+}  // namespace dbs
@@ -0,0 +1,64 @@
+#include "fs/PageTable.hpp"
+
+#include <cassert>
+
+namespace dbs {
+namespace fs {
+
+PageTable::PageTable(int capacity_) {
+    capacity = capacity_;
+    int bits = 1;
+    while ((1u << bits) < 2u * (uint32_t)capacity) bits++;
+    mask = (1u << bits) - 1;
+    shift = 64 - bits;
+    slots = new Slot[mask + 1];
+    clear();
+}
+
+PageTable::~PageTable() { delete[] slots; }
+
+void PageTable::clear() {
+    for (uint32_t i = 0; i <= mask; i++) {
+        slots[i].key = 0;
+        slots[i].val = -1;
+    }
+}
+
+void PageTable::insert(int fileID, int pageID, int index) {
+    assert(index >= 0);
+    uint64_t key = makeKey(fileID, pageID);
+    uint32_t pos = hash(key);
+    while (slots[pos].val != -1) {
+        assert(slots[pos].key != key);
+        pos = (pos + 1) & mask;
+    }
+    slots[pos].key = key;
+    slots[pos].val = index;
+}
+
+bool PageTable::del(int fileID, int pageID) {
+    uint64_t key = makeKey(fileID, pageID);
+    uint32_t pos = hash(key);
+    while (true) {
+        if (slots[pos].val == -1) return false;
+        if (slots[pos].key == key) break;
+        pos = (pos + 1) & mask;
+    }
+    // backward shift: 将后续探测链上的元素前移填补空位
+    uint32_t hole = pos;
+    for (uint32_t next = (hole + 1) & mask; slots[next].val != -1;
+         next = (next + 1) & mask) {
+        uint32_t home = hash(slots[next].key);
+        // home 不在 (hole, next] 的循环区间内时, 元素可以移到 hole
+        if (((next - home) & mask) >= ((next - hole) & mask)) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole].key = 0;
+    slots[hole].val = -1;
+    return true;
+}
+
+}  // namespace fs
+}  // namespace dbs
@@ -0,0 +1,73 @@
+#include "fs/TwoQueueReplace.hpp"
+
+namespace dbs {
+namespace fs {
+
+TwoQueueReplace::TwoQueueReplace(int capacity_) : FindReplace(capacity_) {
+    a1_head = capacity;
+    am_head = capacity + 1;
+    prev = new int[capacity + 2];
+    next = new int[capacity + 2];
+    in_a1 = new bool[capacity];
+    prev[a1_head] = next[a1_head] = a1_head;
+    prev[am_head] = next[am_head] = am_head;
+    a1_size = 0;
+    a1_limit = capacity / 4 > 0 ? capacity / 4 : 1;
+}
+
+TwoQueueReplace::~TwoQueueReplace() {
+    delete[] prev;
+    delete[] next;
+    delete[] in_a1;
+}
+
+void TwoQueueReplace::unlink(int index) {
+    next[prev[index]] = next[index];
+    prev[next[index]] = prev[index];
+}
+
+void TwoQueueReplace::linkHead(int head, int index) {
+    prev[index] = head;
+    next[index] = next[head];
+    prev[next[head]] = index;
+    next[head] = index;
+}
+
+void TwoQueueReplace::onInsert(int index) {
+    in_a1[index] = true;
+    a1_size++;
+    linkHead(a1_head, index);
+}
+
+void TwoQueueReplace::onAccess(int index) {
+    unlink(index);
+    if (in_a1[index]) {
+        in_a1[index] = false;
+        a1_size--;
+    }
+    linkHead(am_head, index);
+}
+
+int TwoQueueReplace::evict() {
+    int index;
+    if (a1_size > a1_limit || next[am_head] == am_head) {
+        index = prev[a1_head];
+        in_a1[index] = false;
+        a1_size--;
+    } else {
+        index = prev[am_head];
+    }
+    unlink(index);
+    return index;
+}
+
+void TwoQueueReplace::onRemove(int index) {
+    unlink(index);
+    if (in_a1[index]) {
+        in_a1[index] = false;
+        a1_size--;
+    }
+}
+
+}  // namespace fs
+}  // namespace dbs
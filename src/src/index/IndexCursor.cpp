@@ -0,0 +1,38 @@
+#include "index/IndexCursor.hpp"
+
+#include "index/IndexManager.hpp"
+
+namespace dbs {
+namespace index {
+
+IndexCursor::IndexCursor(IndexManager* im_)
+    : im(im_), index_key_num(0), leaf_page_id(-1), pos(0) {}
+
+bool IndexCursor::seek(const char* file_path_,
+                       const IndexValue& search_value_low,
+                       const IndexValue& search_value_high) {
+    close();
+    file_path = file_path_;
+    search_key_high = search_value_high.key;
+    return im->seekLeafChild(file_path_, search_value_low, search_value_high,
+                             index_key_num, leaf_page_id, pos);
+}
+
+bool IndexCursor::next(IndexValue& index_value) {
+    if (leaf_page_id == -1) return false;
+    if (!im->nextLeafChild(file_path.c_str(), index_key_num,
+                           search_key_high.data(), leaf_page_id, pos,
+                           index_value)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void IndexCursor::close() {
+    leaf_page_id = -1;
+    pos = 0;
+}
+
+}  // namespace index
+}  // namespace dbs
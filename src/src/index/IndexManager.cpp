@@ -1,8 +1,101 @@
 #include "index/IndexManager.hpp"
 
+#include <algorithm>
+
+#include "index/IndexCursor.hpp"
+
 namespace dbs {
 namespace index {
 
+namespace {
+
+// 节点页的存储: 页头 4 个 buf 依次为 prev, next, 子节点数, 是否叶节点
+// 之后依次存放子节点, 叶节点的子节点为 [page_id, slot_id, key...],
+// 内部节点的子节点为 [page_id, max_key...], 均按键从小到大排列
+const int HEADER_BUF = INDEX_HEADER_BYTE_LEN >> LOG_BYTE_PER_BUF;
+
+void setNodeHeader(BufType b, int prev_page_id, int next_page_id,
+                   int children_num, bool is_leaf) {
+    b[0] = prev_page_id;
+    b[1] = next_page_id;
+    b[2] = children_num;
+    b[3] = is_leaf;
+}
+
+// 子节点的长度, 单位: buf
+int childLength(bool is_leaf, int index_key_num) {
+    return is_leaf ? index_key_num + 2 : index_key_num + 1;
+}
+
+BufType childAt(BufType b, int pos, int child_length) {
+    return b + HEADER_BUF + pos * child_length;
+}
+
+/**
+ * @brief 按 int 逐个比较页上的键与 key
+ * @return 负数, 0, 正数分别表示页上的键小于, 等于, 大于 key
+ */
+int compareKey(const unsigned int* page_key, const int* key,
+               int index_key_num) {
+    for (int i = 0; i < index_key_num; i++) {
+        int value = page_key[i];
+        if (value != key[i]) return value < key[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief 在节点页上二分查找第一个键不小于 key 的子节点
+ * 内部节点比较子节点的 max_key
+ * @return 子节点下标, 没有时为子节点数
+ */
+int lowerBound(BufType b, const int* key, int index_key_num) {
+    int child_length = childLength(b[3], index_key_num);
+    const unsigned int* first = childAt(b, 0, child_length) + child_length -
+                                index_key_num;
+    int low = 0, high = b[2];
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (compareKey(first + mid * child_length, key, index_key_num) < 0)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+// 在 pos 处空出一个子节点的位置, 返回该位置
+BufType openChild(BufType b, int pos, int child_length) {
+    BufType child = childAt(b, pos, child_length);
+    memmove(child + child_length, child,
+            (b[2] - pos) * child_length * BYTE_PER_BUF);
+    b[2]++;
+    return child;
+}
+
+void eraseChild(BufType b, int pos, int child_length) {
+    BufType child = childAt(b, pos, child_length);
+    b[2]--;
+    memmove(child, child + child_length,
+            (b[2] - pos) * child_length * BYTE_PER_BUF);
+}
+
+void insertInternalChild(BufType b, int pos,
+                         const BPlusTreeInternalChild& internal_child,
+                         int index_key_num) {
+    BufType child = openChild(b, pos, index_key_num + 1);
+    child[0] = internal_child.page_id;
+    memcpy(child + 1, internal_child.max_key.data(),
+           index_key_num * BYTE_PER_BUF);
+}
+
+void setMaxKey(BPlusTreeInternalChild& internal_child,
+               const unsigned int* page_key, int index_key_num) {
+    internal_child.max_key.assign(page_key, page_key + index_key_num);
+}
+
+}  // namespace
+
 IndexManager::IndexManager(fs::FileManager* fm_, fs::BufPageManager* bpm_) {
     fm = fm_;
     bpm = bpm_;
@@ -17,13 +110,13 @@ IndexManager::~IndexManager() {
 }
 
 void IndexManager::closeAllCurrentFile() {
-    bpm->close();
     for (auto& file_path : current_opening_file_paths) {
         delete[] file_path;
         file_path = nullptr;
     }
     current_opening_file_paths.clear();
     for (auto& file_id : current_opening_file_ids) {
+        bpm->closeFile(file_id);
         fm->closeFile(file_id);
     }
     current_opening_file_ids.clear();
@@ -34,7 +127,7 @@ void IndexManager::closeFileIfExist(const char* file_path) {
     for (int i = 0; i < current_opening_file_num; i++) {
         if (strcmp(current_opening_file_paths[i], file_path) == 0) {
             int file_id = current_opening_file_ids[i];
-            bpm->close();
+            bpm->closeFile(file_id);
             fm->closeFile(file_id);
             delete[] current_opening_file_paths[i];
             current_opening_file_paths[i] = nullptr;
@@ -51,7 +144,7 @@ void IndexManager::closeFirstFile() {
     if (current_opening_file_ids.size() == 0) return;
     int file_id = current_opening_file_ids.front();
     current_opening_file_ids.erase(current_opening_file_ids.begin());
-    bpm->close();
+    bpm->closeFile(file_id);
     fm->closeFile(file_id);
     delete[] current_opening_file_paths.front();
     current_opening_file_paths.front() = nullptr;
@@ -113,20 +206,24 @@ int IndexManager::getFirstEmptyPageId(int file_id, bool set) {
     int base_page_id = 1;
     while (base_page_id != -1) {
         b = bpm->getPage(file_id, base_page_id, index);
-        bpm->access(index);
         for (int i = 0; i < BUF_PER_PAGE - 1; i++) {
             if (b[i] != 0xffffffff) {
                 int j = utils::getFirstZeroBit(b[i]);
                 if (set) {
                     utils::setBitFromNum(b[i], j, true);
                     bpm->markDirty(index);
+                } else {
+                    bpm->access(index);
                 }
                 return (i << LOG_BIT_PER_BUF) + j + offset;
             }
         }
         offset += (INDEX_BITMAP_PAGE_BYTE_LEN << LOG_BIT_PER_BYTE);
+        if (b[BUF_PER_PAGE - 1] == (unsigned int)-1) break;
         base_page_id = b[BUF_PER_PAGE - 1];
+        bpm->access(index);
     }
+    // 所有 bitmap 页都满了, 最后一页链到新的 bitmap 页
     b[BUF_PER_PAGE - 1] = offset;
     bpm->markDirty(index);
     createEmptyBitMapPage(file_id, offset);
@@ -145,75 +242,6 @@ int IndexManager::getBPlusTreeItemLength(int index_key_num) {
     return (index_key_num + 2) << LOG_BYTE_PER_BUF;
 }
 
-void IndexManager::writeBPlusTreeInternalNode2Page(
-    BufType b, const BPlusTreeInternalNode& node, int index_key_num) {
-    b[0] = node.prev_page_id;     // 上一个同级节点页号
-    b[1] = node.next_page_id;     // 下一个同级节点页号
-    b[2] = node.children.size();  // 子节点数量
-    b[3] = 0;                     // 是否是叶节点
-    int buf_offset = INDEX_HEADER_BYTE_LEN >> LOG_BYTE_PER_BUF;
-    for (auto& child : node.children) {
-        b[buf_offset++] = child.page_id;
-        for (int i = 0; i < index_key_num; i++) {
-            b[buf_offset++] = child.max_key[i];
-        }
-    }
-}
-
-void IndexManager::readBPlusTreeInternalNodeFromPage(
-    BufType b, BPlusTreeInternalNode& node, int index_key_num) {
-    node.prev_page_id = b[0];  // 上一个同级节点页号
-    node.next_page_id = b[1];  // 下一个同级节点页号
-    int children_num = b[2];   // 子节点数量
-    assert(b[3] == 0);         // 是否是叶节点
-    node.children.clear();
-    int buf_offset = INDEX_HEADER_BYTE_LEN >> LOG_BYTE_PER_BUF;
-    for (int i = 0; i < children_num; i++) {
-        BPlusTreeInternalChild child(b[buf_offset++], index_key_num);
-        for (int j = 0; j < index_key_num; j++) {
-            child.max_key[j] = b[buf_offset++];
-        }
-        node.children.push_back(child);
-    }
-}
-
-void IndexManager::writeBPlusTreeLeafNode2Page(BufType b,
-                                               const BPlusTreeLeafNode& node,
-                                               int index_key_num) {
-    b[0] = node.prev_page_id;     // 上一个同级节点页号
-    b[1] = node.next_page_id;     // 下一个同级节点页号
-    b[2] = node.children.size();  // 子节点数量
-    b[3] = 1;                     // 是否是叶节点
-    int buf_offset = INDEX_HEADER_BYTE_LEN >> LOG_BYTE_PER_BUF;
-    for (auto& child : node.children) {
-        b[buf_offset++] = child.page_id;
-        b[buf_offset++] = child.slot_id;
-        for (int i = 0; i < index_key_num; i++) {
-            b[buf_offset++] = child.key[i];
-        }
-    }
-}
-
-void IndexManager::readBPlusTreeLeafNodeFromPage(BufType b,
-                                                 BPlusTreeLeafNode& node,
-                                                 int index_key_num) {
-    node.prev_page_id = b[0];  // 上一个同级节点页号
-    node.next_page_id = b[1];  // 下一个同级节点页号
-    int children_num = b[2];   // 子节点数量
-    assert(b[3] == 1);         // 是否是叶节点
-    node.children.clear();
-    int buf_offset = INDEX_HEADER_BYTE_LEN >> LOG_BYTE_PER_BUF;
-    for (int i = 0; i < children_num; i++) {
-        BPlusTreeLeafChild child(b[buf_offset], b[buf_offset + 1],
-                                 index_key_num);
-        buf_offset += 2;
-        for (int j = 0; j < index_key_num; j++) {
-            child.key[j] = b[buf_offset++];
-        }
-        node.children.push_back(child);
-    }
-}
-
 void IndexManager::setPrevPageID(int file_id, int page_id, int prev_page_id) {
     BufType b;
     int index;
@@ -276,17 +304,16 @@ void IndexManager::initializeIndexFile(const char* file_path,
     bpm->markDirty(index);
 
     // 初始化叶节点
-    BPlusTreeLeafNode leaf_node(-1, -1);
-    BPlusTreeInternalNode root_node(-1, -1);
-    root_node.children.push_back(
-        BPlusTreeInternalChild(leaf_page_id, index_key_num));
-
     b = bpm->getPage(file_id, leaf_page_id, index);
-    writeBPlusTreeLeafNode2Page(b, leaf_node, index_key_num);
+    setNodeHeader(b, -1, -1, 0, true);
     bpm->markDirty(index);
 
+    // 根节点只有一个子节点, 最大值为最小的键
     b = bpm->getPage(file_id, root_page_id, index);
-    writeBPlusTreeInternalNode2Page(b, root_node, index_key_num);
+    setNodeHeader(b, -1, -1, 1, false);
+    BufType child = childAt(b, 0, index_key_num + 1);
+    child[0] = leaf_page_id;
+    for (int i = 0; i < index_key_num; i++) child[1 + i] = INT_MIN;
     bpm->markDirty(index);
 }
 
@@ -310,18 +337,15 @@ bool IndexManager::insertIndex(const char* file_path,
     if (root_page_id == -1) return false;
 
     // insert
-    BPlusTreeLeafChild leaf_child(index_value);
-    insertNode(file_id, root_page_id, leaf_child, index_key_num, m);
+    insertNode(file_id, root_page_id, index_value, index_key_num, m);
 
     // 处理根节点上溢
     if (tmp_tree_internal_child[0].page_id != -1) {
         int new_root_page_id = getFirstEmptyPageId(file_id, true);
-        BPlusTreeInternalNode new_root(-1, -1);
-        new_root.children.push_back(tmp_tree_internal_child[0]);
-        new_root.children.push_back(tmp_tree_internal_child[1]);
-
         b = bpm->getPage(file_id, new_root_page_id, index);
-        writeBPlusTreeInternalNode2Page(b, new_root, index_key_num);
+        setNodeHeader(b, -1, -1, 0, false);
+        insertInternalChild(b, 0, tmp_tree_internal_child[0], index_key_num);
+        insertInternalChild(b, 1, tmp_tree_internal_child[1], index_key_num);
         bpm->markDirty(index);
 
         b = bpm->getPage(file_id, 0, index);
@@ -333,209 +357,211 @@ bool IndexManager::insertIndex(const char* file_path,
     return true;
 }
 
-bool IndexManager::handleInternalNodeOverflow(
-    int file_id, int page_id, BPlusTreeInternalNode& node,
-    const std::list<dbs::index::BPlusTreeInternalChild>::iterator& insert_pos,
-    int index_key_num, int b_plus_tree_m) {
-    // 子节点是否上溢
-    if (tmp_tree_internal_child[0].page_id == -1) {
-        return false;  // 当前节点不需要更新
+void IndexManager::allocateNodePages(int file_id, int node_num,
+                                     int first_page_id,
+                                     std::vector<int>& page_ids) {
+    page_ids.clear();
+    if (first_page_id != -1) page_ids.push_back(first_page_id);
+    while ((int)page_ids.size() < node_num) {
+        page_ids.push_back(getFirstEmptyPageId(file_id, true));
     }
+}
 
-    // 因为子节点上溢了，更新当前节点
-    *insert_pos = tmp_tree_internal_child[0];
-    node.children.insert(std::next(insert_pos), tmp_tree_internal_child[1]);
+bool IndexManager::bulkLoadIndex(const char* file_path,
+                                 const std::vector<IndexValue>& index_values,
+                                 double fill_factor) {
+    // open file
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
 
-    // 当前节点是否上溢
-    if (node.children.size() <= (size_t)b_plus_tree_m) {
-        // 当前节点没有上溢
-        tmp_tree_internal_child[0].page_id = -1;
-        tmp_tree_internal_child[1].page_id = -1;
-    } else {
-        // 当前节点上溢
+    // meta info
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, 0, index);
+    int index_key_num = b[0];
+    bpm->access(index);
+    int m = getBPlusTreeM(index_key_num);
 
-        // 一分为二，插入新节点
-        int new_node_page_id = getFirstEmptyPageId(file_id, true);
-        BPlusTreeInternalNode new_node;
-        splitInternalNode(node, new_node, page_id, new_node_page_id,
-                          index_key_num, b_plus_tree_m);
+    // check validity
+    for (auto& index_value : index_values) {
+        if (index_value.key.size() != (size_t)index_key_num) return false;
+    }
 
-        // 当前节点的下一个同级页面，修改指针
-        if (new_node.next_page_id != -1) {
-            setPrevPageID(file_id, new_node.next_page_id, new_node_page_id);
-        }
+    // 清空整棵树, 根节点和第一个叶节点沿用初始化时的页面
+    initializeIndexFile(file_path, index_key_num);
+    if (index_values.empty()) return true;
+    file_id = openFile(file_path);
+    b = bpm->getPage(file_id, 0, index);
+    int root_page_id = b[1];
+    bpm->access(index);
+    b = bpm->getPage(file_id, root_page_id, index);
+    int leaf_page_id = childAt(b, 0, index_key_num + 1)[0];
+    bpm->access(index);
 
-        // 新节点写入文件
-        BufType b;
-        int index;
-        b = bpm->getPage(file_id, new_node_page_id, index);
-        writeBPlusTreeInternalNode2Page(b, new_node, index_key_num);
+    // 内部节点至少要有两个子节点, 否则层数不会减少
+    int node_capacity = std::clamp((int)(m * fill_factor), 2, m);
+    std::vector<int> page_ids;
+    // 上一层每个节点在本层对应的子节点
+    std::vector<BPlusTreeInternalChild> children, parents;
+
+    // 叶节点层, 子节点平均分到各个节点
+    int item_num = index_values.size();
+    int node_num = (item_num + node_capacity - 1) / node_capacity;
+    int child_length = index_key_num + 2;
+    allocateNodePages(file_id, node_num, leaf_page_id, page_ids);
+    for (int i = 0; i < node_num; i++) {
+        int begin = (long long)item_num * i / node_num;
+        int end = (long long)item_num * (i + 1) / node_num;
+        b = bpm->getPage(file_id, page_ids[i], index);
+        setNodeHeader(b, i == 0 ? -1 : page_ids[i - 1],
+                      i == node_num - 1 ? -1 : page_ids[i + 1], end - begin,
+                      true);
+        BufType child = childAt(b, 0, child_length);
+        for (int j = begin; j < end; j++, child += child_length) {
+            child[0] = index_values[j].page_id;
+            child[1] = index_values[j].slot_id;
+            memcpy(child + 2, index_values[j].key.data(),
+                   index_key_num * BYTE_PER_BUF);
+        }
         bpm->markDirty(index);
+        children.push_back(
+            BPlusTreeInternalChild(page_ids[i], index_values[end - 1].key));
     }
-    return true;  // 当前节点需要更新
-}
-
-void IndexManager::splitInternalNode(BPlusTreeInternalNode& origin_node,
-                                     BPlusTreeInternalNode& new_node,
-                                     int origin_node_page_id,
-                                     int new_node_page_id, int index_key_num,
-                                     int b_plus_tree_m) {
-    // 链表连接
-    new_node.prev_page_id = origin_node_page_id;
-    new_node.next_page_id = origin_node.next_page_id;
-    origin_node.next_page_id = new_node_page_id;
-
-    // 切分children
-    auto middle =
-        std::next(origin_node.children.begin(), (b_plus_tree_m + 1) / 2);
-    new_node.children.splice(new_node.children.begin(), origin_node.children,
-                             middle, origin_node.children.end());
-
-    // 设置tmp_tree_internal_child
-    tmp_tree_internal_child[0] = BPlusTreeInternalChild(
-        origin_node_page_id, origin_node.children.back().max_key);
-    tmp_tree_internal_child[1] = BPlusTreeInternalChild(
-        new_node_page_id, new_node.children.back().max_key);
-
-    return;
-}
-
-void IndexManager::handleLeafNodeOverflow(int file_id, int page_id,
-                                          BPlusTreeLeafNode& node,
-                                          int index_key_num,
-                                          int b_plus_tree_m) {
-    if (node.children.size() <= (size_t)b_plus_tree_m) {
-        // 当前节点没有上溢
-        tmp_tree_internal_child[0].page_id = -1;
-        tmp_tree_internal_child[1].page_id = -1;
-        return;
-    }
-    // 当前节点上溢
 
-    // 一分为二，插入新节点
-    int new_node_page_id = getFirstEmptyPageId(file_id, true);
-    BPlusTreeLeafNode new_node;
-    splitLeafNode(node, new_node, page_id, new_node_page_id, index_key_num,
-                  b_plus_tree_m);
+    // 内部节点层, 直到只剩根节点
+    child_length = index_key_num + 1;
+    do {
+        item_num = children.size();
+        node_num = (item_num + node_capacity - 1) / node_capacity;
+        allocateNodePages(file_id, node_num, node_num == 1 ? root_page_id : -1,
+                          page_ids);
+        parents.clear();
+        for (int i = 0; i < node_num; i++) {
+            int begin = (long long)item_num * i / node_num;
+            int end = (long long)item_num * (i + 1) / node_num;
+            b = bpm->getPage(file_id, page_ids[i], index);
+            setNodeHeader(b, i == 0 ? -1 : page_ids[i - 1],
+                          i == node_num - 1 ? -1 : page_ids[i + 1],
+                          end - begin, false);
+            BufType child = childAt(b, 0, child_length);
+            for (int j = begin; j < end; j++, child += child_length) {
+                child[0] = children[j].page_id;
+                memcpy(child + 1, children[j].max_key.data(),
+                       index_key_num * BYTE_PER_BUF);
+            }
+            bpm->markDirty(index);
+            parents.push_back(
+                BPlusTreeInternalChild(page_ids[i], children[end - 1].max_key));
+        }
+        children.swap(parents);
+    } while (children.size() > 1);
 
-    // 当前页面的下一个同级页面，修改指针
-    if (new_node.next_page_id != -1) {
-        setPrevPageID(file_id, new_node.next_page_id, new_node_page_id);
-    }
+    return true;
+}
+
+void IndexManager::splitNode(int file_id, int page_id, int index_key_num,
+                             int b_plus_tree_m) {
+    int new_node_page_id = getFirstEmptyPageId(file_id, true);
 
-    // 新节点写入文件
     BufType b;
     int index;
-    b = bpm->getPage(file_id, new_node_page_id, index);
-    writeBPlusTreeLeafNode2Page(b, new_node, index_key_num);
+    b = bpm->getPage(file_id, page_id, index);
+    bool is_leaf = b[3];
+    int child_length = childLength(is_leaf, index_key_num);
+    int key_offset = child_length - index_key_num;
+    int children_num = b[2];
+    int next_page_id = b[1];
+
+    // 后一半移入新节点, 原节点保留前 (M + 1) / 2 个
+    int keep_num = (b_plus_tree_m + 1) / 2;
+    int move_num = children_num - keep_num;
+    unsigned int moved[BUF_PER_PAGE];
+    memcpy(moved, childAt(b, keep_num, child_length),
+           move_num * child_length * BYTE_PER_BUF);
+    b[1] = new_node_page_id;
+    b[2] = keep_num;
+    tmp_tree_internal_child[0].page_id = page_id;
+    setMaxKey(tmp_tree_internal_child[0],
+              childAt(b, keep_num - 1, child_length) + key_offset,
+              index_key_num);
     bpm->markDirty(index);
-}
-
-void IndexManager::splitLeafNode(BPlusTreeLeafNode& origin_node,
-                                 BPlusTreeLeafNode& new_node,
-                                 int origin_node_page_id, int new_node_page_id,
-                                 int index_key_num, int b_plus_tree_m) {
-    // 链表连接
-    new_node.prev_page_id = origin_node_page_id;
-    new_node.next_page_id = origin_node.next_page_id;
-    origin_node.next_page_id = new_node_page_id;
-
-    // 切分children
-    auto middle =
-        std::next(origin_node.children.begin(), (b_plus_tree_m + 1) / 2);
-    new_node.children.splice(new_node.children.begin(), origin_node.children,
-                             middle, origin_node.children.end());
 
-    // 设置tmp_tree_internal_child
-    tmp_tree_internal_child[0] = BPlusTreeInternalChild(
-        origin_node_page_id, origin_node.children.back().key);
-    tmp_tree_internal_child[1] =
-        BPlusTreeInternalChild(new_node_page_id, new_node.children.back().key);
+    // 新节点写入文件
+    b = bpm->getPage(file_id, new_node_page_id, index);
+    setNodeHeader(b, page_id, next_page_id, move_num, is_leaf);
+    memcpy(childAt(b, 0, child_length), moved,
+           move_num * child_length * BYTE_PER_BUF);
+    tmp_tree_internal_child[1].page_id = new_node_page_id;
+    setMaxKey(tmp_tree_internal_child[1],
+              childAt(b, move_num - 1, child_length) + key_offset,
+              index_key_num);
+    bpm->markDirty(index);
 
-    return;
+    // 原节点的下一个同级页面，修改指针
+    if (next_page_id != -1) {
+        setPrevPageID(file_id, next_page_id, new_node_page_id);
+    }
 }
 
 void IndexManager::insertNode(int file_id, int page_id,
-                              const BPlusTreeLeafChild& insert_item,
+                              const IndexValue& insert_value,
                               int index_key_num, int b_plus_tree_m) {
     BufType b;
     int index;
     b = bpm->getPage(file_id, page_id, index);
     bool is_leaf = b[3];
+    const int* key = insert_value.key.data();
+    // 第一个不小于插入值的子节点
+    int pos = lowerBound(b, key, index_key_num);
     if (is_leaf) {
-        // 如果是叶节点
-
-        // 读取节点
-        BPlusTreeLeafNode node;
-        readBPlusTreeLeafNodeFromPage(b, node, index_key_num);
-        bpm->access(index);
-
-        // 插入
-        auto child_itr = node.children.begin();
-        for (; child_itr != node.children.end(); child_itr++) {
-            if (insert_item <= *child_itr) {
-                node.children.insert(child_itr, insert_item);
-                break;
-            }
-        }
-        if (child_itr == node.children.end()) {
-            node.children.push_back(insert_item);
-        }
-
-        // 检查overflow
-        handleLeafNodeOverflow(file_id, page_id, node, index_key_num,
-                               b_plus_tree_m);
-
-        // 写回
-        b = bpm->getPage(file_id, page_id, index);
-        writeBPlusTreeLeafNode2Page(b, node, index_key_num);
+        // 如果是叶节点, 插在pos之前
+        BufType child = openChild(b, pos, index_key_num + 2);
+        child[0] = insert_value.page_id;
+        child[1] = insert_value.slot_id;
+        memcpy(child + 2, key, index_key_num * BYTE_PER_BUF);
         bpm->markDirty(index);
-        return;
     } else {
         // 不是叶节点
-
-        // 读取节点
-        BPlusTreeInternalNode node;
-        readBPlusTreeInternalNodeFromPage(b, node, index_key_num);
-        bpm->access(index);
-
-        // 插入
-        for (auto child_itr = node.children.begin();
-             child_itr != node.children.end(); child_itr++) {
-            if (insert_item <= *child_itr) {
-                // 被插入节点小于max，递归插入
-                insertNode(file_id, child_itr->page_id, insert_item,
-                           index_key_num, b_plus_tree_m);
-
-                // 处理overflow
-                if (handleInternalNodeOverflow(file_id, page_id, node,
-                                               child_itr, index_key_num,
-                                               b_plus_tree_m)) {
-                    // 如有必要，写回
-                    b = bpm->getPage(file_id, page_id, index);
-                    writeBPlusTreeInternalNode2Page(b, node, index_key_num);
-                    bpm->markDirty(index);
-                }
-                return;
-            }
+        int children_num = b[2];
+        int child_length = index_key_num + 1;
+        if (pos == children_num) {
+            // 被插入节点大于max，更新max
+            pos = children_num - 1;
+            memcpy(childAt(b, pos, child_length) + 1, key,
+                   index_key_num * BYTE_PER_BUF);
+            bpm->markDirty(index);
+        } else {
+            bpm->access(index);
         }
-        // 被插入节点大于max，更新max
-        node.children.back().max_key = insert_item.key;
 
-        // 插入
-        insertNode(file_id, node.children.back().page_id, insert_item,
+        // 被插入节点小于等于max，递归插入
+        insertNode(file_id, childAt(b, pos, child_length)[0], insert_value,
                    index_key_num, b_plus_tree_m);
 
-        // 处理overflow
-        handleInternalNodeOverflow(file_id, page_id, node,
-                                   std::prev(node.children.end()),
-                                   index_key_num, b_plus_tree_m);
+        // 子节点是否上溢
+        if (tmp_tree_internal_child[0].page_id == -1) return;
 
-        // 写回
+        // 因为子节点上溢了，用分裂后的两个节点替换原来的子节点
         b = bpm->getPage(file_id, page_id, index);
-        writeBPlusTreeInternalNode2Page(b, node, index_key_num);
+        BufType child = childAt(b, pos, child_length);
+        child[0] = tmp_tree_internal_child[0].page_id;
+        memcpy(child + 1, tmp_tree_internal_child[0].max_key.data(),
+               index_key_num * BYTE_PER_BUF);
+        insertInternalChild(b, pos + 1, tmp_tree_internal_child[1],
+                            index_key_num);
         bpm->markDirty(index);
     }
+
+    // 当前节点是否上溢
+    b = bpm->getPage(file_id, page_id, index);
+    bool overflow = (int)b[2] > b_plus_tree_m;
+    bpm->access(index);
+    if (overflow) {
+        splitNode(file_id, page_id, index_key_num, b_plus_tree_m);
+    } else {
+        tmp_tree_internal_child[0].page_id = -1;
+        tmp_tree_internal_child[1].page_id = -1;
+    }
 }
 
 bool IndexManager::searchIndex(const char* file_path,
@@ -551,6 +577,20 @@ bool IndexManager::searchIndexInRanges(
     std::vector<IndexValue>& search_results) {
     search_results.clear();
 
+    IndexCursor cursor(this);
+    if (!cursor.seek(file_path, search_value_low, search_value_high))
+        return false;
+    IndexValue index_value;
+    while (cursor.next(index_value)) search_results.push_back(index_value);
+    cursor.close();
+    return true;
+}
+
+bool IndexManager::searchIndexBatch(
+    const char* file_path, const std::vector<std::vector<int>>& search_keys,
+    std::vector<bool>& found) {
+    found.assign(search_keys.size(), false);
+
     // open file
     int file_id = openFile(file_path);
     assert(file_id != -1);
@@ -563,97 +603,178 @@ bool IndexManager::searchIndexInRanges(
     int root_page_id = b[1];
     bpm->access(index);
 
+    // check validity
+    for (auto& search_key : search_keys)
+        if (search_key.size() != (size_t)index_key_num) return false;
+
+    int child_length = index_key_num + 2;
+    // 叶节点中最大的键不小于 key 时, 若前一个叶节点的最大键小于 key,
+    // 第一个不小于 key 的项就在这个叶节点中
+    auto inLeaf = [&](BufType b, const int* key) {
+        int children_num = b[2];
+        return children_num > 0 &&
+               compareKey(childAt(b, children_num - 1, child_length) + 2, key,
+                          index_key_num) >= 0;
+    };
+    int leaf_page_id = -1;
+    for (int i = 0; i < (int)search_keys.size(); i++) {
+        const int* key = search_keys[i].data();
+        // 上一个键所在的叶节点和它的下一个叶节点中的键都比这个键小时,
+        // 从根节点重新查找
+        bool located = false;
+        for (int step = 0; step < 2 && leaf_page_id != -1; step++) {
+            b = bpm->getPage(file_id, leaf_page_id, index);
+            located = inLeaf(b, key);
+            int next_page_id = b[1];
+            bpm->access(index);
+            if (located) break;
+            leaf_page_id = next_page_id;
+        }
+        if (!located && !searchNode(file_id, root_page_id, key, index_key_num,
+                                    leaf_page_id)) {
+            // 之后的键都比索引中所有的键大
+            break;
+        }
+        b = bpm->getPage(file_id, leaf_page_id, index);
+        int pos = lowerBound(b, key, index_key_num);
+        found[i] = compareKey(childAt(b, pos, child_length) + 2, key,
+                              index_key_num) == 0;
+        bpm->access(index);
+    }
+    return true;
+}
+
+bool IndexManager::seekLeafChild(const char* file_path,
+                                 const IndexValue& search_value_low,
+                                 const IndexValue& search_value_high,
+                                 int& index_key_num, int& leaf_page_id,
+                                 int& pos) {
+    leaf_page_id = -1;
+    pos = 0;
+
+    // open file
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
+
+    // meta info
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, 0, index);
+    index_key_num = b[0];
+    int root_page_id = b[1];
+    bpm->access(index);
+
     // check validity
     if (search_value_low.key.size() != (size_t)index_key_num) return false;
     if (search_value_high.key.size() != (size_t)index_key_num) return false;
 
-    BPlusTreeLeafNode leaf_result;
-    if (!searchNode(file_id, root_page_id, BPlusTreeLeafChild(search_value_low),
-                    index_key_num, leaf_result)) {
+    int page_id;
+    if (!searchNode(file_id, root_page_id, search_value_low.key.data(),
+                    index_key_num, page_id, search_value_high.key.data())) {
         return true;
     }
 
-    searchForward(file_id, leaf_result, index_key_num,
-                  BPlusTreeLeafChild(search_value_low),
-                  BPlusTreeLeafChild(search_value_high), search_results);
-
+    b = bpm->getPage(file_id, page_id, index);
+    pos = lowerBound(b, search_value_low.key.data(), index_key_num);
+    bpm->access(index);
+    leaf_page_id = page_id;
     return true;
 }
 
-bool IndexManager::searchNode(int file_id, int page_id,
-                              const BPlusTreeLeafChild& search_value,
-                              int index_key_num,
-                              BPlusTreeLeafNode& leaf_result) {
+bool IndexManager::nextLeafChild(const char* file_path, int index_key_num,
+                                 const int* search_key_high,
+                                 int& leaf_page_id, int& pos,
+                                 IndexValue& index_value) {
+    // 两次调用之间文件可能被缓存关掉, 每次重新打开
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
+
     BufType b;
     int index;
-    b = bpm->getPage(file_id, page_id, index);
-    bool is_leaf = b[3];
-    if (is_leaf) {
-        // 如果是叶节点
-
-        // 读取节点
-        BPlusTreeLeafNode node;
-        readBPlusTreeLeafNodeFromPage(b, node, index_key_num);
-        bpm->access(index);
-
-        if (node.children.size() > 0 && search_value <= node.children.back()) {
-            leaf_result = node;
+    int child_length = index_key_num + 2;
+    while (leaf_page_id != -1) {
+        b = bpm->getPage(file_id, leaf_page_id, index);
+        if (pos < (int)b[2]) {
+            BufType child = childAt(b, pos, child_length);
+            if (compareKey(child + 2, search_key_high, index_key_num) > 0) {
+                bpm->access(index);
+                leaf_page_id = -1;
+                return false;
+            }
+            index_value.page_id = child[0];
+            index_value.slot_id = child[1];
+            index_value.key.assign(child + 2, child + 2 + index_key_num);
+            bpm->access(index);
+            pos++;
             return true;
         }
-
-        // 没找到
-        return false;
-    } else {
-        // 不是叶节点
-
-        // 读取节点
-        BPlusTreeInternalNode node;
-        readBPlusTreeInternalNodeFromPage(b, node, index_key_num);
+        // 这个叶节点读完了, 从下一个叶节点的开头继续
+        leaf_page_id = b[1];
+        pos = 0;
         bpm->access(index);
+    }
+    return false;
+}
 
-        // 搜索
-        for (auto& child : node.children) {
-            if (search_value <= child) {
-                return searchNode(file_id, child.page_id, search_value,
-                                  index_key_num, leaf_result);
-            }
+bool IndexManager::searchNode(int file_id, int page_id,
+                              const int* search_key, int index_key_num,
+                              int& leaf_page_id,
+                              const int* search_key_high) {
+    BufType b;
+    int index;
+    while (true) {
+        b = bpm->getPage(file_id, page_id, index);
+        bool is_leaf = b[3];
+        int children_num = b[2];
+        if (is_leaf) {
+            // 如果是叶节点, 最大的键不小于search_key时找到
+            bool found =
+                children_num > 0 &&
+                compareKey(childAt(b, children_num - 1, index_key_num + 2) + 2,
+                           search_key, index_key_num) >= 0;
+            bpm->access(index);
+            if (found) leaf_page_id = page_id;
+            return found;
         }
 
-        // 没找到
-        return false;
+        // 不是叶节点, 找第一个max不小于search_key的子节点
+        int pos = lowerBound(b, search_key, index_key_num);
+        if (pos == children_num) {
+            // 没找到
+            bpm->access(index);
+            return false;
+        }
+        BufType child = childAt(b, pos, index_key_num + 1);
+        page_id = child[0];
+        if (search_key_high != nullptr &&
+            compareKey(child + 1, search_key_high, index_key_num) < 0) {
+            bpm->access(index);
+            prefetchLeaves(file_id, b, pos, search_key_high, index_key_num);
+            continue;
+        }
+        bpm->access(index);
     }
 }
 
-void IndexManager::searchForward(int file_id,
-                                 const BPlusTreeLeafNode& base_node,
-                                 int index_key_num,
-                                 const BPlusTreeLeafChild& search_value_low,
-                                 const BPlusTreeLeafChild& search_value_high,
-                                 std::vector<IndexValue>& search_results) {
-    assert(base_node.children.size() > 0);
-    // 从base_node的base_slot_itr开始向后搜索，直到search_value_high
-    for (auto itr = base_node.children.begin(); itr != base_node.children.end();
-         itr++) {
-        if (search_value_low <= *itr && *itr <= search_value_high) {
-            search_results.push_back(
-                IndexValue(itr->page_id, itr->slot_id, itr->key));
-        } else if (search_value_high < *itr) {
-            return;
-        }
+void IndexManager::prefetchLeaves(int file_id, BufType b, int pos,
+                                  const int* search_key_high,
+                                  int index_key_num) {
+    // 只在叶节点的上一层预读, 范围内后续的叶节点一起提交读入
+    int child_length = index_key_num + 1;
+    int children_num = b[2];
+    int first_page_id = childAt(b, pos, child_length)[0];
+    std::vector<int> pages;
+    for (int i = pos + 1;
+         i < children_num && (int)pages.size() < READ_AHEAD_PAGES; i++) {
+        BufType child = childAt(b, i, child_length);
+        pages.push_back(child[0]);
+        if (compareKey(child + 1, search_key_high, index_key_num) >= 0) break;
     }
-
-    // Get next page
-    if (base_node.next_page_id == -1) return;
-    BufType b;
     int index;
-    b = bpm->getPage(file_id, base_node.next_page_id, index);
-    BPlusTreeLeafNode next_node;
-    readBPlusTreeLeafNodeFromPage(b, next_node, index_key_num);
+    b = bpm->getPage(file_id, first_page_id, index);
+    bool is_leaf = b[3];
     bpm->access(index);
-
-    // 递归
-    searchForward(file_id, next_node, index_key_num, search_value_low,
-                  search_value_high, search_results);
+    if (is_leaf) bpm->prefetchPages(file_id, pages);
 }
 
 bool IndexManager::deleteIndex(const char* file_path,
@@ -675,289 +796,204 @@ bool IndexManager::deleteIndex(const char* file_path,
     // check validity
     if (index_value.key.size() != (size_t)index_key_num) return false;
 
-    return deleteNode(file_id, root_page_id, BPlusTreeLeafChild(index_value),
-                      exact_match, index_key_num, m);
+    return deleteNode(file_id, root_page_id, index_value, exact_match,
+                      index_key_num, m);
 }
 
-bool IndexManager::deleteNode(int file_id, int page_id,
-                              const BPlusTreeLeafChild& delete_value,
-                              bool exact_match, int index_key_num,
-                              int b_plus_tree_m) {
+void IndexManager::removeChild(int file_id, int page_id, int pos,
+                               int index_key_num, int b_plus_tree_m) {
     BufType b;
     int index;
     b = bpm->getPage(file_id, page_id, index);
     bool is_leaf = b[3];
-
-    if (is_leaf) {
-        // 如果是叶节点
-
-        // 读取节点
-        BPlusTreeLeafNode node;
-        readBPlusTreeLeafNodeFromPage(b, node, index_key_num);
+    int child_length = childLength(is_leaf, index_key_num);
+    int key_offset = child_length - index_key_num;
+    int prev_page_id = b[0];
+    int next_page_id = b[1];
+    int children_num = b[2] - 1;  // 删除之后的子节点数
+    bool update_max_val = pos == children_num;
+    tmp_tree_underflow = false;
+    bool removed = false;
+
+    if (next_page_id != -1 && children_num < (b_plus_tree_m + 1) / 2) {
+        // 出现下溢, 先取出剩下的子节点
+        unsigned int children[BUF_PER_PAGE];
+        memcpy(children, childAt(b, 0, child_length),
+               pos * child_length * BYTE_PER_BUF);
+        memcpy(children + pos * child_length, childAt(b, pos + 1, child_length),
+               (children_num - pos) * child_length * BYTE_PER_BUF);
         bpm->access(index);
 
-        bool found = false;
-        bool update_max_val = false;
-        for (auto itr = node.children.begin(); itr != node.children.end();
-             itr++) {
-            if (delete_value == *itr) {
-                if (exact_match && !delete_value.exact_match(*itr)) {
-                    bool found_exact = false;
-                    for (auto exact_itr = itr; exact_itr != node.children.end();
-                         exact_itr++) {
-                        if (delete_value.exact_match(*exact_itr)) {
-                            (*exact_itr).slot_id = (*itr).slot_id;
-                            (*exact_itr).page_id = (*itr).page_id;
-                            found_exact = true;
-                            break;
-                        }
-                    }
-                    if (!found_exact) {
-                        BPlusTreeLeafNode exact_node = node;
-                        int exact_page_id = page_id, child_item_slot_id = 0;
-                        std::list<BPlusTreeLeafChild>::iterator exact_itr;
-                        while (!found_exact) {
-                            if (exact_node.next_page_id == -1) {
-                                break;
-                            }
-                            exact_page_id = exact_node.next_page_id;
-                            b = bpm->getPage(file_id, exact_node.next_page_id,
-                                             index);
-                            readBPlusTreeLeafNodeFromPage(b, exact_node,
-                                                          index_key_num);
-                            bpm->access(index);
-                            bool failed = false;
-                            child_item_slot_id = 0;
-                            for (exact_itr = exact_node.children.begin();
-                                 exact_itr != exact_node.children.end();
-                                 exact_itr++, child_item_slot_id++) {
-                                if (delete_value.exact_match(*exact_itr)) {
-                                    found_exact = true;
-                                    break;
-                                } else if (delete_value < *exact_itr) {
-                                    failed = true;
-                                    break;
-                                }
-                            }
-                            if (found_exact) break;
-                            if (failed) break;
-                        }
-                        if (!found_exact) {
-                            // 没找到
-                            return false;
-                        }
-
-                        // 写回
-                        setLeafChildSlotIDAndPageID(
-                            file_id, exact_page_id, child_item_slot_id,
-                            itr->page_id, itr->slot_id, index_key_num);
-                    }
-                }
-                // 删掉找到的位置
-                found = true;
-                update_max_val = (std::next(itr) == node.children.end());
-                node.children.erase(itr);
-                break;
-            } else if (delete_value < *itr) {
-                break;
-            }
-        }
-        if (!found) {
-            // 没找到
-            return false;
-        }
-        tmp_tree_underflow = false;
-        if (node.next_page_id != -1 &&
-            (int)node.children.size() < (b_plus_tree_m + 1) / 2) {
-            // 出现下溢
-            b = bpm->getPage(file_id, node.next_page_id, index);
-            BPlusTreeLeafNode next_node;
-            readBPlusTreeLeafNodeFromPage(b, next_node, index_key_num);
-            bpm->access(index);
-
-            if ((int)next_node.children.size() + (int)node.children.size() <=
-                b_plus_tree_m) {
-                // 合并节点
-                tmp_tree_underflow = true;
-                update_max_val = false;
-                next_node.children.splice(next_node.children.begin(),
-                                          node.children);
-
-                // 修改链表
-                next_node.prev_page_id = node.prev_page_id;
-                if (next_node.prev_page_id != -1) {
-                    setNextPageID(file_id, next_node.prev_page_id,
-                                  node.next_page_id);
-                }
-
-                // next node 写回
-                b = bpm->getPage(file_id, node.next_page_id, index);
-                writeBPlusTreeLeafNode2Page(b, next_node, index_key_num);
-                bpm->markDirty(index);
-
-                // 删除节点
-                setBitMapPage(file_id, 1, page_id, false);
-            } else {
-                // 借一个节点
-                node.children.push_back(next_node.children.front());
-                next_node.children.pop_front();
-                update_max_val = true;
-
-                // next node 写回
-                b = bpm->getPage(file_id, node.next_page_id, index);
-                writeBPlusTreeLeafNode2Page(b, next_node, index_key_num);
-                bpm->markDirty(index);
-            }
-        }
-
-        if (node.next_page_id == -1 && node.children.size() == 0 &&
-            node.prev_page_id != -1) {
+        b = bpm->getPage(file_id, next_page_id, index);
+        int next_children_num = b[2];
+        if (next_children_num + children_num <= b_plus_tree_m) {
+            // 合并节点, 剩下的子节点放到下一个节点的最前面
             tmp_tree_underflow = true;
             update_max_val = false;
+            memmove(childAt(b, children_num, child_length),
+                    childAt(b, 0, child_length),
+                    next_children_num * child_length * BYTE_PER_BUF);
+            memcpy(childAt(b, 0, child_length), children,
+                   children_num * child_length * BYTE_PER_BUF);
+            b[2] = next_children_num + children_num;
+
+            // 修改链表
+            b[0] = prev_page_id;
+            bpm->markDirty(index);
+            if (prev_page_id != -1) {
+                setNextPageID(file_id, prev_page_id, next_page_id);
+            }
 
-            setNextPageID(file_id, node.prev_page_id, -1);
-
+            // 删除节点
             setBitMapPage(file_id, 1, page_id, false);
-        }
-        if (update_max_val) {
-            // 更新max值
-            if (node.children.size() == 0) {
-                tmp_tree_internal_child[0].max_key.clear();
-                for (int i = 0; i < index_key_num; i++)
-                    tmp_tree_internal_child[0].max_key.push_back(INT_MIN);
-            } else {
-                tmp_tree_internal_child[0].max_key = node.children.back().key;
-            }
-            tmp_tree_internal_child[0].page_id = page_id;
         } else {
-            tmp_tree_internal_child[0].page_id = -1;
-        }
+            // 借一个节点
+            memcpy(children + children_num * child_length,
+                   childAt(b, 0, child_length), child_length * BYTE_PER_BUF);
+            eraseChild(b, 0, child_length);
+            bpm->markDirty(index);
+            update_max_val = true;
 
-        // 写回
-        if (!tmp_tree_underflow) {
-            // underflow的情况不用写回
             b = bpm->getPage(file_id, page_id, index);
-            writeBPlusTreeLeafNode2Page(b, node, index_key_num);
+            memcpy(childAt(b, 0, child_length), children,
+                   (children_num + 1) * child_length * BYTE_PER_BUF);
             bpm->markDirty(index);
+            children_num++;
+            removed = true;
         }
+    }
 
-        return true;
-    } else {
-        // 不是叶节点
+    if (next_page_id == -1 && children_num == 0 && prev_page_id != -1) {
+        // 最后一个节点被删空
+        tmp_tree_underflow = true;
+        update_max_val = false;
 
-        // 读取节点
-        BPlusTreeInternalNode node;
-        readBPlusTreeInternalNodeFromPage(b, node, index_key_num);
-        bpm->access(index);
+        setNextPageID(file_id, prev_page_id, -1);
 
-        // 搜索
-        for (auto itr = node.children.begin(); itr != node.children.end();
-             itr++) {
-            if (delete_value <= *itr) {
-                if (!deleteNode(file_id, (*itr).page_id, delete_value,
-                                exact_match, index_key_num, b_plus_tree_m)) {
-                    // 没找到
-                    return false;
-                }
-                if (tmp_tree_underflow) {
-                    // 子节点踢出去
-                    tmp_tree_underflow = false;
-                    bool update_max_val =
-                        (std::next(itr) == node.children.end());
-                    node.children.erase(itr);
-                    if ((int)node.children.size() < (b_plus_tree_m + 1) / 2 &&
-                        node.next_page_id != -1) {
-                        // 出现下溢
-                        b = bpm->getPage(file_id, node.next_page_id, index);
-                        BPlusTreeInternalNode next_node;
-                        readBPlusTreeInternalNodeFromPage(b, next_node,
-                                                          index_key_num);
-                        bpm->access(index);
-
-                        if ((int)next_node.children.size() +
-                                (int)node.children.size() <=
-                            b_plus_tree_m) {
-                            // 合并节点
-                            tmp_tree_underflow = true;
-                            update_max_val = false;
-                            next_node.children.splice(
-                                next_node.children.begin(), node.children);
-
-                            // 修改链表
-                            next_node.prev_page_id = node.prev_page_id;
-                            if (next_node.prev_page_id != -1) {
-                                setNextPageID(file_id, next_node.prev_page_id,
-                                              node.next_page_id);
-                            }
-
-                            // next node 写回
-                            b = bpm->getPage(file_id, node.next_page_id, index);
-                            writeBPlusTreeInternalNode2Page(b, next_node,
-                                                            index_key_num);
-                            bpm->markDirty(index);
-
-                            // 删除节点
-                            setBitMapPage(file_id, 1, page_id, false);
-                        } else {
-                            node.children.push_back(next_node.children.front());
-                            next_node.children.pop_front();
-                            update_max_val = true;
-
-                            // next node 写回
-                            b = bpm->getPage(file_id, node.next_page_id, index);
-                            writeBPlusTreeInternalNode2Page(b, next_node,
-                                                            index_key_num);
-                            bpm->markDirty(index);
-                        }
-                    }
-                    if (node.next_page_id == -1 && node.children.size() == 0 &&
-                        node.prev_page_id != -1) {
-                        tmp_tree_underflow = true;
-                        update_max_val = false;
+        setBitMapPage(file_id, 1, page_id, false);
+    }
 
-                        setNextPageID(file_id, node.prev_page_id, -1);
+    // 写回, underflow的情况不用写回
+    if (!tmp_tree_underflow && !removed) {
+        b = bpm->getPage(file_id, page_id, index);
+        eraseChild(b, pos, child_length);
+        bpm->markDirty(index);
+    }
 
-                        setBitMapPage(file_id, 1, page_id, false);
-                    }
-                    if (update_max_val) {
-                        // 更新max值
-                        tmp_tree_internal_child[0].max_key =
-                            node.children.back().max_key;
-                        tmp_tree_internal_child[0].page_id = page_id;
-                    } else {
-                        tmp_tree_internal_child[0].page_id = -1;
-                    }
+    if (update_max_val) {
+        // 更新max值, 没有子节点时为最小的键
+        tmp_tree_internal_child[0].page_id = page_id;
+        if (children_num == 0) {
+            tmp_tree_internal_child[0].max_key.assign(index_key_num, INT_MIN);
+        } else {
+            b = bpm->getPage(file_id, page_id, index);
+            setMaxKey(tmp_tree_internal_child[0],
+                      childAt(b, children_num - 1, child_length) + key_offset,
+                      index_key_num);
+            bpm->access(index);
+        }
+    } else {
+        tmp_tree_internal_child[0].page_id = -1;
+    }
+}
 
-                    if (!tmp_tree_underflow) {
-                        // 写回
-                        b = bpm->getPage(file_id, page_id, index);
-                        writeBPlusTreeInternalNode2Page(b, node, index_key_num);
-                        bpm->markDirty(index);
+bool IndexManager::deleteNode(int file_id, int page_id,
+                              const IndexValue& delete_value,
+                              bool exact_match, int index_key_num,
+                              int b_plus_tree_m) {
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, page_id, index);
+    bool is_leaf = b[3];
+    int children_num = b[2];
+    const int* key = delete_value.key.data();
+    int pos = lowerBound(b, key, index_key_num);
+
+    if (is_leaf) {
+        // 如果是叶节点, 第一个键相同的子节点
+        int child_length = index_key_num + 2;
+        BufType child = childAt(b, pos, child_length);
+        if (pos == children_num ||
+            compareKey(child + 2, key, index_key_num) != 0) {
+            // 没找到
+            bpm->access(index);
+            return false;
+        }
+        int item_page_id = child[0], item_slot_id = child[1];
+        if (exact_match && !(item_page_id == delete_value.page_id &&
+                             item_slot_id == delete_value.slot_id)) {
+            // 找到位置也相同的项, 把pos的位置写到那里, 再删除pos
+            int exact_page_id = page_id, exact_child_id = pos + 1;
+            bool found_exact = false, failed = false;
+            while (!found_exact && !failed) {
+                for (; exact_child_id < children_num; exact_child_id++) {
+                    child = childAt(b, exact_child_id, child_length);
+                    if (compareKey(child + 2, key, index_key_num) != 0) {
+                        failed = true;
+                        break;
                     }
-                } else if (tmp_tree_internal_child[0].page_id != -1) {
-                    // 更新max值
-                    (*itr).max_key = tmp_tree_internal_child[0].max_key;
-                    if (std::next(itr) == node.children.end()) {
-                        // 更新max值
-                        tmp_tree_internal_child[0].max_key =
-                            node.children.back().max_key;
-                        tmp_tree_internal_child[0].page_id = page_id;
-                    } else {
-                        tmp_tree_internal_child[0].page_id = -1;
+                    if ((int)child[0] == delete_value.page_id &&
+                        (int)child[1] == delete_value.slot_id) {
+                        found_exact = true;
+                        break;
                     }
-
-                    // 写回
-                    b = bpm->getPage(file_id, page_id, index);
-                    writeBPlusTreeInternalNode2Page(b, node, index_key_num);
-                    bpm->markDirty(index);
                 }
-                return true;
+                int next_page_id = b[1];
+                bpm->access(index);
+                if (found_exact || failed || next_page_id == -1) break;
+                exact_page_id = next_page_id;
+                exact_child_id = 0;
+                b = bpm->getPage(file_id, exact_page_id, index);
+                children_num = b[2];
             }
+            if (!found_exact) {
+                // 没找到
+                return false;
+            }
+
+            // 写回
+            setLeafChildSlotIDAndPageID(file_id, exact_page_id, exact_child_id,
+                                        item_page_id, item_slot_id,
+                                        index_key_num);
+        } else {
+            bpm->access(index);
         }
+        // 删掉找到的位置
+        removeChild(file_id, page_id, pos, index_key_num, b_plus_tree_m);
+        return true;
+    }
 
+    // 不是叶节点
+    int child_length = index_key_num + 1;
+    if (pos == children_num) {
+        // 没找到
+        bpm->access(index);
+        return false;
+    }
+    bpm->access(index);
+    if (!deleteNode(file_id, childAt(b, pos, child_length)[0], delete_value,
+                    exact_match, index_key_num, b_plus_tree_m)) {
         // 没找到
         return false;
     }
+    if (tmp_tree_underflow) {
+        // 子节点踢出去
+        removeChild(file_id, page_id, pos, index_key_num, b_plus_tree_m);
+    } else if (tmp_tree_internal_child[0].page_id != -1) {
+        // 更新max值
+        b = bpm->getPage(file_id, page_id, index);
+        memcpy(childAt(b, pos, child_length) + 1,
+               tmp_tree_internal_child[0].max_key.data(),
+               index_key_num * BYTE_PER_BUF);
+        bpm->markDirty(index);
+        if (pos == children_num - 1) {
+            // 最后一个子节点的max就是当前节点的max
+            tmp_tree_internal_child[0].page_id = page_id;
+        } else {
+            tmp_tree_internal_child[0].page_id = -1;
+        }
+    }
+    return true;
 }
 
 bool IndexManager::deleteIndexFile(const char* file_path) {
@@ -1,5 +1,11 @@
 #include "index/IndexType.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "record/FilterKernels.hpp"
+
 namespace dbs {
 namespace index {
 
@@ -22,46 +28,6 @@ BPlusTreeInternalChild::BPlusTreeInternalChild(int page_id_,
     max_key = max_key_;
 }
 
-BPlusTreeInternalNode::BPlusTreeInternalNode(int prev_page_id_,
-                                             int next_page_id_) {
-    prev_page_id = prev_page_id_;
-    next_page_id = next_page_id_;
-    children.clear();
-}
-
-BPlusTreeInternalNode::BPlusTreeInternalNode() {
-    prev_page_id = -1;
-    next_page_id = -1;
-    children.clear();
-}
-
-BPlusTreeLeafChild::BPlusTreeLeafChild(int page_id_, int slot_id_,
-                                       int index_key_num_) {
-    page_id = page_id_;
-    slot_id = slot_id_;
-    for (int i = 0; i < index_key_num_; i++) {
-        key.push_back(INT_MIN);
-    }
-}
-
-BPlusTreeLeafChild::BPlusTreeLeafChild(IndexValue index_value) {
-    page_id = index_value.page_id;
-    slot_id = index_value.slot_id;
-    key = index_value.key;
-}
-
-BPlusTreeLeafNode::BPlusTreeLeafNode() {
-    prev_page_id = -1;
-    next_page_id = -1;
-    children.clear();
-}
-
-BPlusTreeLeafNode::BPlusTreeLeafNode(int prev_page_id_, int next_page_id_) {
-    prev_page_id = prev_page_id_;
-    next_page_id = next_page_id_;
-    children.clear();
-}
-
 IndexValue::IndexValue() {
     page_id = -1;
     slot_id = -1;
@@ -94,5 +60,88 @@ void indexValueToRecordLocation(
     }
 }
 
+namespace {
+
+// 按无符号数比较的 32 位整数, 翻转最高位后按 int 比较的大小关系不变
+int signedOrder(unsigned int value) { return (int)(value ^ 0x80000000u); }
+
+// 有符号 64 位整数拆成两个 int, 高位在前
+void appendLongLong(long long value, std::vector<int>& key) {
+    key.push_back((int)(value >> 32));
+    key.push_back(signedOrder((unsigned int)value));
+}
+
+}  // namespace
+
+int getIndexKeyLength(record::DataTypeName type_name) {
+    switch (type_name) {
+        case record::DataTypeName::FLOAT:
+        case record::DataTypeName::DATE:
+            return 2;
+        case record::DataTypeName::VARCHAR:
+            return INDEX_VARCHAR_PREFIX_BYTE_LEN / BYTE_PER_BUF;
+        default:
+            return 1;
+    }
+}
+
+void appendIndexKey(const record::DataValue& value, std::vector<int>& key) {
+    if (value.is_null) {
+        appendIndexKeyBound(value.type_name, false, key);
+        return;
+    }
+    switch (value.type_name) {
+        case record::DataTypeName::FLOAT: {
+            // IEEE 754: 正数翻转符号位, 负数翻转所有位, 之后按无符号数比较
+            // -0 与 0 相等, NaN 统一为正的 NaN
+            double float_value = value.value.float_value;
+            if (float_value == 0) float_value = 0;
+            if (std::isnan(float_value)) float_value = std::nan("");
+            unsigned long long bits;
+            memcpy(&bits, &float_value, sizeof(bits));
+            bits = (bits >> 63) ? ~bits : bits | (1ULL << 63);
+            key.push_back(signedOrder(bits >> 32));
+            key.push_back(signedOrder((unsigned int)bits));
+            break;
+        }
+        case record::DataTypeName::DATE: {
+            auto& date = value.value.date_value;
+            appendLongLong(
+                record::dateOrderKey(date.year, date.month, date.day), key);
+            break;
+        }
+        case record::DataTypeName::VARCHAR: {
+            // 前缀按字节大端存入, 不足的补 0
+            std::string_view char_value = value.value.char_value;
+            for (int i = 0; i < INDEX_VARCHAR_PREFIX_BYTE_LEN;
+                 i += BYTE_PER_BUF) {
+                unsigned int word = 0;
+                for (int j = i; j < i + BYTE_PER_BUF; j++) {
+                    unsigned char byte = 0;
+                    if ((size_t)j < char_value.size()) byte = char_value[j];
+                    word = (word << 8) | byte;
+                }
+                key.push_back(signedOrder(word));
+            }
+            break;
+        }
+        default:
+            key.push_back(value.value.int_value);
+            break;
+    }
+}
+
+void appendIndexKeyBound(record::DataTypeName type_name, bool high,
+                         std::vector<int>& key) {
+    key.insert(key.end(), getIndexKeyLength(type_name),
+               high ? INT_MAX : INT_MIN);
+}
+
+void sortIndexValues(std::vector<IndexValue>& index_values) {
+    // 插入时放在相同的键之前, 后插入的在前面
+    std::reverse(index_values.begin(), index_values.end());
+    std::stable_sort(index_values.begin(), index_values.end());
+}
+
 }  // namespace index
 }  // namespace dbs
\ No newline at end of file
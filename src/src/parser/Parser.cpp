@@ -24,7 +24,7 @@ bool Parser::parse(std::string sSQL) {
     }
 
     // setup visitor
-    SQLMyVisitor iVisitor{SQLMyVisitor(rm, im, sm, output_mode)};
+    SQLMyVisitor iVisitor{SQLMyVisitor(rm, im, sm, output_mode, read_only)};
     auto res = iVisitor.visit(iTree);
     return std::any_cast<bool>(res);
 }
@@ -38,6 +38,8 @@ Parser::Parser(record::RecordManager* rm_, index::IndexManager* im_,
 
 void Parser::setOutputMode(bool mode) { output_mode = mode; }
 
+void Parser::setReadOnly(bool read_only_) { read_only = read_only_; }
+
 Parser::~Parser() {
     rm = nullptr;
     im = nullptr;
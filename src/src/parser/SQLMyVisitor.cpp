@@ -201,11 +201,13 @@ void ParseResult::print(bool output_mode, int duration) {
 }
 
 SQLMyVisitor::SQLMyVisitor(record::RecordManager* rm_, index::IndexManager* im_,
-                           system::SystemManager* sm_, bool output_mode_) {
+                           system::SystemManager* sm_, bool output_mode_,
+                           bool read_only_) {
     rm = rm_;
     im = im_;
     sm = sm_;
     output_mode = output_mode_;
+    read_only = read_only_;
 }
 
 SQLMyVisitor::~SQLMyVisitor() {
@@ -244,6 +246,29 @@ std::any SQLMyVisitor::aggregateResult(std::any result, std::any nextResult) {
 
 std::any SQLMyVisitor::visitStatement(
     antlr4::SQLParser::StatementContext* ctx) {
+    if (read_only) {
+        // 只允许查询, USE, SHOW 和 DESC
+        bool modify = ctx->alter_statement() != nullptr;
+        auto db_statement = ctx->db_statement();
+        if (db_statement != nullptr &&
+            (dynamic_cast<antlr4::SQLParser::Create_dbContext*>(
+                 db_statement) != nullptr ||
+             dynamic_cast<antlr4::SQLParser::Drop_dbContext*>(db_statement) !=
+                 nullptr))
+            modify = true;
+        auto table_statement = ctx->table_statement();
+        if (table_statement != nullptr &&
+            dynamic_cast<antlr4::SQLParser::Select_table_Context*>(
+                table_statement) == nullptr &&
+            dynamic_cast<antlr4::SQLParser::Describe_tableContext*>(
+                table_statement) == nullptr)
+            modify = true;
+        if (modify) {
+            std::cout << "!ERROR" << std::endl;
+            std::cout << "read-only mode" << std::endl;
+            return false;
+        }
+    }
     return visitChildren(ctx);
 }
 
@@ -629,9 +654,34 @@ std::any SQLMyVisitor::visitSelect_table(
         }
         sm->fillInDataTypeField(constraints, table_id);
 
+        // 不排序时扫描只需要读出输出的列
+        std::vector<int> output_column_ids;
+        bool project = order_by_column_name == "";
+        if (project) {
+            sm->getTableColumnTypes(table_id, column_types);
+            for (auto& column_tuple : column_names) {
+                if (std::get<1>(column_tuple) == "*") {
+                    project = false;
+                    break;
+                }
+                for (auto& column_type : column_types) {
+                    if (column_type.column_name == std::get<1>(column_tuple)) {
+                        output_column_ids.push_back(column_type.column_id);
+                        break;
+                    }
+                }
+            }
+        }
+
+        // 不排序时只需要找出 offset + limit 条记录
+        int search_limit = -1;
+        if (order_by_column_name == "" && limit_num != -1)
+            search_limit = limit_num + std::max(offset_num, 0);
         std::vector<record::RecordLocation> record_locations;
         if (!sm->search(table_id, constraints, result_datas, column_types,
-                        record_locations, -1)) {
+                        record_locations, -1,
+                        project ? &output_column_ids : nullptr,
+                        search_limit)) {
             return false;
         }
 
@@ -808,7 +858,7 @@ std::any SQLMyVisitor::visitSelect_table(
                                 [std::make_pair(select_table_id,
                                                 data_item.column_ids[i])];
                     }
-                    result_datas.push_back(data_item);
+                    result_datas.push_back(std::move(data_item));
                 }
                 low_page += BLOCK_PAGE_NUM;
                 high_page =
@@ -1034,7 +1084,18 @@ std::any SQLMyVisitor::visitSelect_table(
                                 }
                                 if (flag) {
                                     // merge two data
-                                    record::DataItem new_data = result_data;
+                                    // 一次分配好合并后的空间
+                                    record::DataItem new_data;
+                                    new_data.data_id = result_data.data_id;
+                                    new_data.data_values.reserve(
+                                        result_data.data_values.size() +
+                                        select_result_data.data_values.size());
+                                    new_data.column_ids.reserve(
+                                        new_data.data_values.capacity());
+                                    new_data.data_values =
+                                        result_data.data_values;
+                                    new_data.column_ids =
+                                        result_data.column_ids;
                                     for (int j = 0;
                                          j <
                                          select_result_data.data_values.size();
@@ -1048,7 +1109,8 @@ std::any SQLMyVisitor::visitSelect_table(
                                                     select_result_data
                                                         .column_ids[j])]);
                                     }
-                                    new_result_datas.push_back(new_data);
+                                    new_result_datas.push_back(
+                                        std::move(new_data));
                                 }
                             }
                         }
@@ -0,0 +1,210 @@
+#include "record/CsvReader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <thread>
+
+#include "common/Config.hpp"
+
+namespace dbs {
+namespace record {
+
+namespace {
+
+/**
+ * @brief 与 std::stoi 一样跳过前导空白和 '+', 只解析开头的数字
+ */
+template <typename T>
+bool parseNumber(std::string_view field, T& value) {
+    const char* first = field.data();
+    const char* last = field.data() + field.size();
+    while (first < last && std::isspace((unsigned char)*first)) first++;
+    if (last - first > 1 && *first == '+' && first[1] != '-') first++;
+    return std::from_chars(first, last, value).ec == std::errc();
+}
+
+}  // namespace
+
+CsvReader::CsvReader(const std::vector<ColumnType>& column_types_,
+                     char delimeter_)
+    : column_types(column_types_),
+      delimeter(delimeter_),
+      fd(-1),
+      data(nullptr),
+      length(0) {}
+
+CsvReader::~CsvReader() {
+    if (data != nullptr) munmap((void*)data, length);
+    if (fd != -1) close(fd);
+}
+
+bool CsvReader::open(const char* csv_path) {
+    fd = ::open(csv_path, O_RDONLY);
+    if (fd == -1) return false;
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) == -1) return false;
+    length = file_stat.st_size;
+    // 空文件不能映射, 当作没有行
+    if (length == 0) return true;
+    void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+        length = 0;
+        return false;
+    }
+    // 按顺序读一遍, 让内核提前读入
+    madvise(p, length, MADV_SEQUENTIAL);
+    data = (const char*)p;
+    return true;
+}
+
+bool CsvReader::parseLine(std::string_view line, DataItem& data_item) const {
+    int column_num = column_types.size();
+    if ((int)data_item.column_ids.size() != column_num) {
+        data_item.column_ids.clear();
+        for (auto& column : column_types)
+            data_item.column_ids.push_back(column.column_id);
+    }
+    data_item.data_values.resize(column_num);
+    size_t field_begin = 0;
+    for (int i = 0; i < column_num; i++) {
+        // 最后一个字段到行尾为止, 其余字段之后必须有分隔符
+        size_t field_end = line.find(delimeter, field_begin);
+        if (i == column_num - 1) {
+            if (field_end != std::string_view::npos) return false;
+            field_end = line.size();
+        } else if (field_end == std::string_view::npos) {
+            return false;
+        }
+        auto field = line.substr(field_begin, field_end - field_begin);
+        field_begin = field_end + 1;
+
+        auto& data_value = data_item.data_values[i];
+        switch (column_types[i].type_name) {
+            case DataTypeName::INT: {
+                int value;
+                if (!parseNumber(field, value)) return false;
+                data_value = DataValue(DataTypeName::INT, false, value);
+                break;
+            }
+            case DataTypeName::FLOAT: {
+                // 与 istream 相同, 无法解析时为 0
+                double value = 0;
+                if (!parseNumber(field, value)) value = 0;
+                data_value = DataValue(DataTypeName::FLOAT, false, value);
+                break;
+            }
+            case DataTypeName::VARCHAR:
+                data_value = DataValue(DataTypeName::VARCHAR, false, field);
+                break;
+            case DataTypeName::DATE: {
+                // year-month-day, 以第一个和最后一个 '-' 分开
+                size_t first = field.find('-');
+                size_t last = field.rfind('-');
+                if (first == std::string_view::npos || first == last)
+                    return false;
+                DateValue date_value;
+                if (!parseNumber(field.substr(0, first), date_value.year) ||
+                    !parseNumber(field.substr(first + 1, last - first - 1),
+                                 date_value.month) ||
+                    !parseNumber(field.substr(last + 1), date_value.day))
+                    return false;
+                data_value = DataValue(DataTypeName::DATE, false, date_value);
+                break;
+            }
+            default:
+                // 表的列不会是其他类型
+                return false;
+        }
+    }
+    return true;
+}
+
+void CsvReader::parseChunk(Chunk& chunk) const {
+    chunk.row_num = 0;
+    chunk.error = false;
+    const char* line = chunk.begin;
+    while (line < chunk.end) {
+        auto newline = (const char*)memchr(line, '\n', chunk.end - line);
+        const char* line_end = newline != nullptr ? newline : chunk.end;
+        if (chunk.row_num == (int)chunk.data_items.size())
+            chunk.data_items.emplace_back();
+        if (!parseLine(std::string_view(line, line_end - line),
+                       chunk.data_items[chunk.row_num])) {
+            chunk.error = true;
+            return;
+        }
+        chunk.row_num++;
+        line = newline != nullptr ? newline + 1 : chunk.end;
+    }
+}
+
+int CsvReader::read(
+    const std::function<void(const DataItem& data_item)>& consume) {
+    int thread_num = std::clamp((int)std::thread::hardware_concurrency(), 1,
+                                CSV_MAX_THREADS);
+    const char* position = data;
+    const char* data_end = data + length;
+    // 切出一批块并开始解析, 每块从行首开始, 到某一行的换行符之后结束
+    auto start = [&](std::vector<Chunk>& batch,
+                     std::vector<std::thread>& threads) {
+        for (auto& chunk : batch) {
+            chunk.begin = position;
+            chunk.end = position + std::min<size_t>(CSV_CHUNK_SIZE,
+                                                    data_end - position);
+            if (chunk.end < data_end) {
+                auto newline = (const char*)memchr(chunk.end, '\n',
+                                                   data_end - chunk.end);
+                chunk.end = newline != nullptr ? newline + 1 : data_end;
+            }
+            position = chunk.end;
+            if (chunk.begin == chunk.end) {
+                chunk.row_num = 0;
+                chunk.error = false;
+            } else if (length <= CSV_CHUNK_SIZE) {
+                // 小文件不值得开线程
+                parseChunk(chunk);
+            } else {
+                threads.emplace_back(&CsvReader::parseChunk, this,
+                                     std::ref(chunk));
+            }
+        }
+    };
+    auto join = [](std::vector<std::thread>& threads) {
+        for (auto& thread : threads) thread.join();
+        threads.clear();
+    };
+
+    std::vector<Chunk> current(thread_num), next(thread_num);
+    std::vector<std::thread> current_threads, next_threads;
+    start(current, current_threads);
+    int row_num = 0;
+    while (true) {
+        join(current_threads);
+        // 处理这一批时下一批已在解析, 块的地址在 swap 后不变
+        bool more = position < data_end;
+        if (more) start(next, next_threads);
+        for (auto& chunk : current) {
+            for (int i = 0; i < chunk.row_num; i++)
+                consume(chunk.data_items[i]);
+            row_num += chunk.row_num;
+            if (chunk.error) {
+                join(next_threads);
+                return -1;
+            }
+        }
+        if (!more) break;
+        std::swap(current, next);
+        std::swap(current_threads, next_threads);
+    }
+    return row_num;
+}
+
+}  // namespace record
+}  // namespace dbs
@@ -96,7 +96,7 @@ DataValue::DataValue(DataTypeName type_name_, bool is_null_,
 }
 
 DataValue::DataValue(DataTypeName type_name_, bool is_null_,
-                     const std::string& char_value_) {
+                     std::string_view char_value_) {
     is_null = is_null_;
     type_name = type_name_;
     value.char_value = char_value_;
@@ -163,7 +163,7 @@ std::string DataValue::toString() const {
                        << value.float_value;
                 return stream.str();
             case DataTypeName::VARCHAR:
-                return value.char_value;
+                return value.char_value.str();
             case DataTypeName::DATE:
                 return std::to_string(value.date_value.year) + "-" +
                        std::to_string(value.date_value.month) + "-" +
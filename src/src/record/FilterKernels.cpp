@@ -0,0 +1,264 @@
+#include "record/FilterKernels.hpp"
+
+#include <algorithm>
+
+#include "utils/BitOperations.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DBS_FILTER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace dbs {
+namespace record {
+
+namespace {
+
+// 与 RecordFilter::compare 相同, 对 8 个槽的位一起计算
+unsigned int compareBits(system::ConstraintType constraint_type,
+                         unsigned int less, unsigned int equal) {
+    switch (constraint_type) {
+        case system::ConstraintType::EQ:
+            return equal;
+        case system::ConstraintType::NEQ:
+            return ~equal & 0xff;
+        case system::ConstraintType::GT:
+            return ~(less | equal) & 0xff;
+        case system::ConstraintType::GEQ:
+            return ~less & 0xff;
+        case system::ConstraintType::LT:
+            return less;
+        case system::ConstraintType::LEQ:
+            return less | equal;
+    }
+    return 0xff;
+}
+
+bool compareOne(system::ConstraintType constraint_type, bool less,
+                bool equal) {
+    return compareBits(constraint_type, less, equal) & 1;
+}
+
+bool selected(const unsigned int* selection, int slot) {
+    return (selection[slot >> LOG_BIT_PER_BUF] >> (slot & BIT_PER_BUF_MASK)) &
+           1;
+}
+
+void unselect(unsigned int* selection, int slot) {
+    selection[slot >> LOG_BIT_PER_BUF] &= ~(1U << (slot & BIT_PER_BUF_MASK));
+}
+
+long long dateKey(unsigned int b) {
+    return dateOrderKey(utils::get2Bytes(b, 0), utils::get1Byte(b, 2),
+                        utils::get1Byte(b, 3));
+}
+
+/**
+ * @brief 从第 begin 个槽开始逐个检查, null 只满足 NEQ
+ */
+template <typename Compare>
+void filterSlots(const ColumnStripe& stripe,
+                 system::ConstraintType constraint_type, int begin,
+                 int slot_num, unsigned int* selection, Compare compare) {
+    bool null_valid = constraint_type == system::ConstraintType::NEQ;
+    for (int slot = begin; slot < slot_num; slot++) {
+        if (!selected(selection, slot)) continue;
+        bool valid =
+            (stripe.null_word[slot * stripe.null_stride] & stripe.null_mask)
+                ? null_valid
+                : compare(stripe.column + slot * stripe.stride);
+        if (!valid) unselect(selection, slot);
+    }
+}
+
+#ifdef DBS_FILTER_AVX2
+
+bool supportAvx2() {
+    static const bool support = __builtin_cpu_supports("avx2");
+    return support;
+}
+
+// selection 中从 slot 开始的 8 位, slot 是 8 的倍数
+unsigned int groupBits(const unsigned int* selection, int slot) {
+    return (selection[slot >> LOG_BIT_PER_BUF] >> (slot & BIT_PER_BUF_MASK)) &
+           0xff;
+}
+
+void unselectGroup(unsigned int* selection, int slot, unsigned int bits) {
+    selection[slot >> LOG_BIT_PER_BUF] &= ~(bits << (slot & BIT_PER_BUF_MASK));
+}
+
+__attribute__((target("avx2"))) inline __m256i slotOffsets(int stride) {
+    return _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7),
+                              _mm256_set1_epi32(stride));
+}
+
+// 从 slot 开始的 8 个槽中, 该列为 null 的槽
+__attribute__((target("avx2"))) inline unsigned int nullBits(
+    const ColumnStripe& stripe, int slot, __m256i null_offsets) {
+    __m256i words = _mm256_i32gather_epi32(
+        (const int*)(stripe.null_word + slot * stripe.null_stride),
+        null_offsets, 4);
+    __m256i mask = _mm256_set1_epi32(stripe.null_mask);
+    __m256i is_null = _mm256_cmpeq_epi32(_mm256_and_si256(words, mask), mask);
+    return _mm256_movemask_ps(_mm256_castsi256_ps(is_null));
+}
+
+// 以下函数返回已处理的槽数 (8 的倍数), 剩下的槽逐个检查
+
+__attribute__((target("avx2"))) int filterNullAvx2(const ColumnStripe& stripe,
+                                                    bool is_null, int slot_num,
+                                                    unsigned int* selection) {
+    __m256i null_offsets = slotOffsets(stripe.null_stride);
+    int slot = 0;
+    for (; slot + 8 <= slot_num; slot += 8) {
+        unsigned int group = groupBits(selection, slot);
+        if (group == 0) continue;
+        unsigned int null_bits = nullBits(stripe, slot, null_offsets);
+        unsigned int valid = is_null ? null_bits : ~null_bits;
+        unselectGroup(selection, slot, group & ~valid);
+    }
+    return slot;
+}
+
+__attribute__((target("avx2"))) int filterIntAvx2(
+    const ColumnStripe& stripe, system::ConstraintType constraint_type,
+    int value, int slot_num, unsigned int* selection) {
+    __m256i offsets = slotOffsets(stripe.stride);
+    __m256i null_offsets = slotOffsets(stripe.null_stride);
+    __m256i target = _mm256_set1_epi32(value);
+    unsigned int null_valid =
+        constraint_type == system::ConstraintType::NEQ ? 0xff : 0;
+    int slot = 0;
+    for (; slot + 8 <= slot_num; slot += 8) {
+        unsigned int group = groupBits(selection, slot);
+        if (group == 0) continue;
+        __m256i values = _mm256_i32gather_epi32(
+            (const int*)(stripe.column + slot * stripe.stride), offsets, 4);
+        unsigned int less = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpgt_epi32(target, values)));
+        unsigned int equal = _mm256_movemask_ps(
+            _mm256_castsi256_ps(_mm256_cmpeq_epi32(values, target)));
+        unsigned int null_bits = nullBits(stripe, slot, null_offsets);
+        unsigned int valid =
+            (compareBits(constraint_type, less, equal) & ~null_bits) |
+            (null_valid & null_bits);
+        unselectGroup(selection, slot, group & ~valid);
+    }
+    return slot;
+}
+
+__attribute__((target("avx2"))) int filterFloatAvx2(
+    const ColumnStripe& stripe, system::ConstraintType constraint_type,
+    double value, int slot_num, unsigned int* selection) {
+    __m256i offsets = slotOffsets(stripe.stride);
+    __m128i half_offsets = _mm256_castsi256_si128(offsets);
+    __m256i null_offsets = slotOffsets(stripe.null_stride);
+    __m256d target = _mm256_set1_pd(value);
+    __m256d full_mask = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    unsigned int null_valid =
+        constraint_type == system::ConstraintType::NEQ ? 0xff : 0;
+    int slot = 0;
+    for (; slot + 8 <= slot_num; slot += 8) {
+        unsigned int group = groupBits(selection, slot);
+        if (group == 0) continue;
+        // 页上的 FLOAT 只按 4 字节对齐, gather 不要求对齐
+        const unsigned int* column = stripe.column + slot * stripe.stride;
+        // 不带掩码的 gather 在 GCC 里以未初始化的向量为源, 这里显式给出
+        __m256d low = _mm256_mask_i32gather_pd(
+            _mm256_setzero_pd(), (const double*)column, half_offsets,
+            full_mask, BYTE_PER_BUF);
+        __m256d high = _mm256_mask_i32gather_pd(
+            _mm256_setzero_pd(), (const double*)(column + 4 * stripe.stride),
+            half_offsets, full_mask, BYTE_PER_BUF);
+        // 有序比较, NaN 既不小于也不等于, 与标量的 < 和 == 一致
+        unsigned int less =
+            _mm256_movemask_pd(_mm256_cmp_pd(low, target, _CMP_LT_OQ)) |
+            _mm256_movemask_pd(_mm256_cmp_pd(high, target, _CMP_LT_OQ)) << 4;
+        unsigned int equal =
+            _mm256_movemask_pd(_mm256_cmp_pd(low, target, _CMP_EQ_OQ)) |
+            _mm256_movemask_pd(_mm256_cmp_pd(high, target, _CMP_EQ_OQ)) << 4;
+        unsigned int null_bits = nullBits(stripe, slot, null_offsets);
+        unsigned int valid =
+            (compareBits(constraint_type, less, equal) & ~null_bits) |
+            (null_valid & null_bits);
+        unselectGroup(selection, slot, group & ~valid);
+    }
+    return slot;
+}
+
+#endif
+
+}  // namespace
+
+long long dateOrderKey(int year, int month, int day) {
+    // 页上的 month 和 day 是有符号字节, 约束值超出范围时截到范围外的一个值,
+    // 这样截断前后比较结果不变
+    month = std::clamp(month, -129, 128);
+    day = std::clamp(day, -129, 128);
+    return (long long)year * (1 << 18) + (month + 129) * (1 << 9) +
+           (day + 129);
+}
+
+void filterNull(const ColumnStripe& stripe, bool is_null, int slot_num,
+                unsigned int* selection) {
+    int begin = 0;
+#ifdef DBS_FILTER_AVX2
+    if (supportAvx2())
+        begin = filterNullAvx2(stripe, is_null, slot_num, selection);
+#endif
+    for (int slot = begin; slot < slot_num; slot++) {
+        if (!selected(selection, slot)) continue;
+        bool slot_null =
+            stripe.null_word[slot * stripe.null_stride] & stripe.null_mask;
+        if (slot_null != is_null) unselect(selection, slot);
+    }
+}
+
+void filterInt(const ColumnStripe& stripe,
+               system::ConstraintType constraint_type, int value,
+               int slot_num, unsigned int* selection) {
+    int begin = 0;
+#ifdef DBS_FILTER_AVX2
+    if (supportAvx2())
+        begin = filterIntAvx2(stripe, constraint_type, value, slot_num,
+                              selection);
+#endif
+    filterSlots(stripe, constraint_type, begin, slot_num, selection,
+                [&](const unsigned int* column) {
+                    int x = utils::bit322int(*column);
+                    return compareOne(constraint_type, x < value, x == value);
+                });
+}
+
+void filterFloat(const ColumnStripe& stripe,
+                 system::ConstraintType constraint_type, double value,
+                 int slot_num, unsigned int* selection) {
+    int begin = 0;
+#ifdef DBS_FILTER_AVX2
+    if (supportAvx2())
+        begin = filterFloatAvx2(stripe, constraint_type, value, slot_num,
+                                selection);
+#endif
+    filterSlots(stripe, constraint_type, begin, slot_num, selection,
+                [&](const unsigned int* column) {
+                    double x = utils::bit322float(column[0], column[1]);
+                    return compareOne(constraint_type, x < value, x == value);
+                });
+}
+
+void filterDate(const ColumnStripe& stripe,
+                system::ConstraintType constraint_type, const DateValue& value,
+                int slot_num, unsigned int* selection) {
+    // DATE 很少作为扫描条件, 只做逐槽比较, 但省去了逐字段的元组比较
+    long long target = dateOrderKey(value.year, value.month, value.day);
+    filterSlots(stripe, constraint_type, 0, slot_num, selection,
+                [&](const unsigned int* column) {
+                    long long x = dateKey(*column);
+                    return compareOne(constraint_type, x < target,
+                                      x == target);
+                });
+}
+
+}  // namespace record
+}  // namespace dbs
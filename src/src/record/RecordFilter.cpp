@@ -0,0 +1,215 @@
+#include "record/RecordFilter.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+namespace dbs {
+namespace record {
+
+RecordFilter::RecordFilter(
+    const std::vector<system::SearchConstraint>& constraints,
+    const RecordView& view)
+    : page_term_num(0) {
+    for (auto& constraint : constraints) {
+        int column_index = view.columnIndex(constraint.column_id);
+        // 与 validConstraint 一致, 不存在的列不做限制
+        if (column_index == -1) continue;
+        for (int j = 0; j < (int)constraint.constraint_types.size(); j++) {
+            auto& constraint_value = constraint.constraint_values[j];
+            auto constraint_type = constraint.constraint_types[j];
+            Term term{INT_COMPARE, column_index, constraint_type,
+                      constraint_value};
+            if (constraint_value.is_null) {
+                // null 只能用 EQ 和 NEQ 表示 IS NULL 和 IS NOT NULL
+                if (constraint_type == system::ConstraintType::EQ) {
+                    term.kind = IS_NULL;
+                } else if (constraint_type == system::ConstraintType::NEQ) {
+                    term.kind = NOT_NULL;
+                } else {
+                    continue;
+                }
+            } else if (constraint_value.type_name !=
+                       view.typeName(column_index)) {
+                term.kind = GENERIC_COMPARE;
+            } else {
+                switch (constraint_value.type_name) {
+                    case INT:
+                        term.kind = INT_COMPARE;
+                        break;
+                    case DATE:
+                        term.kind = DATE_COMPARE;
+                        break;
+                    case FLOAT:
+                        term.kind = FLOAT_COMPARE;
+                        break;
+                    case VARCHAR:
+                        term.kind = VARCHAR_COMPARE;
+                        break;
+                    default:
+                        term.kind = GENERIC_COMPARE;
+                        break;
+                }
+            }
+            terms.push_back(term);
+        }
+    }
+    // 便宜的比较放在前面, 字符串比较放在最后
+    std::stable_sort(terms.begin(), terms.end(),
+                     [](const Term& a, const Term& b) {
+                         return a.kind < b.kind;
+                     });
+    // 定长和 PAX 格式中每列的位置只取决于槽号, 定长类型的条件可以整页一起比较
+    if (!view.fixedLayout()) return;
+    while (page_term_num < (int)terms.size() &&
+           terms[page_term_num].kind <= FLOAT_COMPARE) {
+        int column_index = terms[page_term_num].column_index;
+        stripes.push_back(TermStripe{
+            view.columnOffset(column_index), view.columnStride(column_index),
+            view.nullOffset(column_index), view.nullStride()});
+        page_term_num++;
+    }
+}
+
+bool RecordFilter::compare(system::ConstraintType constraint_type, bool less,
+                           bool equal) {
+    switch (constraint_type) {
+        case system::ConstraintType::EQ:
+            return equal;
+        case system::ConstraintType::NEQ:
+            return !equal;
+        case system::ConstraintType::GT:
+            return !less && !equal;
+        case system::ConstraintType::GEQ:
+            return !less;
+        case system::ConstraintType::LT:
+            return less;
+        case system::ConstraintType::LEQ:
+            return less || equal;
+    }
+    return true;
+}
+
+void RecordFilter::filterPage(BufType b, int slot_num,
+                              unsigned int* selection) const {
+    const unsigned int* records = b + RECORD_PAGE_HEADER / BYTE_PER_BUF;
+    for (int i = 0; i < page_term_num; i++) {
+        auto& term = terms[i];
+        ColumnStripe stripe{records + stripes[i].column_offset,
+                            records + stripes[i].null_offset,
+                            1U << (term.column_index & BIT_PER_BUF_MASK),
+                            stripes[i].column_stride, stripes[i].null_stride};
+        switch (term.kind) {
+            case IS_NULL:
+            case NOT_NULL:
+                filterNull(stripe, term.kind == IS_NULL, slot_num, selection);
+                break;
+            case INT_COMPARE:
+                filterInt(stripe, term.constraint_type,
+                          term.value.value.int_value, slot_num, selection);
+                break;
+            case DATE_COMPARE:
+                filterDate(stripe, term.constraint_type,
+                           term.value.value.date_value, slot_num, selection);
+                break;
+            case FLOAT_COMPARE:
+                filterFloat(stripe, term.constraint_type,
+                            term.value.value.float_value, slot_num, selection);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+bool RecordFilter::mayMatchPage(const ZoneMap& zone_map, int page_id) const {
+    if (zone_map.empty(page_id)) return false;
+    for (auto& term : terms) {
+        switch (term.kind) {
+            case IS_NULL:
+            case NOT_NULL:
+                if (!zone_map.mayMatchNull(page_id, term.column_index,
+                                           term.kind == IS_NULL))
+                    return false;
+                break;
+            case INT_COMPARE:
+            case DATE_COMPARE:
+            case FLOAT_COMPARE:
+                if (!zone_map.mayMatch(page_id, term.column_index,
+                                       term.constraint_type, term.value))
+                    return false;
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+bool RecordFilter::match(const RecordView& view) const {
+    return matchFrom(view, 0);
+}
+
+bool RecordFilter::matchFrom(const RecordView& view, int first_term) const {
+    for (int i = first_term; i < (int)terms.size(); i++) {
+        auto& term = terms[i];
+        bool is_null = view.isNull(term.column_index);
+        if (term.kind == IS_NULL) {
+            if (!is_null) return false;
+            continue;
+        }
+        if (term.kind == NOT_NULL) {
+            if (is_null) return false;
+            continue;
+        }
+        if (is_null) {
+            // null 比任何值都小且不相等, 只满足 NEQ
+            if (term.constraint_type != system::ConstraintType::NEQ)
+                return false;
+            continue;
+        }
+        switch (term.kind) {
+            case INT_COMPARE: {
+                int value = view.getInt(term.column_index);
+                int target = term.value.value.int_value;
+                if (!compare(term.constraint_type, value < target,
+                             value == target))
+                    return false;
+                break;
+            }
+            case DATE_COMPARE: {
+                DateValue value = view.getDate(term.column_index);
+                auto& target = term.value.value.date_value;
+                auto a = std::tie(value.year, value.month, value.day);
+                auto b = std::tie(target.year, target.month, target.day);
+                if (!compare(term.constraint_type, a < b, a == b))
+                    return false;
+                break;
+            }
+            case FLOAT_COMPARE: {
+                double value = view.getFloat(term.column_index);
+                double target = term.value.value.float_value;
+                if (!compare(term.constraint_type, value < target,
+                             value == target))
+                    return false;
+                break;
+            }
+            case VARCHAR_COMPARE: {
+                int result = view.getVarchar(term.column_index)
+                                 .compare(term.value.value.char_value);
+                if (!compare(term.constraint_type, result < 0, result == 0))
+                    return false;
+                break;
+            }
+            default: {
+                // 类型不一致时 DataValue 的 == 总是 false
+                bool less = view.getValue(term.column_index) < term.value;
+                if (!compare(term.constraint_type, less, false)) return false;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace record
+}  // namespace dbs
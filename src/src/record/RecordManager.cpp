@@ -20,13 +20,13 @@ RecordManager::~RecordManager() {
 }
 
 void RecordManager::closeAllCurrentFile() {
-    bpm->close();
     for (auto& file_path : current_opening_file_paths) {
         delete[] file_path;
         file_path = nullptr;
     }
     current_opening_file_paths.clear();
     for (auto& file_id : current_opening_file_ids) {
+        bpm->closeFile(file_id);
         fm->closeFile(file_id);
     }
     current_opening_file_ids.clear();
@@ -37,7 +37,7 @@ void RecordManager::closeFileIfExist(const char* file_path) {
     for (int i = 0; i < current_opening_file_num; i++) {
         if (strcmp(current_opening_file_paths[i], file_path) == 0) {
             int file_id = current_opening_file_ids[i];
-            bpm->close();
+            bpm->closeFile(file_id);
             fm->closeFile(file_id);
             delete[] current_opening_file_paths[i];
             current_opening_file_paths[i] = nullptr;
@@ -52,8 +52,8 @@ void RecordManager::closeFileIfExist(const char* file_path) {
 
 void RecordManager::closeFirstFile() {
     if (current_opening_file_ids.size() == 0) return;
-    bpm->close();
     int file_id = current_opening_file_ids.front();
+    bpm->closeFile(file_id);
     current_opening_file_ids.erase(current_opening_file_ids.begin());
     fm->closeFile(file_id);
     delete[] current_opening_file_paths.front();
@@ -110,7 +110,8 @@ int RecordManager::openFile(const char* file_path) {
 }
 
 void RecordManager::initializeRecordFile(
-    const char* file_path, const std::vector<ColumnType>& column_types) {
+    const char* file_path, const std::vector<ColumnType>& column_types,
+    int record_format) {
     closeFileIfExist(file_path);
     cleanColumnTypesIfExist(file_path);
     if (fm->existFile(file_path)) {
@@ -124,6 +125,10 @@ void RecordManager::initializeRecordFile(
     b = bpm->getPage(file_id, 0, index);
     for (int i = 0; i < RECORD_META_DATA_HEAD / BYTE_PER_BUF; i++) b[i] = 0;
     b[7] = (column_types.size() + BIT_PER_BUF - 1) / BIT_PER_BUF + 1;
+    b[RECORD_FREE_LIST_BUF] = RECORD_FREE_LIST_MAGIC;
+    b[RECORD_FREE_LIST_BUF + 1] = -1;
+    b[RECORD_FORMAT_BUF] = record_format;
+    b[RECORD_OVERFLOW_LIST_BUF] = -1;
     for (auto& column : column_types) {
         utils::setBitFromBuf(b, b[4], true);
         unsigned int column_id = b[4]++;
@@ -143,6 +148,9 @@ void RecordManager::initializeRecordFile(
                 varchar_space += 2;
             }
             b[start_buf_position + 2] = varchar_space;
+            // 宽 VARCHAR 按定长存放浪费太多, 改用变长格式
+            if (varchar_space >= RECORD_SLOTTED_VARCHAR_SPACE)
+                b[RECORD_FORMAT_BUF] = RECORD_FORMAT_SLOTTED;
         }
         start_buf_position += 3;
         int buf_position = start_buf_position, byte_position = 0;
@@ -203,6 +211,7 @@ void RecordManager::initializeRecordFile(
         }
     }
     bpm->markDirty(index);
+    resetZoneMap(file_path, column_types);
 }
 
 void RecordManager::updateColumnUnique(const char* file_path, int column_id,
@@ -214,8 +223,10 @@ void RecordManager::updateColumnUnique(const char* file_path, int column_id,
     BufType b;
     b = bpm->getPage(file_id, 0, index);
     int column_num = b[4];
-    bpm->access(index);
-    if (column_id >= column_num) return;
+    if (column_id >= column_num) {
+        bpm->access(index);
+        return;
+    }
     int start_buf_position =
         (column_id * RECORD_META_DATA_LENGTH + RECORD_META_DATA_HEAD) /
         BYTE_PER_BUF;
@@ -328,117 +339,104 @@ void RecordManager::getColumnTypes(const char* file_path,
     }
 }
 
-int RecordManager::insertRecordsToEmptyRecord(const char* file_path,
-                                              const char* csv_path,
-                                              const char* delimeter,
-                                              bool output) {
-    std::ifstream csv_file(csv_path);
-    if (!csv_file.is_open()) {
-        std::cerr << "Failed to open file " << csv_path << std::endl;
-        return -1;
-    }
-
+int RecordManager::insertRecordsToEmptyRecord(
+    const char* file_path, const char* csv_path, const char* delimeter,
+    bool output,
+    const std::function<void(const DataItem&, const RecordLocation&)>&
+        on_insert) {
     int file_id = openFile(file_path);
     assert(file_id != -1);
 
     std::vector<ColumnType> column_types;
     getColumnTypes(file_path, column_types);
 
+    CsvReader csv_reader(column_types, delimeter[0]);
+    if (!csv_reader.open(csv_path)) {
+        std::cerr << "Failed to open file " << csv_path << std::endl;
+        return -1;
+    }
+
     BufType b;
     int index;
     b = bpm->getPage(file_id, 0, index);
     int null_bitmap_buf_size = b[7];
+    // 整个文件重写, 旧格式的文件也直接改用紧凑格式
+    int record_format = getRecordFormat(b);
+    bool slotted = record_format == RECORD_FORMAT_SLOTTED;
+    if (record_format != RECORD_FORMAT_SLOTTED &&
+        record_format != RECORD_FORMAT_PAX)
+        record_format = RECORD_FORMAT_COMPACT;
+    setRecordFormat(b, record_format);
+    if (slotted) {
+        // 变长格式逐条插入, 由空闲页链表决定位置
+        b[5] = 0;
+        b[6] = 0;
+        b[RECORD_FREE_LIST_BUF] = RECORD_FREE_LIST_MAGIC;
+        b[RECORD_FREE_LIST_BUF + 1] = -1;
+        b[RECORD_OVERFLOW_LIST_BUF] = -1;
+    }
     bpm->markDirty(index);
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
     int data_item_per_page = std::min(
         (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
 
+    // 文件整个重写, 页摘要随导入重新建立
+    ZoneMap* zone_map = resetZoneMap(file_path, column_types);
     int page_id = 1, slot_id = 0, record_id = 0;
-    b = bpm->getPage(file_id, page_id, index);
-    memset(b, 0, BUF_PER_PAGE * BYTE_PER_BUF);
-    bpm->markDirty(index);
+    // 当前页写满或导入结束时才 markDirty, 写入期间页一直被 pin 住
+    if (!slotted) {
+        b = bpm->getPage(file_id, page_id, index);
+        memset(b, 0, BUF_PER_PAGE * BYTE_PER_BUF);
+    }
 
-    std::string line;
-    while (getline(csv_file, line)) {
-        std::vector<std::string> csv_row;
-        std::string item;
-        for (int i = 0; i < line.length(); i++) {
-            if (line[i] == delimeter[0]) {
-                csv_row.push_back(item);
-                item = "";
-            } else {
-                item += line[i];
-            }
-        }
-        csv_row.push_back(item);
-
-        record::DataItem data_item;
-        int csv_row_idx = 0;
-        if (csv_row.size() != column_types.size()) {
-            std::cout << "!ERROR" << std::endl;
-            std::cout << "CSV file format error" << std::endl;
-            return -1;
-        }
-        for (auto& column : column_types) {
-            data_item.column_ids.push_back(column.column_id);
-            record::DateValue date_value;
-            double floatValue;
-            if (column.type_name == record::DataTypeName::FLOAT) {
-                std::istringstream iss(csv_row[csv_row_idx++]);
-                iss >> floatValue;
-            }
-            switch (column.type_name) {
-                case record::DataTypeName::INT:
-                    data_item.data_values.push_back(
-                        record::DataValue(record::DataTypeName::INT, false,
-                                          std::stoi(csv_row[csv_row_idx++])));
-                    break;
-                case record::DataTypeName::FLOAT:
-                    data_item.data_values.push_back(record::DataValue(
-                        record::DataTypeName::FLOAT, false, floatValue));
-                    break;
-                case record::DataTypeName::VARCHAR:
-                    data_item.data_values.push_back(
-                        record::DataValue(record::DataTypeName::VARCHAR, false,
-                                          csv_row[csv_row_idx++]));
-                    break;
-                case record::DataTypeName::DATE:
-                    date_value.year = std::stoi(csv_row[csv_row_idx].substr(
-                        0, csv_row[csv_row_idx].find('-')));
-                    date_value.month = std::stoi(csv_row[csv_row_idx].substr(
-                        csv_row[csv_row_idx].find('-') + 1,
-                        csv_row[csv_row_idx].rfind('-') -
-                            csv_row[csv_row_idx].find('-') - 1));
-                    date_value.day = std::stoi(csv_row[csv_row_idx].substr(
-                        csv_row[csv_row_idx].rfind('-') + 1));
-                    csv_row_idx++;
-                    data_item.data_values.push_back(record::DataValue(
-                        record::DataTypeName::DATE, false, date_value));
-                    break;
-            }
+    // 解析在其他线程中进行, 这里只按行的顺序写入页
+    int row_num = csv_reader.read([&](const DataItem& data_item) {
+        if (slotted) {
+            auto location =
+                insertItem(file_id, data_item, column_types, zone_map);
+            if (on_insert) on_insert(data_item, location);
+            record_id++;
+            return;
         }
-
         if (slot_id == data_item_per_page) {
+            bpm->markDirty(index);
             page_id++;
             slot_id = 0;
             b = bpm->getPage(file_id, page_id, index);
             memset(b, 0, BUF_PER_PAGE * BYTE_PER_BUF);
-            bpm->markDirty(index);
         }
         setSlotItem(b, slot_id, data_item_length, null_bitmap_buf_size,
-                    record_id++, data_item, column_types);
+                    record_id++, data_item, column_types,
+                    record_format == RECORD_FORMAT_PAX);
+        zone_map->add(page_id, data_item);
+        if (on_insert) on_insert(data_item, RecordLocation{page_id, slot_id});
         slot_id++;
+    });
+    if (!slotted) bpm->markDirty(index);
+    if (row_num == -1) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << "CSV file format error" << std::endl;
+        return -1;
     }
-    csv_file.close();
     if (output) {
         std::cout << "rows" << std::endl;
         std::cout << record_id << std::endl;
     }
+    if (slotted) return data_item_per_page;
 
+    // 最后一页未满时作为唯一的空闲页
+    bool has_free_slot = slot_id < data_item_per_page;
+    if (has_free_slot) {
+        b = bpm->getPage(file_id, page_id, index);
+        b[RECORD_FREE_LINK_BUF] = RECORD_FREE_LINK_END;
+        bpm->markDirty(index);
+    }
     b = bpm->getPage(file_id, 0, index);
     b[5] = page_id;
     b[6] = record_id;
+    b[RECORD_FREE_LIST_BUF] = RECORD_FREE_LIST_MAGIC;
+    b[RECORD_FREE_LIST_BUF + 1] = has_free_slot ? page_id : -1;
     bpm->markDirty(index);
     return data_item_per_page;
 }
@@ -454,44 +452,119 @@ RecordLocation RecordManager::insertRecord(const char* file_path,
     if (!exactMatch(column_types, data_item)) {
         return RecordLocation{-1, -1};
     }
+    return insertItem(file_id, data_item, column_types,
+                      findZoneMap(file_path));
+}
 
+RecordLocation RecordManager::insertItem(
+    int file_id, const DataItem& data_item,
+    const std::vector<ColumnType>& column_types, ZoneMap* zone_map) {
     BufType b;
     int index;
     b = bpm->getPage(file_id, 0, index);
-    int page_num = b[5];
     int record_id = b[6];
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
+    bool has_free_list = b[RECORD_FREE_LIST_BUF] == RECORD_FREE_LIST_MAGIC;
     bpm->access(index);
+    bool slotted = record_format == RECORD_FORMAT_SLOTTED;
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
     int data_item_per_page = std::min(
         (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
 
-    for (int page_id = 1; page_id <= page_num; page_id++) {
+    // 变长格式先编码, 分配溢出页会增加页数
+    unsigned int record[BUF_PER_PAGE];
+    int record_length = 0;
+    if (slotted)
+        record_length = encodeSlottedItem(
+            file_id, record, record_id, null_bitmap_buf_size, data_item,
+            column_types, RECORD_SLOTTED_INLINE_MAX);
+    // 变长格式下 data_item_length 是记录的最小长度, 放不下时认为页满
+    auto findSlot = [&](BufType b, int length) {
+        return slotted ? findSlottedSlot(b, length)
+                       : findFreeSlot(b, data_item_per_page);
+    };
+    auto putItem = [&](BufType b, int page_id, int slot_id) {
+        if (slotted)
+            writeSlottedItem(b, slot_id, record, record_length);
+        else
+            setSlotItem(b, slot_id, data_item_length, null_bitmap_buf_size,
+                        record_id, data_item, column_types,
+                        record_format == RECORD_FORMAT_PAX);
+        if (zone_map) zone_map->add(page_id, data_item);
+    };
+
+    b = bpm->getPage(file_id, 0, index);
+    int page_num = b[5];
+    bpm->access(index);
+    if (!has_free_list) rebuildFreeList(file_id, page_num, data_item_per_page);
+    b = bpm->getPage(file_id, 0, index);
+    int page_id = b[RECORD_FREE_LIST_BUF + 1];
+    bpm->access(index);
+
+    // 把 page_id 移出链表, 由前一页 (没有时为链表头) 指向 next_page_id
+    int prev_page_id = -1;
+    auto unlinkPage = [&](int next_page_id) {
+        int prev_index;
+        if (prev_page_id == -1) {
+            BufType head = bpm->getPage(file_id, 0, prev_index);
+            head[RECORD_FREE_LIST_BUF + 1] = next_page_id;
+            bpm->markDirty(prev_index);
+        } else {
+            BufType prev = bpm->getPage(file_id, prev_page_id, prev_index);
+            prev[RECORD_FREE_LINK_BUF] =
+                (next_page_id == -1) ? RECORD_FREE_LINK_END : next_page_id;
+            bpm->markDirty(prev_index);
+        }
+    };
+
+    // 沿空闲页链表找空位
+    while (page_id != -1) {
         b = bpm->getPage(file_id, page_id, index);
-        for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
-            if (!utils::getBitFromBuf(b, slot_id)) {
-                setSlotItem(b, slot_id, data_item_length, null_bitmap_buf_size,
-                            record_id, data_item, column_types);
-                bpm->markDirty(index);
-                b = bpm->getPage(file_id, 0, index);
-                b[6]++;
-                bpm->markDirty(index);
-                return RecordLocation{page_id, slot_id};
-            }
+        int slot_id = findSlot(b, record_length);
+        unsigned int next = b[RECORD_FREE_LINK_BUF];
+        int next_page_id = (next == RECORD_FREE_LINK_END) ? -1 : next;
+        if (slot_id != -1) putItem(b, page_id, slot_id);
+        // 放不下最短的记录才移出链表, 变长格式下放不下这条记录的页仍留在链表中
+        bool full = findSlot(b, data_item_length) == -1;
+        if (full) b[RECORD_FREE_LINK_BUF] = 0;
+        if (slot_id != -1 || full)
+            bpm->markDirty(index);
+        else
             bpm->access(index);
+        if (full) unlinkPage(next_page_id);
+        if (slot_id != -1) {
+            b = bpm->getPage(file_id, 0, index);
+            b[6]++;
+            bpm->markDirty(index);
+            return RecordLocation{page_id, slot_id};
         }
+        if (!full) prev_page_id = page_id;
+        page_id = next_page_id;
     }
-    b = bpm->getPage(file_id, page_num + 1, index);
-    for (int i = 0; i < RECORD_PAGE_HEADER / BYTE_PER_BUF; i++) b[i] = 0;
-    setSlotItem(b, 0, data_item_length, null_bitmap_buf_size, record_id,
-                data_item, column_types);
+
+    // 没有能放下这条记录的页, 追加一页, 有空位时放到链表头部
+    b = bpm->getPage(file_id, 0, index);
+    int head = b[RECORD_FREE_LIST_BUF + 1];
+    bpm->access(index);
+    page_id = page_num + 1;
+    b = bpm->getPage(file_id, page_id, index);
+    if (slotted)
+        initSlottedPage(b);
+    else
+        for (int i = 0; i < RECORD_PAGE_HEADER / BYTE_PER_BUF; i++) b[i] = 0;
+    putItem(b, page_id, 0);
+    bool has_free_slot = findSlot(b, data_item_length) != -1;
+    if (has_free_slot)
+        b[RECORD_FREE_LINK_BUF] = (head == -1) ? RECORD_FREE_LINK_END : head;
     bpm->markDirty(index);
     b = bpm->getPage(file_id, 0, index);
     b[5]++;
     b[6]++;
+    if (has_free_slot) b[RECORD_FREE_LIST_BUF + 1] = page_id;
     bpm->markDirty(index);
-    return RecordLocation{page_num + 1, 0};
+    return RecordLocation{page_id, 0};
 }
 
 bool RecordManager::deleteRecord(const char* file_path,
@@ -500,12 +573,190 @@ bool RecordManager::deleteRecord(const char* file_path,
     assert(file_id != -1);
     int index;
     BufType b;
+    b = bpm->getPage(file_id, 0, index);
+    bool has_free_list = b[RECORD_FREE_LIST_BUF] == RECORD_FREE_LIST_MAGIC;
+    int head = b[RECORD_FREE_LIST_BUF + 1];
+    int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
+    bool slotted = record_format == RECORD_FORMAT_SLOTTED;
+    bpm->access(index);
+    ZoneMap* zone_map = findZoneMap(file_path);
+    std::vector<ColumnType> column_types;
+    if (slotted || zone_map) getColumnTypes(file_path, column_types);
     b = bpm->getPage(file_id, record_location.page_id, index);
+    if (zone_map && utils::getBitFromBuf(b, record_location.slot_id)) {
+        RecordView view(
+            column_types, null_bitmap_buf_size, record_format,
+            slotLength(column_types, null_bitmap_buf_size, record_format));
+        view.reset(b, record_location.slot_id);
+        zone_map->remove(record_location.page_id, view);
+    }
+    // 变长格式的记录删除时一并释放溢出页
+    std::vector<int> overflow_page_ids;
+    if (slotted && utils::getBitFromBuf(b, record_location.slot_id))
+        getOverflowPages(b, record_location.slot_id, null_bitmap_buf_size,
+                         column_types, overflow_page_ids);
     utils::setBitFromBuf(b, record_location.slot_id, false);
+    // 原本已满的页放回空闲页链表头部
+    bool push = has_free_list && b[RECORD_FREE_LINK_BUF] == 0;
+    if (push)
+        b[RECORD_FREE_LINK_BUF] = (head == -1) ? RECORD_FREE_LINK_END : head;
     bpm->markDirty(index);
+    if (push) {
+        b = bpm->getPage(file_id, 0, index);
+        b[RECORD_FREE_LIST_BUF + 1] = record_location.page_id;
+        bpm->markDirty(index);
+    }
+    for (int page_id : overflow_page_ids) freeOverflow(file_id, page_id);
     return true;
 }
 
+int RecordManager::findFreeSlot(BufType b, int data_item_per_page) {
+    int buf_num = (data_item_per_page + BIT_PER_BUF - 1) >> LOG_BIT_PER_BUF;
+    for (int i = 0; i < buf_num; i++) {
+        if (b[i] == 0xffffffffU) continue;
+        int slot_id = (i << LOG_BIT_PER_BUF) + utils::getFirstZeroBit(b[i]);
+        return slot_id < data_item_per_page ? slot_id : -1;
+    }
+    return -1;
+}
+
+void RecordManager::rebuildFreeList(int file_id, int page_num,
+                                    int data_item_per_page) {
+    BufType b;
+    int index;
+    int head = -1;
+    for (int page_id = 1; page_id <= page_num; page_id++) {
+        b = bpm->getPage(file_id, page_id, index);
+        if (b[RECORD_FREE_LINK_BUF] == RECORD_OVERFLOW_PAGE) {
+            bpm->access(index);
+            continue;
+        }
+        if (findFreeSlot(b, data_item_per_page) != -1) {
+            b[RECORD_FREE_LINK_BUF] =
+                (head == -1) ? RECORD_FREE_LINK_END : head;
+            head = page_id;
+        } else {
+            b[RECORD_FREE_LINK_BUF] = 0;
+        }
+        bpm->markDirty(index);
+    }
+    b = bpm->getPage(file_id, 0, index);
+    // 旧文件中格式和溢出页链表所在的 buf 从未写过, 与标记一起写入
+    if (b[RECORD_FREE_LIST_BUF] != RECORD_FREE_LIST_MAGIC) {
+        b[RECORD_FORMAT_BUF] = 0;
+        b[RECORD_OVERFLOW_LIST_BUF] = -1;
+    }
+    b[RECORD_FREE_LIST_BUF] = RECORD_FREE_LIST_MAGIC;
+    b[RECORD_FREE_LIST_BUF + 1] = head;
+    bpm->markDirty(index);
+}
+
+int RecordManager::getRecordFormat(BufType b) {
+    if (b[RECORD_FREE_LIST_BUF] != RECORD_FREE_LIST_MAGIC) return 0;
+    return b[RECORD_FORMAT_BUF];
+}
+
+void RecordManager::setRecordFormat(BufType b, int record_format) {
+    if (b[RECORD_FREE_LIST_BUF] != RECORD_FREE_LIST_MAGIC) {
+        b[RECORD_FREE_LIST_BUF] = RECORD_FREE_LIST_MAGIC;
+        b[RECORD_FREE_LIST_BUF + 1] = -1;
+        b[RECORD_OVERFLOW_LIST_BUF] = -1;
+    }
+    b[RECORD_FORMAT_BUF] = record_format;
+}
+
+int RecordManager::compactRecordFile(const char* file_path) {
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
+
+    std::vector<ColumnType> column_types;
+    getColumnTypes(file_path, column_types);
+
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, 0, index);
+    int page_num = b[5];
+    int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
+    bpm->access(index);
+    // 变长格式的记录本就按实际长度存放, 页内空间在插入时整理
+    if (record_format == RECORD_FORMAT_SLOTTED) return page_num;
+    // 记录的位置改变, 页摘要在下次扫描时重新建立
+    dropZoneMap(file_path);
+    int old_length =
+        slotLength(column_types, null_bitmap_buf_size, record_format);
+    int old_per_page = std::min((PAGE_SIZE - RECORD_PAGE_HEADER) / old_length,
+                                MAX_ITEM_PER_PAGE);
+    bool pax = record_format == RECORD_FORMAT_PAX;
+    int new_format = pax ? RECORD_FORMAT_PAX : RECORD_FORMAT_COMPACT;
+    int new_length =
+        slotLength(column_types, null_bitmap_buf_size, new_format);
+    int new_per_page = std::min((PAGE_SIZE - RECORD_PAGE_HEADER) / new_length,
+                                MAX_ITEM_PER_PAGE);
+    // 槽内布局两种格式相同, 只需按新的槽长依次搬移
+    int copy_length =
+        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+    // PAX 格式的字段分散在各个 minipage 中, 逐条读出再写入
+    RecordView view(column_types, null_bitmap_buf_size, record_format,
+                    old_length);
+    DataItem data_item;
+
+    // 目标位置不会超过源位置, 源页先复制出来, 原地改写即可
+    BufType old_page = new unsigned int[BUF_PER_PAGE];
+    BufType target = nullptr;
+    int target_index = -1;
+    int target_page_id = 0, target_slot_id = new_per_page;
+    for (int page_id = 1; page_id <= page_num; page_id++) {
+        b = bpm->getPage(file_id, page_id, index);
+        memcpy(old_page, b, PAGE_SIZE);
+        bpm->access(index);
+        for (int slot_id = 0; slot_id < old_per_page; slot_id++) {
+            if (!utils::getBitFromBuf(old_page, slot_id)) continue;
+            if (target_slot_id == new_per_page) {
+                target_page_id++;
+                target_slot_id = 0;
+                target = bpm->getPage(file_id, target_page_id, target_index);
+                for (int i = 0; i < RECORD_PAGE_HEADER / BYTE_PER_BUF; i++)
+                    target[i] = 0;
+                bpm->markDirty(target_index);
+            }
+            // 读下一个源页时目标页可能被换出, 每次重新取页
+            target = bpm->getPage(file_id, target_page_id, target_index);
+            if (pax) {
+                view.reset(old_page, slot_id);
+                view.materialize(data_item);
+                setSlotItem(target, target_slot_id, new_length,
+                            null_bitmap_buf_size, data_item.data_id,
+                            data_item, column_types, true);
+            } else {
+                memcpy((char*)target + RECORD_PAGE_HEADER +
+                           target_slot_id * new_length,
+                       (char*)old_page + RECORD_PAGE_HEADER +
+                           slot_id * old_length,
+                       copy_length);
+                utils::setBitFromBuf(target, target_slot_id, true);
+            }
+            bpm->markDirty(target_index);
+            target_slot_id++;
+        }
+    }
+    delete[] old_page;
+    // 清空多出来的页, 之后追加页时不会读到旧的位图
+    for (int page_id = target_page_id + 1; page_id <= page_num; page_id++) {
+        b = bpm->getPage(file_id, page_id, index);
+        for (int i = 0; i < RECORD_PAGE_HEADER / BYTE_PER_BUF; i++) b[i] = 0;
+        bpm->markDirty(index);
+    }
+
+    b = bpm->getPage(file_id, 0, index);
+    b[5] = target_page_id;
+    setRecordFormat(b, new_format);
+    bpm->markDirty(index);
+    rebuildFreeList(file_id, target_page_id, new_per_page);
+    return target_page_id;
+}
+
 bool RecordManager::getRecord(const char* file_path,
                               const RecordLocation& record_location,
                               DataItem& data_item) {
@@ -517,16 +768,18 @@ bool RecordManager::getRecord(const char* file_path,
     BufType b;
     b = bpm->getPage(file_id, 0, index);
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
 
     bpm->access(index);
 
     b = bpm->getPage(file_id, record_location.page_id, index);
     bpm->access(index);
     if (!utils::getBitFromBuf(b, record_location.slot_id)) return false;
-    data_item = getSlotItem(
-        b, record_location.slot_id,
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF),
-        null_bitmap_buf_size, column_types);
+    RecordView view(
+        column_types, null_bitmap_buf_size, record_format,
+        slotLength(column_types, null_bitmap_buf_size, record_format));
+    data_item = readSlotItem(file_id, record_location.page_id, b,
+                             record_location.slot_id, view);
     return true;
 }
 
@@ -541,22 +794,76 @@ bool RecordManager::getRecords(
 
     b = bpm->getPage(file_id, 0, index);
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
+    bpm->access(index);
 
     std::vector<ColumnType> column_types;
     getColumnTypes(file_path, column_types);
+    int data_item_length =
+        slotLength(column_types, null_bitmap_buf_size, record_format);
+    RecordView view(column_types, null_bitmap_buf_size, record_format,
+                    data_item_length);
 
     for (auto& record_location : record_locations) {
         b = bpm->getPage(file_id, record_location.page_id, index);
         bpm->access(index);
         if (!utils::getBitFromBuf(b, record_location.slot_id)) return false;
-        data_items.push_back(getSlotItem(
-            b, record_location.slot_id,
-            dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF),
-            null_bitmap_buf_size, column_types));
+        data_items.push_back(readSlotItem(file_id, record_location.page_id,
+                                          b, record_location.slot_id, view));
     }
     return true;
 }
 
+void RecordManager::getRecordsWithConstraint(
+    const char* file_path, const std::vector<RecordLocation>& record_locations,
+    const std::vector<system::SearchConstraint>& constraints,
+    std::vector<DataItem>& data_items,
+    std::vector<RecordLocation>& result_locations) {
+    data_items.clear();
+    result_locations.clear();
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
+    int index;
+    BufType b;
+
+    b = bpm->getPage(file_id, 0, index);
+    int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
+    bpm->access(index);
+
+    std::vector<ColumnType> column_types;
+    getColumnTypes(file_path, column_types);
+    RecordView view(
+        column_types, null_bitmap_buf_size, record_format,
+        slotLength(column_types, null_bitmap_buf_size, record_format));
+    RecordFilter filter(constraints, view);
+
+    for (auto& record_location : record_locations) {
+        b = bpm->getPage(file_id, record_location.page_id, index);
+        bpm->access(index);
+        if (!utils::getBitFromBuf(b, record_location.slot_id)) continue;
+        view.reset(b, record_location.slot_id);
+        if (view.hasOverflow()) {
+            auto data_item = readSlotItem(file_id, record_location.page_id, b,
+                                          record_location.slot_id, view);
+            bool valid = true;
+            for (auto& constraint : constraints) {
+                if (!system::validConstraint(constraint, data_item)) {
+                    valid = false;
+                    break;
+                }
+            }
+            if (!valid) continue;
+            data_items.push_back(std::move(data_item));
+        } else {
+            if (!filter.match(view)) continue;
+            data_items.emplace_back();
+            view.materialize(data_items.back());
+        }
+        result_locations.push_back(record_location);
+    }
+}
+
 bool RecordManager::updateRecord(const char* file_path,
                                  const RecordLocation& record_location,
                                  const DataItem& data_item) {
@@ -579,9 +886,8 @@ bool RecordManager::updateRecord(const char* file_path,
             return false;
         }
     }
-    if (!deleteRecord(file_path, record_location)) {
-        return false;
-    }
+    // 原位覆盖, 槽的占用不变, 不影响空闲页链表
+    // 变长格式的记录变长时可能在页内移动, 但槽号不变
     int file_id = openFile(file_path);
     assert(file_id != -1);
     std::vector<ColumnType> column_types;
@@ -591,45 +897,68 @@ bool RecordManager::updateRecord(const char* file_path,
     int index;
     b = bpm->getPage(file_id, 0, index);
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
     bpm->access(index);
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
-
-    b = bpm->getPage(file_id, record_location.page_id, index);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
 
     sortDataItem(column_types, original_data_item);
-    if (!exactMatch(column_types, original_data_item)) {
+    if (record_format == RECORD_FORMAT_SLOTTED) {
+        if (!exactMatch(column_types, original_data_item)) return false;
+        updateSlottedItem(file_id, record_location, original_data_item,
+                          null_bitmap_buf_size, column_types);
+    } else {
+        b = bpm->getPage(file_id, record_location.page_id, index);
+        if (!exactMatch(column_types, original_data_item)) {
+            setSlotItem(b, record_location.slot_id, data_item_length,
+                        null_bitmap_buf_size, original_data_item.data_id,
+                        original_data_item_save, column_types,
+                        record_format == RECORD_FORMAT_PAX);
+            bpm->markDirty(index);
+            return false;
+        }
         setSlotItem(b, record_location.slot_id, data_item_length,
                     null_bitmap_buf_size, original_data_item.data_id,
-                    original_data_item_save, column_types);
+                    original_data_item, column_types,
+                    record_format == RECORD_FORMAT_PAX);
         bpm->markDirty(index);
-        return false;
     }
-
-    setSlotItem(b, record_location.slot_id, data_item_length,
-                null_bitmap_buf_size, original_data_item.data_id,
-                original_data_item, column_types);
-    bpm->markDirty(index);
+    if (ZoneMap* zone_map = findZoneMap(file_path)) {
+        zone_map->remove(record_location.page_id, original_data_item_save);
+        zone_map->add(record_location.page_id, original_data_item);
+    }
     return true;
 }
 
 void RecordManager::setSlotItem(BufType b, int slot_id, int slot_length,
                                 int null_bitmap_buf_size, int record_id,
                                 const DataItem& data_item,
-                                const std::vector<ColumnType>& column_types) {
+                                const std::vector<ColumnType>& column_types,
+                                bool pax) {
     utils::setBitFromBuf(b, slot_id, true);
-    int start_buf_position =
-        (RECORD_PAGE_HEADER + slot_id * slot_length) / BYTE_PER_BUF;
-    b[start_buf_position] = record_id;
-    int column_num = column_types.size(), buf_position = start_buf_position;
+    // 定长格式的字段在槽内依次存放;
+    // PAX 格式每个字段有一个 minipage, 依次存放所有槽的该字段
+    int row_num = std::min((PAGE_SIZE - RECORD_PAGE_HEADER) / slot_length,
+                           MAX_ITEM_PER_PAGE);
+    int field_start =
+        (RECORD_PAGE_HEADER + (pax ? 0 : slot_id * slot_length)) /
+        BYTE_PER_BUF;
+    // 宽度为 width (以buf为单位) 的下一个字段的位置
+    auto nextField = [&](int width) {
+        int position = field_start + (pax ? slot_id * width : 0);
+        field_start += pax ? width * row_num : width;
+        return position;
+    };
+    b[nextField(1)] = record_id;
+    int column_num = column_types.size(), buf_position = 0;
     int buf_offset = 0;
-    start_buf_position++;
+    int null_position = nextField(null_bitmap_buf_size);
     for (int column_id = 0; column_id < column_num; column_id++) {
-        if (column_id % BIT_PER_BUF == 0) buf_position++;
-        utils::setBitFromNum(b[buf_position], column_id & BIT_PER_BUF_MASK,
-                             data_item.data_values[column_id].is_null);
+        utils::setBitFromNum(
+            b[null_position + (column_id >> LOG_BIT_PER_BUF)],
+            column_id & BIT_PER_BUF_MASK,
+            data_item.data_values[column_id].is_null);
     }
-    start_buf_position += null_bitmap_buf_size;
     for (int column_id = 0; column_id < column_num; column_id++) {
         auto& data_value = data_item.data_values[column_id];
         auto& column_type = column_types[column_id];
@@ -644,6 +973,7 @@ void RecordManager::setSlotItem(BufType b, int slot_id, int slot_length,
                 column_byte_width = column_type.varchar_space + 2;
                 break;
         }
+        int start_buf_position = nextField(column_byte_width / BYTE_PER_BUF);
         int varchar_length = 0;
         if (!data_value.is_null) {
             switch (column_type.type_name) {
@@ -679,111 +1009,370 @@ void RecordManager::setSlotItem(BufType b, int slot_id, int slot_length,
                     break;
             }
         }
-        start_buf_position += column_byte_width / BYTE_PER_BUF;
     }
 }
 
-DataItem RecordManager::getSlotItem(
-    BufType b, int slot_id, int slot_length, int null_bitmap_buf_size,
-    const std::vector<ColumnType>& column_types) {
-    DataItem data_item;
-    int start_buf_position =
-        (RECORD_PAGE_HEADER + slot_id * slot_length) / BYTE_PER_BUF;
-    data_item.data_id = b[start_buf_position];
-    int column_num = column_types.size(), buf_position = start_buf_position;
-    int buf_offset = 0;
-    start_buf_position++;
-    for (int column_id = 0; column_id < column_num; column_id++) {
-        if (column_id % BIT_PER_BUF == 0) buf_position++;
-        bool is_null =
-            utils::getBitFromNum(b[buf_position], column_id & BIT_PER_BUF_MASK);
-        data_item.data_values.push_back(
-            DataValue{column_types[column_id].type_name, is_null});
-        data_item.column_ids.push_back(column_types[column_id].column_id);
-    }
-    start_buf_position += null_bitmap_buf_size;
-    for (int column_id = 0; column_id < column_num; column_id++) {
-        auto& column_type = column_types[column_id];
-        int column_byte_width = 0;
-        data_item.data_values[column_id].type_name = column_type.type_name;
+int RecordManager::dataItemLength(const std::vector<ColumnType>& column_types,
+                                  int null_bitmap_size) {
+    // return byte length
+    int length = 4 + null_bitmap_size, tmp_length;
+    for (auto& column_type : column_types) {
         switch (column_type.type_name) {
             case INT:
             case FLOAT:
             case DATE:
-                column_byte_width = getDataTypeSize(column_type.type_name);
+                length += getDataTypeSize(column_type.type_name);
                 break;
             case VARCHAR:
-                column_byte_width = column_type.varchar_space + 2;
+                tmp_length =
+                    2 + column_type.varchar_space * getDataTypeSize(VARCHAR);
+                tmp_length += tmp_length % 4 == 0 ? 0 : 4 - tmp_length % 4;
+                length += tmp_length;
                 break;
         }
-        if (!data_item.data_values[column_id].is_null) {
-            int varchar_length = 0;
-            switch (column_type.type_name) {
+    }
+    return length;
+}
+
+int RecordManager::slotLength(const std::vector<ColumnType>& column_types,
+                              int null_bitmap_buf_size, int record_format) {
+    if (record_format == RECORD_FORMAT_SLOTTED) {
+        // 变长格式返回记录的最小长度, 每页的槽数以此为上界
+        int length = (1 + null_bitmap_buf_size) * BYTE_PER_BUF;
+        for (auto& column_type : column_types) {
+            length += column_type.type_name == VARCHAR
+                          ? varcharFieldLength(0)
+                          : getDataTypeSize(column_type.type_name);
+        }
+        return length;
+    }
+    int length =
+        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+    // 旧格式的槽是实际长度的两倍, PAX 格式的槽数与紧凑格式相同
+    return record_format == RECORD_FORMAT_COMPACT ||
+                   record_format == RECORD_FORMAT_PAX
+               ? length
+               : length * 2;
+}
+
+DataItem RecordManager::readSlotItem(int file_id, int page_id, BufType& b,
+                                     int slot_id, RecordView& view) {
+    DataItem data_item;
+    view.reset(b, slot_id);
+    view.materialize(data_item);
+    if (view.hasOverflow()) {
+        // 溢出页最后再读, 读之前不能换出当前页
+        std::vector<std::pair<int, int>> overflow_columns;
+        for (int i = 0; i < view.columnNum(); i++) {
+            if (view.isOverflow(i))
+                overflow_columns.push_back(
+                    std::make_pair(i, view.overflowPage(i)));
+        }
+        for (auto& overflow_column : overflow_columns) {
+            readOverflow(
+                file_id, overflow_column.second,
+                data_item.data_values[overflow_column.first].value.char_value);
+        }
+        // 调用者还要继续读当前页
+        int index;
+        b = bpm->getPage(file_id, page_id, index);
+        bpm->access(index);
+    }
+    return data_item;
+}
+
+int RecordManager::varcharFieldLength(int varchar_length) {
+    int length = 2 + varchar_length;
+    length += length % 4 == 0 ? 0 : 4 - length % 4;
+    // 至少能放下溢出页号, 更新时全部移入溢出页一定放得下
+    return std::max(length, 8);
+}
+
+int RecordManager::encodeSlottedItem(
+    int file_id, BufType record, int record_id, int null_bitmap_buf_size,
+    const DataItem& data_item, const std::vector<ColumnType>& column_types,
+    int max_length) {
+    int column_num = column_types.size();
+    std::vector<int> widths(column_num);
+    std::vector<bool> overflow(column_num, false);
+    int length = (1 + null_bitmap_buf_size) * BYTE_PER_BUF;
+    for (int column_id = 0; column_id < column_num; column_id++) {
+        auto& data_value = data_item.data_values[column_id];
+        if (column_types[column_id].type_name == VARCHAR) {
+            widths[column_id] = varcharFieldLength(
+                data_value.is_null ? 0 : data_value.value.char_value.size());
+        } else {
+            widths[column_id] =
+                getDataTypeSize(column_types[column_id].type_name);
+        }
+        length += widths[column_id];
+    }
+    // 放不下时把最长的 VARCHAR 依次移入溢出页
+    while (length > max_length) {
+        int longest = -1;
+        for (int column_id = 0; column_id < column_num; column_id++) {
+            if (overflow[column_id] || widths[column_id] <= 8) continue;
+            if (longest == -1 || widths[column_id] > widths[longest])
+                longest = column_id;
+        }
+        assert(longest != -1);
+        overflow[longest] = true;
+        length -= widths[longest] - 8;
+        widths[longest] = 8;
+    }
+
+    memset(record, 0, length);
+    record[0] = record_id;
+    for (int column_id = 0; column_id < column_num; column_id++) {
+        utils::setBitFromNum(record[1 + (column_id >> LOG_BIT_PER_BUF)],
+                             column_id & BIT_PER_BUF_MASK,
+                             data_item.data_values[column_id].is_null);
+    }
+    int buf_position = 1 + null_bitmap_buf_size;
+    for (int column_id = 0; column_id < column_num; column_id++) {
+        auto& data_value = data_item.data_values[column_id];
+        if (!data_value.is_null) {
+            auto& char_value = data_value.value.char_value;
+            switch (column_types[column_id].type_name) {
                 case INT:
-                    data_item.data_values[column_id].value.int_value =
-                        utils::bit322int(b[start_buf_position]);
+                    record[buf_position] =
+                        utils::int2bit32(data_value.value.int_value);
                     break;
                 case FLOAT:
-                    data_item.data_values[column_id].value.float_value =
-                        utils::bit322float(b[start_buf_position],
-                                           b[start_buf_position + 1]);
+                    utils::float2bit32(data_value.value.float_value,
+                                       record[buf_position],
+                                       record[buf_position + 1]);
                     break;
                 case VARCHAR:
-                    varchar_length = utils::get2Bytes(b[start_buf_position], 0);
-                    data_item.data_values[column_id].value.char_value = "";
-                    buf_position = start_buf_position, buf_offset = 2;
-                    for (int i = 0; i < varchar_length; i++) {
-                        if (buf_offset == BYTE_PER_BUF) {
-                            buf_position++;
-                            buf_offset = 0;
-                        }
-                        data_item.data_values[column_id]
-                            .value.char_value.push_back(
-                                utils::get1Byte(b[buf_position], buf_offset++));
+                    if (overflow[column_id]) {
+                        utils::set2Bytes(record[buf_position], 0,
+                                         RECORD_VARCHAR_OVERFLOW);
+                        record[buf_position + 1] =
+                            writeOverflow(file_id, char_value);
+                    } else {
+                        utils::set2Bytes(record[buf_position], 0,
+                                         char_value.size());
+                        memcpy((char*)(record + buf_position) + 2,
+                               char_value.data(), char_value.size());
                     }
                     break;
                 case DATE:
-                    data_item.data_values[column_id].value.date_value.year =
-                        utils::get2Bytes(b[start_buf_position], 0);
-
-                    data_item.data_values[column_id].value.date_value.month =
-                        utils::get1Byte(b[start_buf_position], 2);
-                    data_item.data_values[column_id].value.date_value.day =
-                        utils::get1Byte(b[start_buf_position], 3);
+                    utils::set2Bytes(record[buf_position], 0,
+                                     data_value.value.date_value.year);
+                    utils::set1Byte(record[buf_position], 2,
+                                    data_value.value.date_value.month);
+                    utils::set1Byte(record[buf_position], 3,
+                                    data_value.value.date_value.day);
+                    break;
+                default:
                     break;
             }
         }
-        start_buf_position += column_byte_width / BYTE_PER_BUF;
+        buf_position += widths[column_id] / BYTE_PER_BUF;
     }
-    return data_item;
+    return length;
 }
 
-int RecordManager::dataItemLength(const std::vector<ColumnType>& column_types,
-                                  int null_bitmap_size) {
-    // return byte length
-    int length = 4 + null_bitmap_size, tmp_length;
-    for (auto& column_type : column_types) {
-        switch (column_type.type_name) {
-            case INT:
-            case FLOAT:
-            case DATE:
-                length += getDataTypeSize(column_type.type_name);
-                break;
-            case VARCHAR:
-                tmp_length =
-                    2 + column_type.varchar_space * getDataTypeSize(VARCHAR);
-                tmp_length += tmp_length % 4 == 0 ? 0 : 4 - tmp_length % 4;
-                length += tmp_length;
-                break;
+void RecordManager::getOverflowPages(
+    BufType b, int slot_id, int null_bitmap_buf_size,
+    const std::vector<ColumnType>& column_types, std::vector<int>& page_ids) {
+    RecordView view(column_types, null_bitmap_buf_size, RECORD_FORMAT_SLOTTED,
+                    0);
+    view.reset(b, slot_id);
+    if (!view.hasOverflow()) return;
+    for (int i = 0; i < view.columnNum(); i++) {
+        if (view.isOverflow(i)) page_ids.push_back(view.overflowPage(i));
+    }
+}
+
+void RecordManager::updateSlottedItem(
+    int file_id, const RecordLocation& record_location,
+    const DataItem& data_item, int null_bitmap_buf_size,
+    const std::vector<ColumnType>& column_types) {
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, record_location.page_id, index);
+    int entry = b[RECORD_SLOT_DIR_BUF + 1 + record_location.slot_id];
+    int old_length = utils::get2Bytes(entry, 1);
+    int slot_num = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 0);
+    // 原记录的空间也可以使用
+    int free_space =
+        slottedFreeSpace(b, RECORD_SLOT_DIR_BUF + 1 + slot_num) + old_length;
+    std::vector<int> overflow_page_ids;
+    getOverflowPages(b, record_location.slot_id, null_bitmap_buf_size,
+                     column_types, overflow_page_ids);
+    bpm->access(index);
+    for (int page_id : overflow_page_ids) freeOverflow(file_id, page_id);
+
+    unsigned int record[BUF_PER_PAGE];
+    int length = encodeSlottedItem(
+        file_id, record, data_item.data_id, null_bitmap_buf_size, data_item,
+        column_types, std::min(free_space, RECORD_SLOTTED_INLINE_MAX));
+    b = bpm->getPage(file_id, record_location.page_id, index);
+    if (length <= old_length) {
+        int offset = utils::get2Bytes(entry, 0);
+        memcpy((char*)b + offset, record, length);
+        utils::set2Bytes(b[RECORD_SLOT_DIR_BUF + 1 + record_location.slot_id],
+                         1, length);
+    } else {
+        utils::setBitFromBuf(b, record_location.slot_id, false);
+        writeSlottedItem(b, record_location.slot_id, record, length);
+    }
+    bpm->markDirty(index);
+}
+
+void RecordManager::initSlottedPage(BufType b) {
+    for (int i = 0; i < RECORD_PAGE_HEADER / BYTE_PER_BUF; i++) b[i] = 0;
+    b[RECORD_SLOT_DIR_BUF] = 0;
+    utils::set2Bytes(b[RECORD_SLOT_DIR_BUF], 1, PAGE_SIZE);
+}
+
+int RecordManager::slottedFreeSpace(BufType b, int dir_end) {
+    int slot_num = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 0);
+    int used = 0;
+    for (int i = 0; (i << LOG_BIT_PER_BUF) < slot_num; i++) {
+        unsigned int bits = b[i];
+        while (bits) {
+            int slot_id = (i << LOG_BIT_PER_BUF) + __builtin_ctz(bits);
+            bits &= bits - 1;
+            used += utils::get2Bytes(b[RECORD_SLOT_DIR_BUF + 1 + slot_id], 1);
         }
     }
-    length *= 2;
-    return length;
+    return PAGE_SIZE - dir_end * BYTE_PER_BUF - used;
+}
+
+int RecordManager::findSlottedSlot(BufType b, int length) {
+    int slot_num = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 0);
+    int slot_id = findFreeSlot(b, slot_num);
+    int dir_end = RECORD_SLOT_DIR_BUF + 1 + slot_num;
+    if (slot_id == -1) {
+        // 没有可复用的槽, 目录需要多一项
+        if (slot_num == MAX_ITEM_PER_PAGE) return -1;
+        slot_id = slot_num;
+        dir_end++;
+    }
+    return length <= slottedFreeSpace(b, dir_end) ? slot_id : -1;
+}
+
+void RecordManager::writeSlottedItem(BufType b, int slot_id, BufType record,
+                                     int length) {
+    int slot_num = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 0);
+    if (slot_id >= slot_num) {
+        slot_num = slot_id + 1;
+        utils::set2Bytes(b[RECORD_SLOT_DIR_BUF], 0, slot_num);
+    }
+    int free_end = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 1);
+    int dir_end = (RECORD_SLOT_DIR_BUF + 1 + slot_num) * BYTE_PER_BUF;
+    // 连续的空间不够时整理页内空间
+    if (free_end - dir_end < length) free_end = defragSlottedPage(b);
+    assert(free_end - dir_end >= length);
+    free_end -= length;
+    memcpy((char*)b + free_end, record, length);
+    unsigned int& entry = b[RECORD_SLOT_DIR_BUF + 1 + slot_id];
+    utils::set2Bytes(entry, 0, free_end);
+    utils::set2Bytes(entry, 1, length);
+    utils::set2Bytes(b[RECORD_SLOT_DIR_BUF], 1, free_end);
+    utils::setBitFromBuf(b, slot_id, true);
+}
+
+int RecordManager::defragSlottedPage(BufType b) {
+    unsigned int page[BUF_PER_PAGE];
+    int slot_num = utils::get2Bytes(b[RECORD_SLOT_DIR_BUF], 0);
+    int free_end = PAGE_SIZE;
+    for (int slot_id = 0; slot_id < slot_num; slot_id++) {
+        if (!utils::getBitFromBuf(b, slot_id)) continue;
+        unsigned int& entry = b[RECORD_SLOT_DIR_BUF + 1 + slot_id];
+        int length = utils::get2Bytes(entry, 1);
+        free_end -= length;
+        memcpy((char*)page + free_end,
+               (char*)b + utils::get2Bytes(entry, 0), length);
+        utils::set2Bytes(entry, 0, free_end);
+    }
+    memcpy((char*)b + free_end, (char*)page + free_end, PAGE_SIZE - free_end);
+    utils::set2Bytes(b[RECORD_SLOT_DIR_BUF], 1, free_end);
+    return free_end;
+}
+
+int RecordManager::allocOverflowPage(int file_id) {
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, 0, index);
+    int page_id = b[RECORD_OVERFLOW_LIST_BUF];
+    if (page_id == -1) {
+        // 没有空闲的溢出页, 追加一页
+        page_id = ++b[5];
+        bpm->markDirty(index);
+        return page_id;
+    }
+    bpm->access(index);
+    b = bpm->getPage(file_id, page_id, index);
+    int next_page_id = b[RECORD_SLOT_DIR_BUF];
+    bpm->access(index);
+    b = bpm->getPage(file_id, 0, index);
+    b[RECORD_OVERFLOW_LIST_BUF] = next_page_id;
+    bpm->markDirty(index);
+    return page_id;
+}
+
+int RecordManager::writeOverflow(int file_id, std::string_view value) {
+    int capacity = PAGE_SIZE - RECORD_OVERFLOW_HEADER;
+    int page_num = (value.size() + capacity - 1) / capacity;
+    std::vector<int> page_ids;
+    for (int i = 0; i < page_num; i++)
+        page_ids.push_back(allocOverflowPage(file_id));
+    BufType b;
+    int index;
+    for (int i = 0; i < page_num; i++) {
+        int offset = i * capacity;
+        int length = std::min(capacity, (int)value.size() - offset);
+        b = bpm->getPage(file_id, page_ids[i], index);
+        for (int j = 0; j < RECORD_PAGE_HEADER / BYTE_PER_BUF; j++) b[j] = 0;
+        b[RECORD_FREE_LINK_BUF] = RECORD_OVERFLOW_PAGE;
+        b[RECORD_SLOT_DIR_BUF] = i + 1 < page_num ? page_ids[i + 1] : -1;
+        b[RECORD_SLOT_DIR_BUF + 1] = length;
+        memcpy((char*)b + RECORD_OVERFLOW_HEADER, value.data() + offset,
+               length);
+        bpm->markDirty(index);
+    }
+    return page_ids[0];
+}
+
+void RecordManager::readOverflow(int file_id, int page_id,
+                                 SmallString& value) {
+    BufType b;
+    int index;
+    value.clear();
+    while (page_id != -1) {
+        b = bpm->getPage(file_id, page_id, index);
+        bpm->access(index);
+        value.append((char*)b + RECORD_OVERFLOW_HEADER,
+                     b[RECORD_SLOT_DIR_BUF + 1]);
+        page_id = b[RECORD_SLOT_DIR_BUF];
+    }
+}
+
+void RecordManager::freeOverflow(int file_id, int page_id) {
+    BufType b;
+    int index;
+    while (page_id != -1) {
+        b = bpm->getPage(file_id, page_id, index);
+        int next_page_id = b[RECORD_SLOT_DIR_BUF];
+        bpm->access(index);
+        b = bpm->getPage(file_id, 0, index);
+        int head = b[RECORD_OVERFLOW_LIST_BUF];
+        b[RECORD_OVERFLOW_LIST_BUF] = page_id;
+        bpm->markDirty(index);
+        b = bpm->getPage(file_id, page_id, index);
+        b[RECORD_SLOT_DIR_BUF] = head;
+        bpm->markDirty(index);
+        page_id = next_page_id;
+    }
 }
 
 bool RecordManager::deleteRecordFile(const char* file_path) {
     closeFileIfExist(file_path);
     cleanColumnTypesIfExist(file_path);
+    dropZoneMap(file_path);
     if (!fm->existFile(file_path)) return false;
     return fm->deleteFile(file_path);
 }
@@ -805,6 +1394,17 @@ void RecordManager::sortDataItem(const std::vector<ColumnType>& column_types,
     data_item.column_ids = sorted_column_ids;
 }
 
+int RecordManager::getColumnSlotNum(const char* file_path) {
+    int file_id = openFile(file_path);
+    assert(file_id != -1);
+    BufType b;
+    int index;
+    b = bpm->getPage(file_id, 0, index);
+    int column_slot_num = b[4];
+    bpm->access(index);
+    return column_slot_num;
+}
+
 int RecordManager::getTotalPageNum(const char* file_path) {
     int file_id = openFile(file_path);
     assert(file_id != -1);
@@ -831,22 +1431,25 @@ void RecordManager::getRecordsInPageRange(const char* file_path,
     b = bpm->getPage(file_id, 0, index);
     int page_num = b[5];
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
     bpm->access(index);
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
     int data_item_per_page = std::min(
         (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
+    RecordView view(column_types, null_bitmap_buf_size, record_format,
+                    data_item_length);
 
     for (int page_id = low_page; page_id < upper_page; page_id++) {
+        if ((page_id - low_page) % READ_AHEAD_PAGES == 0)
+            bpm->prefetch(file_id, page_id,
+                          std::min(READ_AHEAD_PAGES, upper_page - page_id));
         b = bpm->getPage(file_id, page_id, index);
         bpm->access(index);
         for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
             if (!utils::getBitFromBuf(b, slot_id)) continue;
             data_items.push_back(
-                getSlotItem(b, slot_id,
-                            dataItemLength(column_types,
-                                           null_bitmap_buf_size * BYTE_PER_BUF),
-                            null_bitmap_buf_size, column_types));
+                readSlotItem(file_id, page_id, b, slot_id, view));
         }
     }
 }
@@ -867,81 +1470,186 @@ void RecordManager::getAllRecords(
     b = bpm->getPage(file_id, 0, index);
     int page_num = b[5];
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
     bpm->access(index);
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
     int data_item_per_page = std::min(
         (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
+    RecordView view(column_types, null_bitmap_buf_size, record_format,
+                    data_item_length);
 
     for (int page_id = 1; page_id <= page_num; page_id++) {
+        if ((page_id - 1) % READ_AHEAD_PAGES == 0)
+            bpm->prefetch(file_id, page_id,
+                          std::min(READ_AHEAD_PAGES, page_num - page_id + 1));
         b = bpm->getPage(file_id, page_id, index);
         bpm->access(index);
         for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
             if (!utils::getBitFromBuf(b, slot_id)) continue;
             data_items.push_back(
-                getSlotItem(b, slot_id,
-                            dataItemLength(column_types,
-                                           null_bitmap_buf_size * BYTE_PER_BUF),
-                            null_bitmap_buf_size, column_types));
+                readSlotItem(file_id, page_id, b, slot_id, view));
             record_locations.push_back(RecordLocation{page_id, slot_id});
         }
     }
 }
 
-int RecordManager::getAllRecordWithConstraintSaveFile(
-    const char* file_path, const char* file_path_save,
-    const std::vector<system::SearchConstraint>& constraints) {
+int RecordManager::prefetchPages(int file_id, int page_id, int page_num,
+                                 const std::vector<bool>* skip_pages) {
+    int last_page = std::min(page_id + READ_AHEAD_PAGES - 1, page_num);
+    if (skip_pages == nullptr) {
+        bpm->prefetch(file_id, page_id, last_page - page_id + 1);
+        return last_page;
+    }
+    // 只预读不跳过的连续页
+    int start = page_id;
+    for (int p = page_id; p <= last_page + 1; p++) {
+        if (p <= last_page && !(*skip_pages)[p]) continue;
+        if (p > start) bpm->prefetch(file_id, start, p - start);
+        start = p + 1;
+    }
+    return last_page;
+}
+
+ZoneMap* RecordManager::findZoneMap(const char* file_path) {
+    auto it = zone_maps.find(file_path);
+    if (it == zone_maps.end()) return nullptr;
+    it->second.last_use = ++zone_map_timestamp;
+    return &it->second.zone_map;
+}
+
+ZoneMap* RecordManager::resetZoneMap(
+    const char* file_path, const std::vector<ColumnType>& column_types) {
+    zone_maps.erase(file_path);
+    if (zone_maps.size() >= zone_map_capacity) {
+        auto oldest = zone_maps.begin();
+        for (auto it = zone_maps.begin(); it != zone_maps.end(); it++)
+            if (it->second.last_use < oldest->second.last_use) oldest = it;
+        zone_maps.erase(oldest);
+    }
+    ZoneMapEntry entry{ZoneMap(column_types), ++zone_map_timestamp};
+    return &zone_maps.emplace(file_path, std::move(entry))
+                .first->second.zone_map;
+}
+
+void RecordManager::dropZoneMap(const char* file_path) {
+    zone_maps.erase(file_path);
+}
+
+void RecordManager::scanWithConstraint(
+    const char* file_path,
+    const std::vector<system::SearchConstraint>& constraints,
+    const std::function<void(const RecordView&, DataItem*,
+                             const RecordLocation&)>& on_match) {
     int file_id = openFile(file_path);
     assert(file_id != -1);
 
     std::vector<ColumnType> column_types;
     getColumnTypes(file_path, column_types);
 
-    std::ofstream outputFile(file_path_save);
-    if (!outputFile.is_open()) {
-        std::cerr << "Error opening file!" << std::endl;
-        return 0;
-    }
-
-    int cnt = 0;
     BufType b;
     int index;
     b = bpm->getPage(file_id, 0, index);
     int page_num = b[5];
     int null_bitmap_buf_size = b[7];
+    int record_format = getRecordFormat(b);
     bpm->access(index);
     int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
+        slotLength(column_types, null_bitmap_buf_size, record_format);
     int data_item_per_page = std::min(
         (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
+    RecordView view(column_types, null_bitmap_buf_size, record_format,
+                    data_item_length);
+    RecordFilter filter(constraints, view);
+    unsigned int selection[MAX_ITEM_PER_PAGE / BIT_PER_BUF];
+    // 有页摘要时跳过不可能满足约束的页, 没有时在这次扫描中建立
+    ZoneMap* zone_map = filter.empty() ? nullptr : findZoneMap(file_path);
+    bool build_zone_map = !filter.empty() && zone_map == nullptr;
+    ZoneMap building(column_types);
+    std::vector<bool> skip_pages;
+    if (zone_map != nullptr) {
+        skip_pages.resize(page_num + 1);
+        for (int page_id = 1; page_id <= page_num; page_id++)
+            skip_pages[page_id] = !filter.mayMatchPage(*zone_map, page_id);
+    }
 
+    int prefetched_page = 0;
     for (int page_id = 1; page_id <= page_num; page_id++) {
+        if (zone_map != nullptr && skip_pages[page_id]) continue;
+        if (page_id > prefetched_page)
+            prefetched_page =
+                prefetchPages(file_id, page_id, page_num,
+                              zone_map != nullptr ? &skip_pages : nullptr);
         b = bpm->getPage(file_id, page_id, index);
         bpm->access(index);
-        for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
-            if (!utils::getBitFromBuf(b, slot_id)) continue;
-            auto data_item =
-                getSlotItem(b, slot_id,
-                            dataItemLength(column_types,
-                                           null_bitmap_buf_size * BYTE_PER_BUF),
-                            null_bitmap_buf_size, column_types);
-            bool valid = true;
-            for (auto& constraint : constraints) {
-                if (!system::validConstraint(constraint, data_item)) {
-                    valid = false;
-                    break;
-                }
+        if (build_zone_map) {
+            for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
+                if (!utils::getBitFromBuf(b, slot_id)) continue;
+                view.reset(b, slot_id);
+                building.add(page_id, view);
             }
-            if (valid) {
-                for (int i = 0; i < data_item.data_values.size() - 1; i++) {
-                    outputFile << data_item.data_values[i].toString() << ",";
+        }
+        // 先对整页批量检查定长列的条件, 剩下的槽再逐行检查
+        memcpy(selection, b, sizeof(selection));
+        filter.filterPage(b, data_item_per_page, selection);
+        for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
+            if (!utils::getBitFromBuf(selection, slot_id)) continue;
+            view.reset(b, slot_id);
+            if (view.hasOverflow()) {
+                // 溢出的 VARCHAR 不在当前页上, 读出整条记录再检查
+                auto data_item =
+                    readSlotItem(file_id, page_id, b, slot_id, view);
+                bool valid = true;
+                for (auto& constraint : constraints) {
+                    if (!system::validConstraint(constraint, data_item)) {
+                        valid = false;
+                        break;
+                    }
                 }
-                outputFile << data_item.data_values.back().toString();
-                outputFile << std::endl;
-                cnt++;
+                if (!valid) continue;
+                on_match(view, &data_item, RecordLocation{page_id, slot_id});
+            } else {
+                if (!filter.matchRemaining(view)) continue;
+                on_match(view, nullptr, RecordLocation{page_id, slot_id});
             }
         }
     }
+    if (build_zone_map)
+        *resetZoneMap(file_path, column_types) = std::move(building);
+}
+
+int RecordManager::getAllRecordWithConstraintSaveFile(
+    const char* file_path, const char* file_path_save,
+    const std::vector<system::SearchConstraint>& constraints) {
+    std::ofstream outputFile(file_path_save);
+    if (!outputFile.is_open()) {
+        std::cerr << "Error opening file!" << std::endl;
+        return 0;
+    }
+
+    int cnt = 0;
+    std::string line;
+    scanWithConstraint(
+        file_path, constraints,
+        [&](const RecordView& view, DataItem* data_item,
+            const RecordLocation&) {
+            line.clear();
+            if (data_item != nullptr) {
+                for (size_t i = 0; i < data_item->data_values.size(); i++) {
+                    if (i > 0) line.push_back(',');
+                    line += data_item->data_values[i].toString();
+                }
+            } else {
+                // 直接从页上写出, 不生成 DataItem
+                for (int i = 0; i < view.columnNum(); i++) {
+                    if (i > 0) line.push_back(',');
+                    view.appendString(i, line);
+                }
+            }
+            line.push_back('\n');
+            outputFile << line;
+            cnt++;
+        });
     outputFile.close();
     return cnt;
 }
@@ -949,49 +1657,26 @@ int RecordManager::getAllRecordWithConstraintSaveFile(
 void RecordManager::getAllRecordWithConstraint(
     const char* file_path, std::vector<DataItem>& data_items,
     std::vector<RecordLocation>& record_locations,
-    const std::vector<system::SearchConstraint>& constraints) {
+    const std::vector<system::SearchConstraint>& constraints,
+    const std::vector<int>* output_column_ids) {
     data_items.clear();
     record_locations.clear();
-    int file_id = openFile(file_path);
-    assert(file_id != -1);
-
-    std::vector<ColumnType> column_types;
-    getColumnTypes(file_path, column_types);
-
-    BufType b;
-    int index;
-    b = bpm->getPage(file_id, 0, index);
-    int page_num = b[5];
-    int null_bitmap_buf_size = b[7];
-    bpm->access(index);
-    int data_item_length =
-        dataItemLength(column_types, null_bitmap_buf_size * BYTE_PER_BUF);
-    int data_item_per_page = std::min(
-        (PAGE_SIZE - RECORD_PAGE_HEADER) / data_item_length, MAX_ITEM_PER_PAGE);
-
-    for (int page_id = 1; page_id <= page_num; page_id++) {
-        b = bpm->getPage(file_id, page_id, index);
-        bpm->access(index);
-        for (int slot_id = 0; slot_id < data_item_per_page; slot_id++) {
-            if (!utils::getBitFromBuf(b, slot_id)) continue;
-            auto data_item =
-                getSlotItem(b, slot_id,
-                            dataItemLength(column_types,
-                                           null_bitmap_buf_size * BYTE_PER_BUF),
-                            null_bitmap_buf_size, column_types);
-            bool valid = true;
-            for (auto& constraint : constraints) {
-                if (!system::validConstraint(constraint, data_item)) {
-                    valid = false;
-                    break;
-                }
-            }
-            if (valid) {
-                data_items.push_back(data_item);
-                record_locations.push_back(RecordLocation{page_id, slot_id});
+    scanWithConstraint(
+        file_path, constraints,
+        [&](const RecordView& view, DataItem* data_item,
+            const RecordLocation& location) {
+            if (data_item != nullptr) {
+                data_items.push_back(std::move(*data_item));
+            } else {
+                // 只有满足约束的记录才读出, 指定了输出列时只读这些列
+                data_items.emplace_back();
+                if (output_column_ids != nullptr)
+                    view.materialize(*output_column_ids, data_items.back());
+                else
+                    view.materialize(data_items.back());
             }
-        }
-    }
+            record_locations.push_back(location);
+        });
 }
 }  // namespace record
 }  // namespace dbs
\ No newline at end of file
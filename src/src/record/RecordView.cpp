@@ -0,0 +1,179 @@
+#include "record/RecordView.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace dbs {
+namespace record {
+
+RecordView::RecordView(const std::vector<ColumnType>& column_types_,
+                       int null_bitmap_buf_size_, int record_format_,
+                       int slot_length_)
+    : column_types(column_types_),
+      null_bitmap_buf_size(null_bitmap_buf_size_),
+      slotted(record_format_ == RECORD_FORMAT_SLOTTED),
+      slot_length(slot_length_),
+      has_overflow(false),
+      record(nullptr),
+      row(0),
+      offsets(column_types_.size()),
+      strides(column_types_.size()),
+      id_stride(0),
+      null_offset(1),
+      null_stride(0) {
+    if (slotted) return;
+    // 每个字段的位置与 RecordManager::setSlotItem 一致
+    int slot_buf_num = slot_length / BYTE_PER_BUF;
+    bool pax = record_format_ == RECORD_FORMAT_PAX;
+    int row_num = std::min((PAGE_SIZE - RECORD_PAGE_HEADER) / slot_length,
+                           MAX_ITEM_PER_PAGE);
+    // 定长格式的记录连续存放, 字段的间隔都是槽长;
+    // PAX 格式的字段各自连续存放, 间隔为字段的宽度
+    id_stride = pax ? 1 : slot_buf_num;
+    null_offset = pax ? row_num : 1;
+    null_stride = pax ? null_bitmap_buf_size : slot_buf_num;
+    int buf_position = null_offset + (pax ? row_num * null_bitmap_buf_size
+                                          : null_bitmap_buf_size);
+    for (int i = 0; i < (int)column_types.size(); i++) {
+        int width = (column_types[i].type_name == VARCHAR
+                         ? column_types[i].varchar_space + 2
+                         : getDataTypeSize(column_types[i].type_name)) /
+                    BYTE_PER_BUF;
+        offsets[i] = buf_position;
+        strides[i] = pax ? width : slot_buf_num;
+        buf_position += pax ? width * row_num : width;
+    }
+}
+
+void RecordView::reset(BufType b, int slot_id) {
+    if (!slotted) {
+        record = b + RECORD_PAGE_HEADER / BYTE_PER_BUF;
+        row = slot_id;
+        return;
+    }
+    record = b + utils::get2Bytes(b[RECORD_SLOT_DIR_BUF + 1 + slot_id], 0) /
+                     BYTE_PER_BUF;
+    // 变长格式中 VARCHAR 的长度决定后面各列的位置
+    has_overflow = false;
+    int buf_position = 1 + null_bitmap_buf_size;
+    for (int i = 0; i < (int)column_types.size(); i++) {
+        offsets[i] = buf_position;
+        if (column_types[i].type_name != VARCHAR) {
+            buf_position +=
+                getDataTypeSize(column_types[i].type_name) / BYTE_PER_BUF;
+            continue;
+        }
+        int varchar_length =
+            isNull(i) ? 0 : utils::get2Bytes(record[buf_position], 0);
+        if (varchar_length == RECORD_VARCHAR_OVERFLOW) {
+            has_overflow = true;
+            varchar_length = 0;
+        }
+        // 与 RecordManager::varcharFieldLength 一致
+        int length = 2 + varchar_length;
+        length += length % 4 == 0 ? 0 : 4 - length % 4;
+        buf_position += std::max(length, 8) / BYTE_PER_BUF;
+    }
+}
+
+int RecordView::columnIndex(int column_id) const {
+    for (int i = 0; i < (int)column_types.size(); i++) {
+        if (column_types[i].column_id == column_id) return i;
+    }
+    return -1;
+}
+
+bool RecordView::isOverflow(int column_index) const {
+    return slotted && column_types[column_index].type_name == VARCHAR &&
+           !isNull(column_index) &&
+           utils::get2Bytes(record[position(column_index)], 0) ==
+               RECORD_VARCHAR_OVERFLOW;
+}
+
+DateValue RecordView::getDate(int column_index) const {
+    unsigned int b = record[position(column_index)];
+    return DateValue(utils::get2Bytes(b, 0), utils::get1Byte(b, 2),
+                     utils::get1Byte(b, 3));
+}
+
+DataValue RecordView::getValue(int column_index) const {
+    DataTypeName type_name = column_types[column_index].type_name;
+    if (isNull(column_index)) return DataValue(type_name, true);
+    switch (type_name) {
+        case INT:
+            return DataValue(type_name, false, getInt(column_index));
+        case FLOAT:
+            return DataValue(type_name, false, getFloat(column_index));
+        case VARCHAR:
+            if (isOverflow(column_index)) return DataValue(type_name, false);
+            return DataValue(type_name, false,
+                             std::string(getVarchar(column_index)));
+        case DATE:
+            return DataValue(type_name, false, getDate(column_index));
+        default:
+            return DataValue(type_name, true);
+    }
+}
+
+void RecordView::materialize(DataItem& data_item) const {
+    int column_num = column_types.size();
+    data_item.data_id = dataId();
+    data_item.data_values.resize(column_num);
+    data_item.column_ids.resize(column_num);
+    for (int i = 0; i < column_num; i++) {
+        data_item.data_values[i] = getValue(i);
+        data_item.column_ids[i] = column_types[i].column_id;
+    }
+}
+
+void RecordView::materialize(const std::vector<int>& column_ids,
+                             DataItem& data_item) const {
+    data_item.data_id = dataId();
+    data_item.data_values.clear();
+    data_item.column_ids.clear();
+    for (int column_id : column_ids) {
+        int column_index = columnIndex(column_id);
+        if (column_index == -1) continue;
+        data_item.data_values.push_back(getValue(column_index));
+        data_item.column_ids.push_back(column_id);
+    }
+}
+
+void RecordView::appendString(int column_index, std::string& output) const {
+    if (isNull(column_index)) {
+        output += "NULL";
+        return;
+    }
+    char buf[64];
+    int length = 0;
+    switch (column_types[column_index].type_name) {
+        case INT:
+            length = snprintf(buf, sizeof(buf), "%d", getInt(column_index));
+            break;
+        case FLOAT:
+            // 与 DataValue::toString 一样保留小数点后两位
+            length =
+                snprintf(buf, sizeof(buf), "%.2f", getFloat(column_index));
+            break;
+        case VARCHAR:
+            output += getVarchar(column_index);
+            return;
+        case DATE: {
+            DateValue date = getDate(column_index);
+            length = snprintf(buf, sizeof(buf), "%d-%d-%d", date.year,
+                              date.month, date.day);
+            break;
+        }
+        default:
+            return;
+    }
+    // 超大的浮点数写不进 buf 时退回 DataValue::toString
+    if (length >= (int)sizeof(buf)) {
+        output += getValue(column_index).toString();
+        return;
+    }
+    output.append(buf, length);
+}
+
+}  // namespace record
+}  // namespace dbs
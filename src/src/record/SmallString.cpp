@@ -0,0 +1,63 @@
+#include "record/SmallString.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dbs {
+namespace record {
+
+static const uint32_t HEAP_FLAG = 0x80000000U;
+
+void SmallString::assign(const char* value, size_t length) {
+    if (length <= INLINE_CAPACITY) {
+        // value 可能指向自己的堆内存, 先复制出来再释放
+        char buf[INLINE_CAPACITY];
+        if (length > 0) memcpy(buf, value, length);
+        if (!isInline()) delete[] storage.heap.data;
+        if (length > 0) memcpy(storage.inline_data, buf, length);
+        setInlineSize(length);
+        return;
+    }
+    if (!isInline() && (storage.heap.capacity & ~HEAP_FLAG) >= length) {
+        memmove(storage.heap.data, value, length);
+        storage.heap.data[length] = '\0';
+        storage.heap.size = length;
+        return;
+    }
+    char* data = new char[length + 1];
+    memcpy(data, value, length);
+    data[length] = '\0';
+    if (!isInline()) delete[] storage.heap.data;
+    storage.heap.data = data;
+    storage.heap.size = length;
+    storage.heap.capacity = length | HEAP_FLAG;
+}
+
+void SmallString::append(const char* value, size_t length) {
+    size_t old_size = size();
+    size_t new_size = old_size + length;
+    if (new_size <= INLINE_CAPACITY) {
+        memmove(storage.inline_data + old_size, value, length);
+        setInlineSize(new_size);
+        return;
+    }
+    if (!isInline() && (storage.heap.capacity & ~HEAP_FLAG) >= new_size) {
+        memmove(storage.heap.data + old_size, value, length);
+        storage.heap.data[new_size] = '\0';
+        storage.heap.size = new_size;
+        return;
+    }
+    // 按两倍扩容, 读溢出页时会多次追加
+    size_t capacity = std::max(new_size, old_size * 2);
+    char* data = new char[capacity + 1];
+    memcpy(data, this->data(), old_size);
+    memcpy(data + old_size, value, length);
+    data[new_size] = '\0';
+    if (!isInline()) delete[] storage.heap.data;
+    storage.heap.data = data;
+    storage.heap.size = new_size;
+    storage.heap.capacity = capacity | HEAP_FLAG;
+}
+
+}  // namespace record
+}  // namespace dbs
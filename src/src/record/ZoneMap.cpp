@@ -0,0 +1,165 @@
+#include "record/ZoneMap.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "record/FilterKernels.hpp"
+
+namespace dbs {
+namespace record {
+
+ZoneMap::ZoneMap(const std::vector<ColumnType>& column_types)
+    : summary_num(0) {
+    for (auto& column_type : column_types) {
+        type_names.push_back(column_type.type_name);
+        bool fixed = column_type.type_name == INT ||
+                     column_type.type_name == FLOAT ||
+                     column_type.type_name == DATE;
+        summary_index.push_back(fixed ? summary_num++ : -1);
+    }
+}
+
+double ZoneMap::orderKey(const DataValue& value) {
+    switch (value.type_name) {
+        case INT:
+            return value.value.int_value;
+        case FLOAT:
+            return value.value.float_value;
+        case DATE: {
+            auto& date = value.value.date_value;
+            return dateOrderKey(date.year, date.month, date.day);
+        }
+        default:
+            return 0;
+    }
+}
+
+ZoneMap::ColumnSummary* ZoneMap::pageSummary(int page_id) {
+    if (page_id >= (int)row_nums.size()) {
+        // 新的页没有记录, 最小值为正无穷, 最大值为负无穷
+        ColumnSummary empty{std::numeric_limits<double>::infinity(),
+                            -std::numeric_limits<double>::infinity(), 0,
+                            false};
+        row_nums.resize(page_id + 1, 0);
+        summaries.resize((page_id + 1) * summary_num, empty);
+    }
+    return summaries.data() + page_id * summary_num;
+}
+
+const ZoneMap::ColumnSummary* ZoneMap::findPageSummary(int page_id) const {
+    if (page_id >= (int)row_nums.size()) return nullptr;
+    return summaries.data() + page_id * summary_num;
+}
+
+void ZoneMap::addValue(ColumnSummary& summary, double key) {
+    if (std::isnan(key)) {
+        summary.has_nan = true;
+        return;
+    }
+    summary.min = std::min(summary.min, key);
+    summary.max = std::max(summary.max, key);
+}
+
+void ZoneMap::add(int page_id, const DataItem& data_item) {
+    auto page = pageSummary(page_id);
+    row_nums[page_id]++;
+    for (int i = 0; i < (int)summary_index.size(); i++) {
+        if (summary_index[i] == -1) continue;
+        auto& summary = page[summary_index[i]];
+        auto& value = data_item.data_values[i];
+        if (value.is_null)
+            summary.null_num++;
+        else
+            addValue(summary, orderKey(value));
+    }
+}
+
+void ZoneMap::add(int page_id, const RecordView& view) {
+    auto page = pageSummary(page_id);
+    row_nums[page_id]++;
+    for (int i = 0; i < (int)summary_index.size(); i++) {
+        if (summary_index[i] == -1) continue;
+        auto& summary = page[summary_index[i]];
+        if (view.isNull(i)) {
+            summary.null_num++;
+            continue;
+        }
+        switch (type_names[i]) {
+            case INT:
+                addValue(summary, view.getInt(i));
+                break;
+            case FLOAT:
+                addValue(summary, view.getFloat(i));
+                break;
+            default: {
+                DateValue date = view.getDate(i);
+                addValue(summary,
+                         dateOrderKey(date.year, date.month, date.day));
+                break;
+            }
+        }
+    }
+}
+
+void ZoneMap::remove(int page_id, const DataItem& data_item) {
+    auto page = pageSummary(page_id);
+    row_nums[page_id]--;
+    for (int i = 0; i < (int)summary_index.size(); i++) {
+        if (summary_index[i] != -1 && data_item.data_values[i].is_null)
+            page[summary_index[i]].null_num--;
+    }
+}
+
+void ZoneMap::remove(int page_id, const RecordView& view) {
+    auto page = pageSummary(page_id);
+    row_nums[page_id]--;
+    for (int i = 0; i < (int)summary_index.size(); i++) {
+        if (summary_index[i] != -1 && view.isNull(i))
+            page[summary_index[i]].null_num--;
+    }
+}
+
+bool ZoneMap::empty(int page_id) const {
+    return page_id < (int)row_nums.size() && row_nums[page_id] == 0;
+}
+
+bool ZoneMap::mayMatchNull(int page_id, int column_index, bool is_null) const {
+    auto page = findPageSummary(page_id);
+    if (page == nullptr || summary_index[column_index] == -1) return true;
+    int null_num = page[summary_index[column_index]].null_num;
+    return is_null ? null_num > 0 : null_num < row_nums[page_id];
+}
+
+bool ZoneMap::mayMatch(int page_id, int column_index,
+                       system::ConstraintType constraint_type,
+                       const DataValue& value) const {
+    auto page = findPageSummary(page_id);
+    if (page == nullptr || summary_index[column_index] == -1) return true;
+    auto& summary = page[summary_index[column_index]];
+    double key = orderKey(value);
+    if (summary.has_nan || std::isnan(key)) return true;
+    // null 只满足 NEQ
+    if (constraint_type == system::ConstraintType::NEQ) {
+        if (summary.null_num > 0) return true;
+        return row_nums[page_id] > 0 &&
+               !(summary.min == key && summary.max == key);
+    }
+    if (summary.null_num == row_nums[page_id]) return false;
+    switch (constraint_type) {
+        case system::ConstraintType::EQ:
+            return summary.min <= key && key <= summary.max;
+        case system::ConstraintType::GT:
+            return summary.max > key;
+        case system::ConstraintType::GEQ:
+            return summary.max >= key;
+        case system::ConstraintType::LT:
+            return summary.min < key;
+        case system::ConstraintType::LEQ:
+            return summary.min <= key;
+        default:
+            return true;
+    }
+}
+
+}  // namespace record
+}  // namespace dbs
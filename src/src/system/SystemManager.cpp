@@ -1,5 +1,9 @@
 #include "system/SystemManager.hpp"
 
+#include <algorithm>
+#include <map>
+#include <numeric>
+
 namespace dbs {
 namespace system {
 
@@ -7,6 +11,7 @@ SystemManager::SystemManager(fs::FileManager* fm_, record::RecordManager* rm_,
                              index::IndexManager* im_)
     : fm(fm_), rm(rm_), im(im_) {
     current_database_id = -1;
+    table_record_format = RECORD_FORMAT_COMPACT;
 
     GlobalDatabaseInfoColumnType.clear();
     GlobalDatabaseInfoColumnType.push_back(
@@ -217,8 +222,8 @@ bool SystemManager::deleteForeignKey(const char* table_name,
 
     for (int i = 0; i < data_items.size(); i++) {
         auto& data_item = data_items[i];
-        std::string name =
-            data_item.data_values[FOREIGN_KEY_MAX_NUM * 2 + 1].value.char_value;
+        std::string name = data_item.data_values[FOREIGN_KEY_MAX_NUM * 2 + 1]
+                               .value.char_value.str();
         if (name != foreign_key_name) {
             continue;
         }
@@ -448,6 +453,14 @@ bool SystemManager::createTable(
         return false;
     }
 
+    // check column number
+    if (column_types.size() > MAX_COLUMN_NUM) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << "Too many columns, at most " << MAX_COLUMN_NUM
+                  << std::endl;
+        return false;
+    }
+
     // check column type has different name
     std::set<std::string> column_names;
     int column_names_idx = 0;
@@ -613,7 +626,7 @@ bool SystemManager::createTable(
     // Record path
     char* record_path = nullptr;
     utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
-    rm->initializeRecordFile(record_path, column_types);
+    rm->initializeRecordFile(record_path, column_types, table_record_format);
     delete[] record_path;
 
     // primary key path
@@ -746,6 +759,10 @@ bool SystemManager::createTable(
     return true;
 }
 
+void SystemManager::setTableRecordFormat(int record_format_) {
+    table_record_format = record_format_;
+}
+
 bool SystemManager::addIndex(const char* table_name,
                              const std::string& index_name,
                              const std::vector<int>& column_ids,
@@ -837,19 +854,11 @@ bool SystemManager::addIndex(const char* table_name,
     utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
     std::vector<record::ColumnType> record_column_types;
     rm->getColumnTypes(record_path, record_column_types);
-    // assert all column_ids are INT
+    // assert all column_ids exist
     for (auto& column_id : column_ids) {
         bool found = false;
         for (auto& column_type : record_column_types) {
             if (column_type.column_id == column_id) {
-                if (column_type.type_name != record::DataTypeName::INT) {
-                    std::cout << "!ERROR" << std::endl;
-                    std::cout << "Index column is not of type INT" << std::endl;
-                    delete[] table_path;
-                    delete[] index_info_path;
-                    delete[] record_path;
-                    return false;
-                }
                 found = true;
                 break;
             }
@@ -878,37 +887,30 @@ bool SystemManager::addIndex(const char* table_name,
     // get all data from record file
     rm->getAllRecords(record_path, data_items, record_locations);
 
-    // insert into index
+    // 收集所有索引项, 排序后一次建树
+    std::vector<index::IndexValue> index_values;
+    index_values.reserve(data_items.size());
     for (int i = 0; i < data_items.size(); i++) {
         auto& data_item = data_items[i];
         auto& location = record_locations[i];
         index::IndexValue insert_item(location.page_id, location.slot_id, 0);
-        for (int j = 0; j < column_ids.size(); j++) {
-            int column_id = column_ids[j];
-            for (int k = 0; k < data_item.data_values.size(); k++) {
-                if (data_item.column_ids[k] == column_id) {
-                    insert_item.key.push_back(
-                        data_item.data_values[k].value.int_value);
-                    break;
-                }
-            }
-        }
-        if (check_unique) {
-            std::vector<index::IndexValue> search_results;
-            im->searchIndex(index_file_path, insert_item, search_results);
-            if (search_results.size() > 0) {
-                std::cout << "!ERROR" << std::endl;
-                std::cout << "duplicate" << std::endl;
-                dropIndex(table_name, index_name);
-                delete[] table_path;
-                delete[] index_info_path;
-                delete[] record_path;
-                delete[] index_file_path;
-                return false;
-            }
-        }
-        im->insertIndex(index_file_path, insert_item);
+        getIndexKey(data_item, column_ids, insert_item.key);
+        index_values.push_back(std::move(insert_item));
+    }
+    index::sortIndexValues(index_values);
+    if (check_unique &&
+        hasDuplicateIndexKey(index_values, data_items, record_locations,
+                             column_ids, record_column_types)) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << "duplicate" << std::endl;
+        dropIndex(table_name, index_name);
+        delete[] table_path;
+        delete[] index_info_path;
+        delete[] record_path;
+        delete[] index_file_path;
+        return false;
     }
+    im->bulkLoadIndex(index_file_path, index_values);
     delete[] index_file_path;
     delete[] record_path;
     delete[] table_path;
@@ -984,6 +986,79 @@ bool SystemManager::dropIndex(const char* table_name,
     return false;
 }
 
+bool SystemManager::compactTable(const char* table_name) {
+    if (current_database_id == -1) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << "No database selected" << std::endl;
+        return false;
+    }
+
+    int table_id = getTableId(table_name);
+    if (table_id == -1) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << "Table " << table_name << " does not exist" << std::endl;
+        return false;
+    }
+
+    char* table_path = nullptr;
+    getTableRecordPath(current_database_id, table_id, &table_path);
+    char* record_path = nullptr;
+    utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
+    char* index_info_path = nullptr;
+    utils::concatPath(table_path, INDEX_INFO_FILE_NAME, &index_info_path);
+
+    int page_num_before = rm->getTotalPageNum(record_path);
+    int page_num_after = rm->compactRecordFile(record_path);
+
+    std::vector<record::DataItem> data_items;
+    std::vector<record::RecordLocation> record_locations;
+    rm->getAllRecords(record_path, data_items, record_locations);
+
+    // 记录位置已改变, 按新位置重建所有索引
+    std::vector<record::DataItem> index_infos;
+    std::vector<record::RecordLocation> index_info_locations;
+    rm->getAllRecords(index_info_path, index_infos, index_info_locations);
+    for (auto& index_info : index_infos) {
+        std::vector<int> column_ids;
+        for (int i = 0; i < INDEX_KEY_MAX_NUM; i++) {
+            if (index_info.data_values[i].is_null == false) {
+                column_ids.push_back(
+                    index_info.data_values[i].value.int_value);
+            }
+        }
+        char* index_file_path = nullptr;
+        getIndexRecordPath(current_database_id, table_id, index_info.data_id,
+                           &index_file_path);
+        im->initializeIndexFile(index_file_path,
+                                getIndexKeyNum(table_id, column_ids));
+        std::vector<index::IndexValue> index_values;
+        index_values.reserve(data_items.size());
+        for (int i = 0; i < (int)data_items.size(); i++) {
+            auto& data_item = data_items[i];
+            auto& location = record_locations[i];
+            index::IndexValue insert_item(location.page_id, location.slot_id,
+                                          0);
+            getIndexKey(data_item, column_ids, insert_item.key);
+            index_values.push_back(std::move(insert_item));
+        }
+        index::sortIndexValues(index_values);
+        im->bulkLoadIndex(index_file_path, index_values);
+        delete[] index_file_path;
+    }
+
+    int row_num = data_items.size();
+    std::cout << "pages,rows_per_page" << std::endl;
+    std::cout << page_num_before << ","
+              << (page_num_before ? row_num / page_num_before : 0) << std::endl;
+    std::cout << page_num_after << ","
+              << (page_num_after ? row_num / page_num_after : 0) << std::endl;
+
+    delete[] index_info_path;
+    delete[] record_path;
+    delete[] table_path;
+    return true;
+}
+
 int SystemManager::createIndex(const char* index_info_path,
                                const char* index_folder_path,
                                std::vector<int> index_ids, int table_id,
@@ -1021,7 +1096,8 @@ int SystemManager::createIndex(const char* index_info_path,
     char* index_file_path = nullptr;
     getIndexRecordPath(current_database_id, table_id, data_item.data_id,
                        &index_file_path);
-    im->initializeIndexFile(index_file_path, index_ids.size());
+    im->initializeIndexFile(index_file_path,
+                            getIndexKeyNum(table_id, index_ids));
 
     // delete path
     delete[] index_file_path;
@@ -1065,98 +1141,104 @@ bool SystemManager::insertIntoTable(const char* table_name,
     std::vector<ForeignKeyInfo> foreign_key_infos;
     getTableForeignKeys(table_id, foreign_key_infos);
 
-    // record insert val primary keys
-    std::vector<std::vector<int>> insert_val_primary_keys;
+    // get all index
+    std::vector<std::pair<int, std::vector<int>>> all_index;
+    std::vector<std::string> index_names;
+    getAllIndex(current_database_id, table_id, all_index, index_names);
+
+    // 各项检查对所有行一起做, 报告行号最小的错误, 出错的行之后不用再检查
+    // 同一行中依次检查列和类型, 主键, 外键
+    int error_row = data_items.size();
+    const char* error_message = nullptr;
+    auto setError = [&](int row, const char* message) {
+        if (row < error_row) {
+            error_row = row;
+            error_message = message;
+        }
+    };
 
     // check data_items
-    for (auto& data_item : data_items) {
+    for (int row = 0; row < error_row; row++) {
+        auto& data_item = data_items[row];
         if (data_item.data_values.size() != column_types.size()) {
-            std::cout << "!ERROR" << std::endl;
-            std::cout << "Data item size does not match column size"
-                      << std::endl;
-            return false;
+            setError(row, "Data item size does not match column size");
+            break;
         }
         data_item.column_ids.clear();
         for (int i = 0; i < data_item.data_values.size(); i++) {
             if (data_item.data_values[i].is_null) {
                 if (column_types[i].require_not_null) {
-                    std::cout << "!ERROR" << std::endl;
-                    std::cout << "null" << std::endl;
-                    return false;
+                    setError(row, "null");
+                    break;
                 }
                 data_item.data_values[i].type_name = column_types[i].type_name;
             }
             if (data_item.data_values[i].type_name !=
                 column_types[i].type_name) {
-                std::cout << "!ERROR" << std::endl;
-                std::cout << "Data item type does not match column type"
-                          << std::endl;
-                return false;
+                setError(row, "Data item type does not match column type");
+                break;
             }
             data_item.column_ids.push_back(column_types[i].column_id);
         }
+        if (row == error_row) break;
+        // upd 主键不能为 null
+        for (int i = 0; i < (int)data_item.data_values.size(); i++) {
+            if (primary_keys.count(data_item.column_ids[i]) > 0 &&
+                data_item.data_values[i].is_null)
+                setError(row, "null");
+        }
+    }
 
-        // upd 以下检查主键是否唯一
-        if (primary_keys.size() > 0) {
-            // upd 设置查找主键的constraint
-            std::vector<SearchConstraint> primary_constraints;
-            std::vector<int> insert_val_primary_key;
-            for (auto& primary_key : primary_keys) {
-                SearchConstraint constraint;
-                constraint.column_id = primary_key;
-                constraint.constraint_types.push_back(ConstraintType::EQ);
-                constraint.data_type = record::DataTypeName::INT;
+    // upd 以下检查主键是否唯一
+    if (primary_keys.size() > 0) {
+        std::vector<int> primary_key_ids(primary_keys.begin(),
+                                         primary_keys.end());
+        std::vector<std::vector<int>> insert_val_primary_keys(error_row);
+        for (int row = 0; row < error_row; row++) {
+            auto& data_item = data_items[row];
+            for (auto& primary_key : primary_key_ids) {
                 for (int i = 0; i < data_item.data_values.size(); i++) {
                     if (data_item.column_ids[i] == primary_key) {
-                        constraint.constraint_values.push_back(
-                            data_item.data_values[i]);
-                        insert_val_primary_key.push_back(
+                        insert_val_primary_keys[row].push_back(
                             data_item.data_values[i].value.int_value);
-                        if (data_item.data_values[i].is_null) {
-                            std::cout << "!ERROR" << std::endl;
-                            std::cout << "null" << std::endl;
-                            return false;
-                        }
-                    }
-                }
-                primary_constraints.push_back(constraint);
-            }
-
-            // upd 检查是否重复（insert val之间的primary key)
-            for (int i = 0; i < insert_val_primary_keys.size(); i++) {
-                bool same = true;
-                for (int j = 0; j < insert_val_primary_keys[i].size(); j++) {
-                    if (insert_val_primary_keys[i][j] !=
-                        insert_val_primary_key[j]) {
-                        same = false;
                         break;
                     }
                 }
-                if (same) {
-                    std::cout << "!ERROR" << std::endl;
-                    std::cout << "duplicate primary keys" << std::endl;
-                    return false;
-                }
             }
-            insert_val_primary_keys.push_back(insert_val_primary_key);
+        }
 
-            // upd 检查是否重复
-            std::vector<record::DataItem> result_datas;
-            std::vector<record::ColumnType> result_column_types;
-            std::vector<record::RecordLocation> record_locations;
-            search(table_id, primary_constraints, result_datas,
-                   result_column_types, record_locations, -1);
-            if (result_datas.size() > 0) {
-                std::cout << "!ERROR" << std::endl;
-                std::cout << "duplicate" << std::endl;
-                return false;
-            }
+        // upd 检查是否重复（insert val之间的primary key)
+        // 按键排序后, 相同的键中除第一行外都与之前的行重复
+        std::vector<int> order(insert_val_primary_keys.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return insert_val_primary_keys[a] < insert_val_primary_keys[b];
+        });
+        for (int i = 1; i < (int)order.size(); i++) {
+            if (insert_val_primary_keys[order[i]] ==
+                insert_val_primary_keys[order[i - 1]])
+                setError(order[i], "duplicate primary keys");
         }
 
-        // upd 以下检查外键是否唯一
-        for (auto& foreign_key_info : foreign_key_infos) {
-            std::vector<record::DataValue> foreign_key_values;
+        // upd 检查是否重复
+        std::vector<bool> found;
+        searchKeysExist(table_id, primary_key_ids, insert_val_primary_keys,
+                        found);
+        for (int row = 0; row < (int)found.size(); row++) {
+            if (found[row]) setError(row, "duplicate");
+        }
+    }
+
+    // upd 以下检查外键是否存在
+    for (auto& foreign_key_info : foreign_key_infos) {
+        // 外键各列都不为 null 的行一起查找, 其余的行只按不为 null 的列查找
+        std::vector<int> foreign_key_rows;
+        std::vector<std::vector<int>> foreign_keys;
+        for (int row = 0; row < error_row; row++) {
+            auto& data_item = data_items[row];
+            std::vector<int> foreign_key;
             std::vector<SearchConstraint> constraints;
+            bool has_null = false;
             for (int fk_i = 0;
                  fk_i < foreign_key_info.foreign_key_column_ids.size();
                  fk_i++) {
@@ -1164,25 +1246,29 @@ bool SystemManager::insertIntoTable(const char* table_name,
                     foreign_key_info.foreign_key_column_ids[fk_i];
                 auto& reference_column_id =
                     foreign_key_info.reference_column_ids[fk_i];
-
-                SearchConstraint constraint;
-                constraint.column_id = reference_column_id;
-                constraint.constraint_types.push_back(ConstraintType::EQ);
-                constraint.data_type = record::DataTypeName::INT;
-                bool is_null = false;
                 for (int i = 0; i < data_item.data_values.size(); i++) {
-                    if (data_item.column_ids[i] == foreign_key_column_id) {
-                        if (data_item.data_values[i].is_null) {
-                            is_null = true;
-                            break;
-                        }
-                        foreign_key_values.push_back(data_item.data_values[i]);
-                        constraint.constraint_values.push_back(
-                            data_item.data_values[i]);
+                    if (data_item.column_ids[i] != foreign_key_column_id)
+                        continue;
+                    if (data_item.data_values[i].is_null) {
+                        has_null = true;
                         break;
                     }
+                    foreign_key.push_back(
+                        data_item.data_values[i].value.int_value);
+                    SearchConstraint constraint;
+                    constraint.column_id = reference_column_id;
+                    constraint.constraint_types.push_back(ConstraintType::EQ);
+                    constraint.data_type = record::DataTypeName::INT;
+                    constraint.constraint_values.push_back(
+                        data_item.data_values[i]);
+                    constraints.push_back(constraint);
+                    break;
                 }
-                if (!is_null) constraints.push_back(constraint);
+            }
+            if (!has_null) {
+                foreign_key_rows.push_back(row);
+                foreign_keys.push_back(std::move(foreign_key));
+                continue;
             }
 
             std::vector<record::DataItem> result_datas;
@@ -1190,12 +1276,26 @@ bool SystemManager::insertIntoTable(const char* table_name,
             std::vector<record::RecordLocation> record_locations;
             search(foreign_key_info.reference_table_id, constraints,
                    result_datas, result_column_types, record_locations, -1);
-            if (result_datas.size() == 0) {
-                std::cout << "!ERROR" << std::endl;
-                std::cout << "foreign key does not exist" << std::endl;
-                return false;
-            }
+            if (result_datas.size() == 0)
+                setError(row, "foreign key does not exist");
         }
+
+        std::vector<bool> found;
+        searchKeysExist(foreign_key_info.reference_table_id,
+                        foreign_key_info.reference_column_ids, foreign_keys,
+                        found);
+        for (int i = 0; i < (int)found.size(); i++) {
+            if (!found[i])
+                setError(foreign_key_rows[i], "foreign key does not exist");
+        }
+    }
+
+    if (error_message != nullptr) {
+        std::cout << "!ERROR" << std::endl;
+        std::cout << error_message << std::endl;
+        delete[] table_path;
+        delete[] record_path;
+        return false;
     }
 
     // TODO unique 检查未实现
@@ -1203,12 +1303,6 @@ bool SystemManager::insertIntoTable(const char* table_name,
     std::vector<record::DataItem> result_datas;
     std::vector<record::RecordLocation> record_locations;
 
-    std::vector<std::pair<int, std::vector<int>>> all_index;
-    std::vector<std::string> index_names;
-    getAllIndex(current_database_id, table_id, all_index, index_names);
-
-    rm->getColumnTypes(record_path, column_types);
-
     for (auto& data_item : data_items) {
         // check unique
         for (auto& column : column_types) {
@@ -1243,19 +1337,7 @@ bool SystemManager::insertIntoTable(const char* table_name,
                                &index_file_path);
             index::IndexValue index_value(location.page_id, location.slot_id,
                                           0);
-            for (auto& column_id : index.second) {
-                for (int i = 0; i < data_item.column_ids.size(); i++) {
-                    if (data_item.column_ids[i] == column_id) {
-                        if (data_item.data_values[i].is_null) {
-                            index_value.key.push_back(INT_MIN);
-                        } else {
-                            index_value.key.push_back(
-                                data_item.data_values[i].value.int_value);
-                        }
-                        break;
-                    }
-                }
-            }
+            getIndexKey(data_item, index.second, index_value.key);
             assert(im->insertIndex(index_file_path, index_value));
             delete[] index_file_path;
         }
@@ -1703,19 +1785,7 @@ bool SystemManager::update(int table_id,
             index::IndexValue old_index_value(record_location_result.page_id,
                                               record_location_result.slot_id,
                                               0);
-            for (auto& column_id : all_index[i].second) {
-                for (int i = 0; i < result_data.column_ids.size(); i++) {
-                    if (result_data.column_ids[i] == column_id) {
-                        if (result_data.data_values[i].is_null) {
-                            old_index_value.key.push_back(INT_MIN);
-                        } else {
-                            old_index_value.key.push_back(
-                                result_data.data_values[i].value.int_value);
-                        }
-                        break;
-                    }
-                }
-            }
+            getIndexKey(result_data, all_index[i].second, old_index_value.key);
             if (!im->deleteIndex(index_file_path, old_index_value, true)) {
                 std::cout << "!ERROR" << std::endl;
                 std::cout << "Delete index failed" << std::endl;
@@ -1728,19 +1798,7 @@ bool SystemManager::update(int table_id,
             index::IndexValue new_index_value(record_location_result.page_id,
                                               record_location_result.slot_id,
                                               0);
-            for (auto& column_id : all_index[i].second) {
-                for (int i = 0; i < new_data.column_ids.size(); i++) {
-                    if (new_data.column_ids[i] == column_id) {
-                        if (new_data.data_values[i].is_null) {
-                            new_index_value.key.push_back(INT_MIN);
-                        } else {
-                            new_index_value.key.push_back(
-                                new_data.data_values[i].value.int_value);
-                        }
-                        break;
-                    }
-                }
-            }
+            getIndexKey(new_data, all_index[i].second, new_index_value.key);
             if (!im->insertIndex(index_file_path, new_index_value)) {
                 std::cout << "!ERROR" << std::endl;
                 std::cout << "Insert index failed" << std::endl;
@@ -1864,19 +1922,7 @@ bool SystemManager::deleteFromTable(
             index::IndexValue old_index_value(record_location_result.page_id,
                                               record_location_result.slot_id,
                                               0);
-            for (auto& column_id : all_index[i].second) {
-                for (int i = 0; i < result_data.column_ids.size(); i++) {
-                    if (result_data.column_ids[i] == column_id) {
-                        if (result_data.data_values[i].is_null) {
-                            old_index_value.key.push_back(INT_MIN);
-                        } else {
-                            old_index_value.key.push_back(
-                                result_data.data_values[i].value.int_value);
-                        }
-                        break;
-                    }
-                }
-            }
+            getIndexKey(result_data, all_index[i].second, old_index_value.key);
             if (!im->deleteIndex(index_file_path, old_index_value, true)) {
                 std::cout << "!ERROR" << std::endl;
                 std::cout << "Delete index failed" << std::endl;
@@ -2077,7 +2123,7 @@ bool SystemManager::searchAndSave(int table_id,
     bool has_item = mergeConstraints(constraints);
     rm->initializeRecordFile(save_path.c_str(), column_types);
     // check column type
-    std::vector<int> int_constraint_with_range;
+    std::vector<int> constraint_with_range;
     for (auto& constraint : constraints) {
         bool find = false;
         for (auto& column_type : column_types) {
@@ -2102,10 +2148,9 @@ bool SystemManager::searchAndSave(int table_id,
             std::cout << "Constraint column id does not exist" << std::endl;
             return false;
         }
-        if (constraint.data_type == record::DataTypeName::INT &&
-            constraint.constraint_types.size() > 0 &&
+        if (constraint.constraint_types.size() > 0 &&
             constraint.constraint_types[0] != ConstraintType::NEQ) {
-            int_constraint_with_range.push_back(constraint.column_id);
+            constraint_with_range.push_back(constraint.column_id);
         }
     }
 
@@ -2122,12 +2167,11 @@ bool SystemManager::searchAndSave(int table_id,
     for (auto& index : all_index) {
         int index_id = index.first;
         auto& index_num = index.second;
-        int overlap = 0;  // int_constraint_with_range
+        int overlap = 0;  // constraint_with_range
         for (auto& index_num_id : index_num) {
             bool found = false;
-            for (auto& int_constraint_with_range_id :
-                 int_constraint_with_range) {
-                if (index_num_id == int_constraint_with_range_id) {
+            for (auto& constraint_with_range_id : constraint_with_range) {
+                if (index_num_id == constraint_with_range_id) {
                     overlap++;
                     found = true;
                     break;
@@ -2159,34 +2203,8 @@ bool SystemManager::searchAndSave(int table_id,
         return true;
     } else {
         index::IndexValue index_range_low, index_range_high;
-        for (int i = 0; i < overlap_num; i++) {
-            int low_range = INT_MIN, high_range = INT_MAX;
-            for (auto& constraint : constraints) {
-                if (constraint.column_id == index_val[i]) {
-                    for (int j = 0; j < constraint.constraint_types.size();
-                         j++) {
-                        if (constraint.constraint_types[j] ==
-                            ConstraintType::LEQ) {
-                            high_range = std::min(
-                                high_range, constraint.constraint_values[j]
-                                                .value.int_value);
-
-                        } else if (constraint.constraint_types[j] ==
-                                   ConstraintType::GEQ) {
-                            low_range = std::max(low_range,
-                                                 constraint.constraint_values[j]
-                                                     .value.int_value);
-                        }
-                    }
-                }
-            }
-            index_range_low.key.push_back(low_range);
-            index_range_high.key.push_back(high_range);
-        }
-        for (int i = overlap_num; i < index_val.size(); i++) {
-            index_range_low.key.push_back(INT_MIN);
-            index_range_high.key.push_back(INT_MAX);
-        }
+        getIndexRange(index_val, overlap_num, constraints, column_types,
+                      index_range_low, index_range_high);
         // get index file path
         char* index_file_path = nullptr;
         getIndexRecordPath(current_database_id, table_id, chosen_index,
@@ -2245,7 +2263,8 @@ bool SystemManager::search(
     int table_id, std::vector<SearchConstraint>& constraints,
     std::vector<record::DataItem>& result_datas,
     std::vector<record::ColumnType>& column_types,
-    std::vector<record::RecordLocation>& record_location_results, int sort_by) {
+    std::vector<record::RecordLocation>& record_location_results, int sort_by,
+    const std::vector<int>* output_column_ids, int limit) {
     if (current_database_id == -1) {
         std::cout << "!ERROR" << std::endl;
         std::cout << "No database selected" << std::endl;
@@ -2267,7 +2286,7 @@ bool SystemManager::search(
     getTableColumnTypes(table_id, column_types);
     bool has_item = mergeConstraints(constraints);
     // check column type
-    std::vector<int> int_constraint_with_range;
+    std::vector<int> constraint_with_range;
     for (auto& constraint : constraints) {
         bool find = false;
         for (auto& column_type : column_types) {
@@ -2292,10 +2311,9 @@ bool SystemManager::search(
             std::cout << "Constraint column id does not exist" << std::endl;
             return false;
         }
-        if (constraint.data_type == record::DataTypeName::INT &&
-            constraint.constraint_types.size() > 0 &&
+        if (constraint.constraint_types.size() > 0 &&
             constraint.constraint_types[0] != ConstraintType::NEQ) {
-            int_constraint_with_range.push_back(constraint.column_id);
+            constraint_with_range.push_back(constraint.column_id);
         }
     }
 
@@ -2312,12 +2330,11 @@ bool SystemManager::search(
     for (auto& index : all_index) {
         int index_id = index.first;
         auto& index_num = index.second;
-        int overlap = 0;  // int_constraint_with_range
+        int overlap = 0;  // constraint_with_range
         for (auto& index_num_id : index_num) {
             bool found = false;
-            for (auto& int_constraint_with_range_id :
-                 int_constraint_with_range) {
-                if (index_num_id == int_constraint_with_range_id) {
+            for (auto& constraint_with_range_id : constraint_with_range) {
+                if (index_num_id == constraint_with_range_id) {
                     overlap++;
                     found = true;
                     break;
@@ -2339,65 +2356,58 @@ bool SystemManager::search(
         std::vector<record::DataItem> data_items;
         std::vector<record::RecordLocation> record_locations;
         rm->getAllRecordWithConstraint(record_path, result_datas,
-                                       record_location_results, constraints);
+                                       record_location_results, constraints,
+                                       output_column_ids);
+        if (limit != -1 && (int)result_datas.size() > limit) {
+            result_datas.resize(limit);
+            record_location_results.resize(limit);
+        }
         delete[] table_path;
         delete[] record_path;
         return true;
     } else {
         index::IndexValue index_range_low, index_range_high;
-        for (int i = 0; i < overlap_num; i++) {
-            int low_range = INT_MIN, high_range = INT_MAX;
-            for (auto& constraint : constraints) {
-                if (constraint.column_id == index_val[i]) {
-                    for (int j = 0; j < constraint.constraint_types.size();
-                         j++) {
-                        if (constraint.constraint_types[j] ==
-                            ConstraintType::LEQ) {
-                            high_range = std::min(
-                                high_range, constraint.constraint_values[j]
-                                                .value.int_value);
-
-                        } else if (constraint.constraint_types[j] ==
-                                   ConstraintType::GEQ) {
-                            low_range = std::max(low_range,
-                                                 constraint.constraint_values[j]
-                                                     .value.int_value);
-                        }
-                    }
-                }
-            }
-            index_range_low.key.push_back(low_range);
-            index_range_high.key.push_back(high_range);
-        }
-        for (int i = overlap_num; i < index_val.size(); i++) {
-            index_range_low.key.push_back(INT_MIN);
-            index_range_high.key.push_back(INT_MAX);
-        }
+        getIndexRange(index_val, overlap_num, constraints, column_types,
+                      index_range_low, index_range_high);
         // get index file path
         char* index_file_path = nullptr;
         getIndexRecordPath(current_database_id, table_id, chosen_index,
                            &index_file_path);
-        // check index file
-        std::vector<index::IndexValue> index_results;
-        im->searchIndexInRanges(index_file_path, index_range_low,
-                                index_range_high, index_results);
-        delete[] index_file_path;
-
         // get record file path
         char* table_path = nullptr;
         getTableRecordPath(current_database_id, table_id, &table_path);
         char* record_path = nullptr;
         utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
 
-        // get record
+        // 沿索引每次取一批位置读出记录, 够 limit 条时停止
+        index::IndexCursor cursor(im);
+        cursor.seek(index_file_path, index_range_low, index_range_high);
+        index::IndexValue index_value;
         std::vector<record::RecordLocation> record_locations;
-        index::indexValueToRecordLocation(index_results, record_locations);
-        std::vector<record::DataItem> data_items;
-        rm->getRecords(record_path, record_locations, data_items);
+        std::vector<record::DataItem> batch_datas;
+        std::vector<record::RecordLocation> batch_locations;
+        bool more = true;
+        while (more && (limit == -1 || (int)result_datas.size() < limit)) {
+            record_locations.clear();
+            while ((int)record_locations.size() < INDEX_SCAN_BATCH &&
+                   (more = cursor.next(index_value))) {
+                record_locations.push_back(
+                    {index_value.page_id, index_value.slot_id});
+            }
+            if (record_locations.empty()) break;
+            rm->getRecordsWithConstraint(record_path, record_locations,
+                                         constraints, batch_datas,
+                                         batch_locations);
+            for (int i = 0; i < (int)batch_datas.size(); i++) {
+                if (limit != -1 && (int)result_datas.size() == limit) break;
+                result_datas.push_back(std::move(batch_datas[i]));
+                record_location_results.push_back(batch_locations[i]);
+            }
+        }
+        cursor.close();
+        delete[] index_file_path;
         delete[] table_path;
         delete[] record_path;
-        filterConstraints(constraints, data_items, record_locations,
-                          result_datas, record_location_results);
         return true;
     }
 }
@@ -2573,7 +2583,7 @@ bool SystemManager::getTableForeignKeys(
             foreign_key_column_ids, data_item.data_values[0].value.int_value,
             reference_column_ids,
             data_item.data_values[FOREIGN_KEY_MAX_NUM * 2 + 1]
-                .value.char_value));
+                .value.char_value.str()));
     }
     delete[] table_path;
     delete[] foreign_key_path;
@@ -2837,106 +2847,260 @@ bool SystemManager::loadTableFromFile(const char* table_name,
     char* record_path = nullptr;
     utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
 
-    int data_item_per_page =
-        rm->insertRecordsToEmptyRecord(record_path, file_path, delimeter, true);
+    std::vector<std::pair<int, std::vector<int>>> all_index;
+    std::vector<std::string> index_names;
+    getAllIndex(current_database_id, table_id, all_index, index_names);
+
+    // 导入的同时收集每个索引的索引项, 不再重新解析 CSV, 之后整个重建索引
+    std::vector<std::vector<index::IndexValue>> index_values(all_index.size());
+    auto collectIndexValues = [&](const record::DataItem& data_item,
+                                  const record::RecordLocation& location) {
+        for (int i = 0; i < (int)all_index.size(); i++) {
+            index::IndexValue index_value(location.page_id, location.slot_id,
+                                          0);
+            getIndexKey(data_item, all_index[i].second, index_value.key);
+            index_values[i].push_back(std::move(index_value));
+        }
+    };
+    int data_item_per_page = rm->insertRecordsToEmptyRecord(
+        record_path, file_path, delimeter, true, collectIndexValues);
     if (data_item_per_page == -1) {
+        delete[] table_path;
+        delete[] record_path;
         return false;
     }
+
+    for (int i = 0; i < (int)all_index.size(); i++) {
+        char* index_file_path = nullptr;
+        getIndexRecordPath(current_database_id, table_id, all_index[i].first,
+                           &index_file_path);
+        index::sortIndexValues(index_values[i]);
+        bool success = im->bulkLoadIndex(index_file_path, index_values[i]);
+        assert(success);
+        delete[] index_file_path;
+    }
+
+    delete[] table_path;
+    delete[] record_path;
+    return true;
+}
+
+int SystemManager::getIndexKeyNum(int table_id,
+                                  const std::vector<int>& index_column_ids) {
     std::vector<record::ColumnType> column_types;
-    rm->getColumnTypes(record_path, column_types);
+    getTableColumnTypes(table_id, column_types);
+    int index_key_num = 0;
+    for (auto& column_id : index_column_ids) {
+        for (auto& column_type : column_types) {
+            if (column_type.column_id == column_id) {
+                index_key_num +=
+                    index::getIndexKeyLength(column_type.type_name);
+                break;
+            }
+        }
+    }
+    return index_key_num;
+}
+
+void SystemManager::getIndexKey(const record::DataItem& data_item,
+                                const std::vector<int>& index_column_ids,
+                                std::vector<int>& key) {
+    for (auto& column_id : index_column_ids) {
+        for (int i = 0; i < (int)data_item.column_ids.size(); i++) {
+            if (data_item.column_ids[i] == column_id) {
+                index::appendIndexKey(data_item.data_values[i], key);
+                break;
+            }
+        }
+    }
+}
+
+void SystemManager::searchKeysExist(int table_id,
+                                    const std::vector<int>& column_ids,
+                                    const std::vector<std::vector<int>>& keys,
+                                    std::vector<bool>& found) {
+    found.assign(keys.size(), false);
+    if (keys.empty()) return;
 
+    // 找以这些列为键的索引, 索引的第 j 列是 column_ids[key_order[j]]
     std::vector<std::pair<int, std::vector<int>>> all_index;
     std::vector<std::string> index_names;
     getAllIndex(current_database_id, table_id, all_index, index_names);
+    int chosen_index = -1;
+    std::vector<int> key_order;
+    for (auto& index : all_index) {
+        if (index.second.size() != column_ids.size()) continue;
+        key_order.clear();
+        for (auto& index_column_id : index.second) {
+            auto it = std::find(column_ids.begin(), column_ids.end(),
+                                index_column_id);
+            if (it == column_ids.end()) break;
+            key_order.push_back(it - column_ids.begin());
+        }
+        // 每列的键长为 1 时都是 INT 列
+        if (key_order.size() == column_ids.size() &&
+            getIndexKeyNum(table_id, index.second) == (int)column_ids.size()) {
+            chosen_index = index.first;
+            break;
+        }
+    }
 
-    std::ifstream csv_file(file_path);
-    if (!csv_file.is_open()) {
-        std::cerr << "Failed to open file " << file_path << std::endl;
+    if (chosen_index == -1) {
+        for (int i = 0; i < (int)keys.size(); i++) {
+            std::vector<SearchConstraint> constraints;
+            for (int j = 0; j < (int)column_ids.size(); j++) {
+                SearchConstraint constraint;
+                constraint.column_id = column_ids[j];
+                constraint.constraint_types.push_back(ConstraintType::EQ);
+                constraint.data_type = record::DataTypeName::INT;
+                constraint.constraint_values.push_back(record::DataValue(
+                    record::DataTypeName::INT, false, keys[i][j]));
+                constraints.push_back(constraint);
+            }
+            std::vector<record::DataItem> result_datas;
+            std::vector<record::ColumnType> result_column_types;
+            std::vector<record::RecordLocation> record_locations;
+            search(table_id, constraints, result_datas, result_column_types,
+                   record_locations, -1);
+            found[i] = result_datas.size() > 0;
+        }
+        return;
+    }
+
+    // 按索引的列排列后排序去重, 相同的键只查找一次
+    std::vector<std::vector<int>> index_keys(keys.size());
+    for (int i = 0; i < (int)keys.size(); i++) {
+        for (auto& j : key_order) index_keys[i].push_back(keys[i][j]);
+    }
+    std::vector<int> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return index_keys[a] < index_keys[b]; });
+    std::vector<std::vector<int>> search_keys;
+    std::vector<int> search_pos(keys.size());
+    for (auto& i : order) {
+        if (search_keys.empty() || search_keys.back() != index_keys[i])
+            search_keys.push_back(index_keys[i]);
+        search_pos[i] = search_keys.size() - 1;
+    }
+
+    char* index_file_path = nullptr;
+    getIndexRecordPath(current_database_id, table_id, chosen_index,
+                       &index_file_path);
+    std::vector<bool> search_found;
+    bool success =
+        im->searchIndexBatch(index_file_path, search_keys, search_found);
+    assert(success);
+    delete[] index_file_path;
+    for (int i = 0; i < (int)keys.size(); i++)
+        found[i] = search_found[search_pos[i]];
+}
+
+bool SystemManager::hasDuplicateIndexKey(
+    const std::vector<index::IndexValue>& index_values,
+    const std::vector<record::DataItem>& data_items,
+    const std::vector<record::RecordLocation>& record_locations,
+    const std::vector<int>& index_column_ids,
+    const std::vector<record::ColumnType>& column_types) {
+    // VARCHAR 列在键中只有前缀, 键相同时还要比较这些列的原值
+    std::vector<int> varchar_columns;
+    for (auto& column_id : index_column_ids) {
+        for (int i = 0; i < (int)column_types.size(); i++) {
+            if (column_types[i].column_id == column_id &&
+                column_types[i].type_name == record::DataTypeName::VARCHAR)
+                varchar_columns.push_back(i);
+        }
+    }
+    auto varcharLess = [&](const record::DataItem* a,
+                           const record::DataItem* b) {
+        for (auto& i : varchar_columns) {
+            auto& value_a = a->data_values[i];
+            auto& value_b = b->data_values[i];
+            if (value_a.is_null || value_b.is_null) {
+                if (value_a.is_null != value_b.is_null) return value_a.is_null;
+                continue;
+            }
+            std::string_view string_a = value_a.value.char_value;
+            std::string_view string_b = value_b.value.char_value;
+            if (string_a != string_b) return string_a < string_b;
+        }
         return false;
+    };
+    std::map<std::pair<int, int>, const record::DataItem*> location_items;
+    if (!varchar_columns.empty()) {
+        for (int i = 0; i < (int)data_items.size(); i++) {
+            location_items[{record_locations[i].page_id,
+                            record_locations[i].slot_id}] = &data_items[i];
+        }
     }
 
-    std::string line;
-    int page_id = 1, slot_id = 0;
-    while (getline(csv_file, line)) {
-        if (slot_id == data_item_per_page) {
-            page_id++;
-            slot_id = 0;
+    // 排序后键相同的项相邻
+    int n = index_values.size();
+    for (int begin = 0, end; begin < n; begin = end) {
+        end = begin + 1;
+        while (end < n && index_values[end].key == index_values[begin].key)
+            end++;
+        if (end - begin == 1) continue;
+        if (varchar_columns.empty()) return true;
+        std::vector<const record::DataItem*> items;
+        for (int i = begin; i < end; i++) {
+            items.push_back(location_items[{index_values[i].page_id,
+                                            index_values[i].slot_id}]);
         }
-        std::vector<std::string> csv_row;
-        std::string item;
-        for (int i = 0; i < line.length(); i++) {
-            if (line[i] == delimeter[0]) {
-                csv_row.push_back(item);
-                item = "";
-            } else {
-                item += line[i];
-            }
+        std::sort(items.begin(), items.end(), varcharLess);
+        for (int i = 1; i < (int)items.size(); i++) {
+            if (!varcharLess(items[i - 1], items[i])) return true;
         }
-        csv_row.push_back(item);
+    }
+    return false;
+}
 
-        record::DataItem data_item;
-        int csv_row_idx = 0;
-        for (auto& column : column_types) {
-            data_item.column_ids.push_back(column.column_id);
-            record::DateValue date_value;
-            std::istringstream iss;
-            double floatValue;
-            if (column.type_name == record::DataTypeName::FLOAT) {
-                std::istringstream iss(csv_row[csv_row_idx++]);
-                iss >> floatValue;
-            }
-            switch (column.type_name) {
-                case record::DataTypeName::INT:
-                    data_item.data_values.push_back(
-                        record::DataValue(record::DataTypeName::INT, false,
-                                          std::stoi(csv_row[csv_row_idx++])));
-                    break;
-                case record::DataTypeName::FLOAT:
-                    data_item.data_values.push_back(record::DataValue(
-                        record::DataTypeName::FLOAT, false, floatValue));
-                    break;
-                case record::DataTypeName::VARCHAR:
-                    data_item.data_values.push_back(
-                        record::DataValue(record::DataTypeName::VARCHAR, false,
-                                          csv_row[csv_row_idx++]));
-                    break;
-                case record::DataTypeName::DATE:
-                    date_value.year = std::stoi(csv_row[csv_row_idx].substr(
-                        0, csv_row[csv_row_idx].find('-')));
-                    date_value.month = std::stoi(csv_row[csv_row_idx].substr(
-                        csv_row[csv_row_idx].find('-') + 1,
-                        csv_row[csv_row_idx].rfind('-') -
-                            csv_row[csv_row_idx].find('-') - 1));
-                    date_value.day = std::stoi(csv_row[csv_row_idx].substr(
-                        csv_row[csv_row_idx].rfind('-') + 1));
-                    csv_row_idx++;
-                    data_item.data_values.push_back(record::DataValue(
-                        record::DataTypeName::DATE, false, date_value));
-                    break;
+void SystemManager::getIndexRange(
+    const std::vector<int>& index_column_ids, int constrained_num,
+    const std::vector<SearchConstraint>& constraints,
+    const std::vector<record::ColumnType>& column_types,
+    index::IndexValue& index_range_low, index::IndexValue& index_range_high) {
+    index_range_low.key.clear();
+    index_range_high.key.clear();
+    for (int i = 0; i < (int)index_column_ids.size(); i++) {
+        int column_id = index_column_ids[i];
+        record::DataTypeName type_name = record::DataTypeName::INT;
+        for (auto& column_type : column_types) {
+            if (column_type.column_id == column_id) {
+                type_name = column_type.type_name;
+                break;
             }
         }
-
-        for (auto& index : all_index) {
-            char* index_file_path = nullptr;
-            getIndexRecordPath(current_database_id, table_id, index.first,
-                               &index_file_path);
-            index::IndexValue index_value(page_id, slot_id, 0);
-            for (auto& index_id : index.second) {
-                if (data_item.data_values[index_id].is_null == false)
-                    index_value.key.push_back(
-                        data_item.data_values[index_id].value.int_value);
-                else
-                    index_value.key.push_back(INT_MIN);
+        // 合并后的约束中上下界各最多一个, 开区间也按闭区间查找
+        const record::DataValue* low_value = nullptr;
+        const record::DataValue* high_value = nullptr;
+        for (auto& constraint : constraints) {
+            if (i >= constrained_num || constraint.column_id != column_id)
+                continue;
+            for (int j = 0; j < (int)constraint.constraint_types.size(); j++) {
+                auto& value = constraint.constraint_values[j];
+                if (value.is_null || value.type_name != type_name) continue;
+                auto constraint_type = constraint.constraint_types[j];
+                if ((constraint_type == ConstraintType::GEQ ||
+                     constraint_type == ConstraintType::GT) &&
+                    (low_value == nullptr || *low_value < value)) {
+                    low_value = &value;
+                } else if ((constraint_type == ConstraintType::LEQ ||
+                            constraint_type == ConstraintType::LT) &&
+                           (high_value == nullptr || value < *high_value)) {
+                    high_value = &value;
+                }
             }
-            assert(im->insertIndex(index_file_path, index_value));
-            delete[] index_file_path;
         }
-        slot_id++;
+        if (low_value != nullptr)
+            index::appendIndexKey(*low_value, index_range_low.key);
+        else
+            index::appendIndexKeyBound(type_name, false, index_range_low.key);
+        if (high_value != nullptr)
+            index::appendIndexKey(*high_value, index_range_high.key);
+        else
+            index::appendIndexKeyBound(type_name, true, index_range_high.key);
     }
-
-    delete[] table_path;
-    delete[] record_path;
-    return true;
 }
 
 void SystemManager::getAllIndex(
@@ -2964,8 +3128,8 @@ void SystemManager::getAllIndex(
         }
         index_ids.push_back(std::make_pair(data_item.data_id, index_id));
         if (data_item.data_values[INDEX_KEY_MAX_NUM].is_null == false)
-            index_names.push_back(
-                data_item.data_values[INDEX_KEY_MAX_NUM].value.char_value);
+            index_names.push_back(data_item.data_values[INDEX_KEY_MAX_NUM]
+                                      .value.char_value.str());
         else
             index_names.push_back("");
     }
@@ -2983,6 +3147,37 @@ bool SystemManager::useDatabase(const char* database_name) {
         return false;
     }
 
+    // 旧版本建表时最多 102 列, 第 102 列的元数据与现在的空闲页链表重叠,
+    // 无法迁移, 有这样的表时拒绝使用该数据库
+    char* db_base_path = nullptr;
+    getDatabasePath(database_id, &db_base_path);
+    char* all_table_path = nullptr;
+    utils::concatPath(db_base_path, ALL_TABLE_FILE_NAME, &all_table_path);
+    std::vector<record::DataItem> data_items;
+    std::vector<record::RecordLocation> record_locations;
+    rm->getAllRecords(all_table_path, data_items, record_locations);
+    delete[] db_base_path;
+    delete[] all_table_path;
+    for (auto& data_item : data_items) {
+        char* table_path = nullptr;
+        getTableRecordPath(database_id, data_item.data_id, &table_path);
+        char* record_path = nullptr;
+        utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
+        int column_slot_num = rm->getColumnSlotNum(record_path);
+        delete[] table_path;
+        delete[] record_path;
+        if (column_slot_num > MAX_COLUMN_NUM) {
+            std::cout << "!ERROR" << std::endl;
+            std::cout << "Table "
+                      << data_item.data_values[0].value.char_value.str()
+                      << " has " << column_slot_num
+                      << " columns, more than " << MAX_COLUMN_NUM
+                      << "; drop it with the version that created it"
+                      << std::endl;
+            return false;
+        }
+    }
+
     current_database_id = database_id;
     return true;
 }
@@ -5,7 +5,7 @@ namespace utils{
 
 BitMap::BitMap(int _capacity, bool init_val) {
     capacity = _capacity;
-    bit_map_size = (_capacity >> BIT_MAP_BIAS);
+    bit_map_size = ((_capacity + (1 << BIT_MAP_BIAS) - 1) >> BIT_MAP_BIAS);
     data = new uint[bit_map_size];
     if (init_val == 1) 
         memset(data, 0xff, sizeof(uint) * bit_map_size);
@@ -81,12 +81,8 @@ void set1Byte(unsigned int &b, int positon, char value) {
 }
 
 int getFirstZeroBit(unsigned int b) {
-    for (int i = 0; i < BIT_PER_BUF; i++) {
-        if (!getBitFromNum(b, i)) {
-            return i;
-        }
-    }
-    return -1;
+    if (~b == 0) return -1;
+    return __builtin_ctz(~b);
 }
 
 }  // namespace utils
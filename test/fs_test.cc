@@ -1,8 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <random>
+#include <thread>
+
 #include "common/Config.hpp"
 #include "fs/BufPageManager.hpp"
 #include "fs/FileManager.hpp"
+#include "fs/LRUReplace.hpp"
+#include "fs/PageTable.hpp"
+#include "utils/HashMap.hpp"
 
 TEST(FSTest, Basics) {
     dbs::fs::FileManager* fm = new dbs::fs::FileManager();
@@ -130,3 +137,536 @@ TEST(FSTest, ExistFile) {
     EXPECT_TRUE(fm->existFile("Makefile"));
     EXPECT_FALSE(fm->existFile("NotExist.txt"));
 }
+
+TEST(FSTest, PageTable) {
+    dbs::fs::PageTable table(CACHE_CAPACITY);
+    for (int i = 0; i < CACHE_CAPACITY; i++) table.insert(i % 7, i, i);
+    for (int i = 0; i < CACHE_CAPACITY; i++)
+        ASSERT_EQ(table.find(i % 7, i), i);
+    ASSERT_EQ(table.find(1, CACHE_CAPACITY), -1);
+    // 删除一半后其余元素仍然可以找到 (检验 backward shift)
+    for (int i = 0; i < CACHE_CAPACITY; i += 2)
+        ASSERT_TRUE(table.del(i % 7, i));
+    ASSERT_FALSE(table.del(0, 0));
+    for (int i = 0; i < CACHE_CAPACITY; i++)
+        ASSERT_EQ(table.find(i % 7, i), (i & 1) ? i : -1);
+    for (int i = 0; i < CACHE_CAPACITY; i += 2) table.insert(i % 7, i, i);
+    for (int i = 0; i < CACHE_CAPACITY; i++)
+        ASSERT_EQ(table.find(i % 7, i), i);
+}
+
+// 命中路径的查找延迟: 旧的链表 HashMap 与开放寻址页表对比
+TEST(FSTest, PageTableBenchmark) {
+    const int lookups = 10000000;
+    std::mt19937 rng(2023);
+    std::vector<std::pair<int, int>> keys;
+    for (int i = 0; i < CACHE_CAPACITY; i++)
+        keys.push_back(std::make_pair(rng() % 16, rng() % 100000));
+    std::vector<int> order(lookups);
+    for (int i = 0; i < lookups; i++) order[i] = rng() % CACHE_CAPACITY;
+
+    dbs::utils::HashMap<dbs::utils::HashItemTwoInt> hash_map;
+    dbs::fs::PageTable page_table(CACHE_CAPACITY);
+    for (int i = 0; i < CACHE_CAPACITY; i++) {
+        if (page_table.find(keys[i].first, keys[i].second) != -1) continue;
+        hash_map.insert(
+            dbs::utils::HashItemTwoInt(keys[i].first, keys[i].second, i));
+        page_table.insert(keys[i].first, keys[i].second, i);
+    }
+
+    long long hash_map_sum = 0, page_table_sum = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        auto& key = keys[order[i]];
+        hash_map_sum +=
+            hash_map.find(dbs::utils::HashItemTwoInt(key.first, key.second))
+                .val;
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        auto& key = keys[order[i]];
+        page_table_sum += page_table.find(key.first, key.second);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    ASSERT_EQ(hash_map_sum, page_table_sum);
+
+    double hash_map_ns =
+        std::chrono::duration<double, std::nano>(mid - start).count() /
+        lookups;
+    double page_table_ns =
+        std::chrono::duration<double, std::nano>(end - mid).count() / lookups;
+    std::cout << "HashMap:   " << hash_map_ns << " ns/lookup" << std::endl;
+    std::cout << "PageTable: " << page_table_ns << " ns/lookup" << std::endl;
+}
+
+TEST(FSTest, FindReplace) {
+    dbs::fs::LRUReplace replace(4);
+    ASSERT_EQ(replace.find(), 0);
+    ASSERT_EQ(replace.find(), 1);
+    ASSERT_EQ(replace.find(), 2);
+    ASSERT_EQ(replace.find(), 3);
+    replace.access(0);
+    ASSERT_EQ(replace.find(), 1);  // 1 最久未访问
+    replace.free(3);
+    ASSERT_EQ(replace.find(), 3);  // 释放的帧优先复用
+    ASSERT_EQ(replace.find(), 2);
+    replace.hit();
+    auto stats = replace.getStats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 7);
+    EXPECT_EQ(stats.evictions, 2);
+}
+
+// 回放 "顺序扫描 + 索引点查" 的混合访问序列, 输出各替换策略的命中率
+TEST(FSTest, ReplacePolicyBenchmark) {
+    const int capacity = 1000;
+    const int hot_pages = 600;    // 索引页, 反复点查
+    const int scan_pages = 5000;  // 表数据页, 每轮扫描一遍
+    const int rounds = 20;
+    std::mt19937 rng(2023);
+    std::vector<std::pair<int, int>> trace;
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < scan_pages; i++) {
+            trace.push_back(std::make_pair(1, i));
+            if (i % 4 == 0) {
+                trace.push_back(std::make_pair(2, 0));  // 根节点
+                trace.push_back(std::make_pair(2, 1 + rng() % hot_pages));
+            }
+        }
+    }
+
+    std::pair<std::string, dbs::fs::ReplacePolicy> policies[] = {
+        {"lru", dbs::fs::ReplacePolicy::LRU},
+        {"clock", dbs::fs::ReplacePolicy::CLOCK},
+        {"lru2", dbs::fs::ReplacePolicy::LRU_K},
+        {"2q", dbs::fs::ReplacePolicy::TWO_Q}};
+    double lru_ratio = 0;
+    for (auto& policy : policies) {
+        dbs::fs::FindReplace* replace =
+            dbs::fs::FindReplace::create(policy.second, capacity);
+        dbs::fs::PageTable table(capacity);
+        std::vector<std::pair<int, int>> location(capacity,
+                                                  std::make_pair(-1, -1));
+        int last_index = -1;
+        for (auto& page : trace) {
+            int index = table.find(page.first, page.second);
+            if (index != -1) {
+                replace->hit();
+                if (index != last_index) replace->access(index);
+            } else {
+                index = replace->find();
+                if (location[index].first != -1)
+                    table.del(location[index].first, location[index].second);
+                table.insert(page.first, page.second, index);
+                location[index] = page;
+            }
+            last_index = index;
+        }
+        auto stats = replace->getStats();
+        ASSERT_EQ(stats.hits + stats.misses, (long long)trace.size());
+        double ratio = (double)stats.hits / trace.size();
+        std::cout << policy.first << ": hit ratio " << ratio << ", evictions "
+                  << stats.evictions << std::endl;
+        if (policy.second == dbs::fs::ReplacePolicy::LRU) lru_ratio = ratio;
+        if (policy.second == dbs::fs::ReplacePolicy::LRU_K ||
+            policy.second == dbs::fs::ReplacePolicy::TWO_Q) {
+            EXPECT_GT(ratio, lru_ratio);
+        }
+        delete replace;
+    }
+}
+
+TEST(FSTest, SmallBuffer) {
+    // 缓存页数不是 32 的倍数, 且远小于访问的页数
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm, 33);
+    ASSERT_EQ(bpm->getCapacity(), 33);
+    fm->createFile("testfile3.txt");
+    int fileID = fm->openFile("testfile3.txt");
+    ASSERT_NE(fileID, -1);
+    for (int pageID = 0; pageID < 200; pageID++) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        ASSERT_TRUE(index >= 0 && index < 33);
+        b[0] = pageID;
+        b[BUF_PER_PAGE - 1] = pageID;
+        bpm->markDirty(index);
+    }
+    for (int pageID = 199; pageID >= 0; pageID--) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        ASSERT_EQ(b[0], pageID);
+        ASSERT_EQ(b[BUF_PER_PAGE - 1], pageID);
+        bpm->access(index);
+    }
+    auto stats = bpm->getStats();
+    EXPECT_EQ(stats.misses, 200 + 200 - 33);
+    EXPECT_EQ(stats.hits, 33);
+    bpm->close();
+    fm->closeFile(fileID);
+    fm->deleteFile("testfile3.txt");
+    delete bpm;
+    delete fm;
+}
+
+// 后台写回: 数据正确, 并输出前台写入耗时 (同步写回 vs 后台写回)
+TEST(FSTest, BackgroundFlusher) {
+    const int pages = 20000;
+    for (int with_flusher = 0; with_flusher < 2; with_flusher++) {
+        dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+        dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm, 1024);
+        if (with_flusher) bpm->startFlusher(1);
+        fm->createFile("testfile4.txt");
+        int fileID = fm->openFile("testfile4.txt");
+        ASSERT_NE(fileID, -1);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int pageID = 0; pageID < pages; pageID++) {
+            int index;
+            BufType b = bpm->getPage(fileID, pageID, index);
+            for (int i = 0; i < BUF_PER_PAGE; i += 64) b[i] = pageID + i;
+            bpm->markDirty(index);
+            // 修改仍在缓存中的旧页, 检验写回期间被再次修改的页不会丢失
+            if (pageID >= 100 && pageID % 7 == 0) {
+                b = bpm->getPage(fileID, pageID - 100, index);
+                b[1] = pageID;
+                bpm->markDirty(index);
+            }
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        std::cout << (with_flusher ? "background" : "synchronous")
+                  << " write-back: "
+                  << std::chrono::duration<double, std::milli>(end - start)
+                         .count()
+                  << " ms" << std::endl;
+        bpm->stopFlusher();
+        bpm->close();
+        fm->closeFile(fileID);
+        delete bpm;
+
+        bpm = new dbs::fs::BufPageManager(fm, 1024);
+        fileID = fm->openFile("testfile4.txt");
+        for (int pageID = 0; pageID < pages; pageID++) {
+            int index;
+            BufType b = bpm->getPage(fileID, pageID, index);
+            for (int i = 0; i < BUF_PER_PAGE; i += 64)
+                ASSERT_EQ(b[i], pageID + i);
+            if (pageID + 100 < pages && (pageID + 100) % 7 == 0) {
+                ASSERT_EQ(b[1], pageID + 100);
+            }
+            bpm->access(index);
+        }
+        bpm->close();
+        fm->closeFile(fileID);
+        fm->deleteFile("testfile4.txt");
+        delete bpm;
+        delete fm;
+    }
+}
+
+// 后台写回跳过调用者手上 (getPage 之后 markDirty 之前) 的页
+TEST(FSTest, FlusherSkipsPinnedPage) {
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm, 1024);
+    bpm->startFlusher(1);
+    fm->createFile("testfile5.txt");
+    int fileID = fm->openFile("testfile5.txt");
+    ASSERT_NE(fileID, -1);
+    auto ageAndWait = [&]() {
+        // 访问足够多的其它页, 再等几轮写回
+        for (int pageID = 1; pageID <= 2 * FLUSH_MIN_AGE; pageID++) {
+            int index;
+            bpm->getPage(fileID, pageID, index);
+            bpm->access(index);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    };
+    auto onDisk = [&]() {
+        unsigned int page[BUF_PER_PAGE] = {};
+        fm->readPage(fileID, 0, page, 0);
+        return page[0];
+    };
+    int index;
+    BufType b = bpm->getPage(fileID, 0, index);
+    b[0] = 1;
+    bpm->markDirty(index);
+    ageAndWait();
+    EXPECT_EQ(onDisk(), 1u);
+
+    // 脏页再次被取出修改时, 修改到一半的内容不会被写回,
+    // markDirty 之后才写回
+    b = bpm->getPage(fileID, 0, index);
+    b[0] = 2;
+    bpm->markDirty(index);
+    b = bpm->getPage(fileID, 0, index);
+    b[0] = 3;
+    ageAndWait();
+    EXPECT_EQ(onDisk(), 1u);
+    bpm->markDirty(index);
+    ageAndWait();
+    EXPECT_EQ(onDisk(), 3u);
+
+    bpm->stopFlusher();
+    bpm->close();
+    fm->closeFile(fileID);
+    fm->deleteFile("testfile5.txt");
+    delete bpm;
+    delete fm;
+}
+
+TEST(FSTest, ReadAhead) {
+    const int pages = 1000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm, 256);
+    fm->createFile("testfile10.txt");
+    int fileID = fm->openFile("testfile10.txt");
+    ASSERT_NE(fileID, -1);
+    for (int pageID = 0; pageID < pages; pageID++) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        b[0] = pageID;
+        b[BUF_PER_PAGE - 1] = pageID * 3;
+        bpm->markDirty(index);
+    }
+    bpm->close();
+
+    // 顺序扫描: 除前两页外的缺页都由预读满足
+    auto before = bpm->getStats();
+    for (int pageID = 0; pageID < pages; pageID++) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        ASSERT_EQ(b[0], pageID);
+        ASSERT_EQ(b[BUF_PER_PAGE - 1], pageID * 3);
+        bpm->access(index);
+    }
+    auto after = bpm->getStats();
+    EXPECT_LT(after.misses - before.misses, pages / 10);
+    EXPECT_GT(after.prefetches - before.prefetches, pages / 2);
+    bpm->close();
+
+    // 显式预读, 包括超出文件末尾的部分
+    bpm->prefetch(fileID, pages - 10, 20);
+    before = bpm->getStats();
+    for (int pageID = pages - 10; pageID < pages; pageID++) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        ASSERT_EQ(b[0], pageID);
+        bpm->access(index);
+    }
+    after = bpm->getStats();
+    EXPECT_EQ(after.hits - before.hits, 10);
+    bpm->close();
+    fm->closeFile(fileID);
+    fm->deleteFile("testfile10.txt");
+    delete bpm;
+    delete fm;
+}
+
+TEST(FSTest, PageIOSyscalls) {
+    const int pages = 2000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    fm->createFile("testfile6.txt");
+    int fileID = fm->openFile("testfile6.txt");
+    ASSERT_NE(fileID, -1);
+    BufType buf = new unsigned int[BUF_PER_PAGE];
+    auto before = fm->getIOStats();
+    auto start = std::chrono::steady_clock::now();
+    for (int pageID = 0; pageID < pages; pageID++) {
+        buf[0] = pageID;
+        ASSERT_TRUE(fm->writePage(fileID, pageID, buf, 0));
+    }
+    for (int pageID = 0; pageID < pages; pageID++) {
+        ASSERT_TRUE(fm->readPage(fileID, pageID, buf, 0));
+        ASSERT_EQ(buf[0], pageID);
+    }
+    auto end = std::chrono::steady_clock::now();
+    auto after = fm->getIOStats();
+    // 每次缺页/写回只有一次系统调用, 不再有 lseek
+    EXPECT_EQ(after.write_calls - before.write_calls, pages);
+    EXPECT_EQ(after.read_calls - before.read_calls, pages);
+    std::cout << "page io: "
+              << (double)(after.read_calls + after.write_calls -
+                          before.read_calls - before.write_calls) /
+                     (2 * pages)
+              << " syscalls/page, "
+              << std::chrono::duration<double, std::micro>(end - start)
+                         .count() /
+                     (2 * pages)
+              << " us/page" << std::endl;
+
+    // 文件末尾之后的页读出全 0
+    buf[0] = 1;
+    ASSERT_TRUE(fm->readPage(fileID, pages + 5, buf, 0));
+    EXPECT_EQ(buf[0], 0);
+    fm->closeFile(fileID);
+    EXPECT_FALSE(fm->readPage(fileID, 0, buf, 0));
+
+    // 关闭的 fileID 被重用, 反复打开关闭不会用完描述符表
+    for (int i = 0; i < 3 * FD_TABLE_CHUNK_SIZE; i++) {
+        int reopenedID = fm->openFile("testfile6.txt");
+        ASSERT_EQ(reopenedID, fileID);
+        fm->closeFile(reopenedID);
+    }
+    EXPECT_EQ(fm->openFile("no_such_file.txt"), -1);
+    fm->deleteFile("testfile6.txt");
+    delete[] buf;
+    delete fm;
+}
+
+TEST(FSTest, AsyncIOBatch) {
+    const int pages = 4096, runs = 64;
+    dbs::fs::FileManager* sync_fm = new dbs::fs::FileManager();
+    dbs::fs::FileManager* ring_fm = new dbs::fs::FileManager();
+    bool has_ring = ring_fm->enableAsyncIO();
+    sync_fm->createFile("testfile7.txt");
+    int sync_id = sync_fm->openFile("testfile7.txt");
+    int ring_id = ring_fm->openFile("testfile7.txt");
+    ASSERT_NE(sync_id, -1);
+    ASSERT_NE(ring_id, -1);
+
+    // 分散的若干段, 每段 1~4 页, 一次提交写入
+    std::mt19937 rng(2023);
+    BufType data = new unsigned int[(size_t)pages * BUF_PER_PAGE];
+    std::vector<BufType> bufs(pages);
+    for (int i = 0; i < pages; i++) {
+        bufs[i] = data + (size_t)i * BUF_PER_PAGE;
+        bufs[i][0] = i;
+        bufs[i][BUF_PER_PAGE - 1] = i * 7;
+    }
+    std::vector<dbs::fs::PageRequest> reqs;
+    for (int r = 0; r < runs; r++) {
+        int page = r * (pages / runs), count = 1 + rng() % 4;
+        reqs.push_back(
+            dbs::fs::PageRequest{ring_id, page, &bufs[page], count, 0});
+    }
+    ASSERT_TRUE(ring_fm->writePagesBatch(reqs.data(), reqs.size()));
+
+    // 读回, 包括超出文件末尾的一段
+    BufType back = new unsigned int[(size_t)pages * BUF_PER_PAGE];
+    for (int i = 0; i < pages; i++) bufs[i] = back + (size_t)i * BUF_PER_PAGE;
+    reqs.push_back(
+        dbs::fs::PageRequest{ring_id, pages + 10, &bufs[0], 2, 0});
+    for (auto* fm : {ring_fm, sync_fm}) {
+        int fileID = fm == ring_fm ? ring_id : sync_id;
+        for (auto& req : reqs) req.fileID = fileID;
+        memset(back, 0xff, (size_t)pages * PAGE_SIZE);
+        fm->readPagesBatch(reqs.data(), reqs.size());
+        for (int r = 0; r < runs; r++) {
+            ASSERT_EQ(reqs[r].done, reqs[r].count);
+            for (int k = 0; k < reqs[r].count; k++) {
+                int page = reqs[r].pageID + k;
+                ASSERT_EQ(bufs[page][0], page);
+                ASSERT_EQ(bufs[page][BUF_PER_PAGE - 1], page * 7);
+            }
+        }
+        EXPECT_EQ(reqs[runs].done, 0);
+    }
+    reqs.pop_back();
+
+    // 每批 runs 个单页读, 比较同步读和 io_uring
+    for (int r = 0; r < runs; r++) reqs[r].count = 1;
+    for (auto* fm : {sync_fm, ring_fm}) {
+        int fileID = fm == ring_fm ? ring_id : sync_id;
+        for (auto& req : reqs) req.fileID = fileID;
+        auto before = fm->getIOStats();
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 100; round++)
+            fm->readPagesBatch(reqs.data(), reqs.size());
+        auto end = std::chrono::steady_clock::now();
+        auto after = fm->getIOStats();
+        long long calls = after.read_calls + after.ring_calls -
+                          before.read_calls - before.ring_calls;
+        std::cout << (fm == ring_fm && has_ring ? "io_uring: " : "sync:     ")
+                  << (double)calls / (100 * runs) << " syscalls/page, "
+                  << std::chrono::duration<double, std::micro>(end - start)
+                             .count() /
+                         (100 * runs)
+                  << " us/page" << std::endl;
+        if (fm == ring_fm && has_ring) {
+            EXPECT_LT(calls, 100 * runs);
+        }
+    }
+
+    sync_fm->closeFile(sync_id);
+    ring_fm->closeFile(ring_id);
+    sync_fm->deleteFile("testfile7.txt");
+    delete[] data;
+    delete[] back;
+    delete sync_fm;
+    delete ring_fm;
+}
+
+TEST(FSTest, ReadOnlyMapping) {
+    const int pages = 2000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm, 256);
+    fm->createFile("testfile8.txt");
+    int fileID = fm->openFile("testfile8.txt");
+    ASSERT_NE(fileID, -1);
+    for (int pageID = 0; pageID < pages; pageID++) {
+        int index;
+        BufType b = bpm->getPage(fileID, pageID, index);
+        b[0] = pageID;
+        b[BUF_PER_PAGE - 1] = pageID * 5;
+        bpm->markDirty(index);
+    }
+    bpm->closeFile(fileID);
+    fm->closeFile(fileID);
+
+    // 同一个文件分别用缓存和只读映射扫描
+    dbs::fs::BufPageManager* ro_bpm =
+        new dbs::fs::BufPageManager(fm, 256, dbs::fs::ReplacePolicy::LRU,
+                                    false, true);
+    for (auto* cur : {bpm, ro_bpm}) {
+        fileID = fm->openFile("testfile8.txt");
+        auto before = cur->getStats();
+        auto start = std::chrono::steady_clock::now();
+        long long sum = 0;
+        for (int round = 0; round < 5; round++) {
+            for (int pageID = 0; pageID < pages; pageID++) {
+                int index;
+                BufType b = cur->getPage(fileID, pageID, index);
+                ASSERT_EQ(b[0], pageID);
+                sum += b[BUF_PER_PAGE - 1];
+                if (cur == ro_bpm) {
+                    ASSERT_EQ(index, -1);
+                }
+                cur->access(index);
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        EXPECT_EQ(sum, 5LL * 5 * pages * (pages - 1) / 2);
+        auto after = cur->getStats();
+        if (cur == ro_bpm) {
+            EXPECT_EQ(after.misses, before.misses);
+        }
+        std::cout << (cur == ro_bpm ? "mmap:   " : "buffer: ")
+                  << std::chrono::duration<double, std::micro>(end - start)
+                             .count() /
+                         (5 * pages)
+                  << " us/page" << std::endl;
+        cur->closeFile(fileID);
+        fm->closeFile(fileID);
+    }
+
+    // 文件末尾之后为全 0, 空文件仍然使用缓存
+    fileID = fm->openFile("testfile8.txt");
+    int index;
+    BufType b = ro_bpm->getPage(fileID, pages + 3, index);
+    EXPECT_EQ(index, -1);
+    EXPECT_EQ(b[0], 0);
+    ro_bpm->closeFile(fileID);
+    fm->closeFile(fileID);
+    fm->createFile("testfile9.txt");
+    fileID = fm->openFile("testfile9.txt");
+    b = ro_bpm->getPage(fileID, 0, index);
+    EXPECT_NE(index, -1);
+    b[0] = 42;
+    ro_bpm->markDirty(index);
+    ro_bpm->closeFile(fileID);
+    fm->closeFile(fileID);
+    fm->deleteFile("testfile8.txt");
+    fm->deleteFile("testfile9.txt");
+    delete ro_bpm;
+    delete bpm;
+    delete fm;
+}
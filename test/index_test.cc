@@ -1,12 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <map>
+#include <random>
+#include <tuple>
 #include <vector>
 
 #include "common/Config.hpp"
 #include "fs/BufPageManager.hpp"
 #include "fs/FileManager.hpp"
+#include "index/IndexCursor.hpp"
 #include "index/IndexManager.hpp"
 #include "index/IndexType.hpp"
 
@@ -569,4 +574,434 @@ TEST(IndexTest, ExtensiveTest) {
     delete im;
     delete bpm;
     delete fm;
-}
\ No newline at end of file
+}
+TEST(IndexTest, LookupThroughput) {
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::index::IndexManager* im = new dbs::index::IndexManager(fm, bpm);
+    if (!fm->existFolder("./data")) {
+        fm->createFolder("./data");
+    }
+    std::string str_path = "./data/test_lookup.txt";
+    int key_num = 2;
+    int total_insert = 200000;
+    im->initializeIndexFile(str_path.c_str(), key_num);
+
+    std::mt19937 rng(2023);
+    std::vector<int> keys(total_insert);
+    for (int i = 0; i < total_insert; i++) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < total_insert; i++) {
+        dbs::index::IndexValue insert_value(i, i % 480,
+                                            std::vector<int>{keys[i], 7});
+        ASSERT_TRUE(im->insertIndex(str_path.c_str(), insert_value));
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+
+    // 点查询, 页都在缓存中, 测的是每层节点上的查找
+    int lookups = 500000;
+    std::vector<dbs::index::IndexValue> result;
+    long long found = 0;
+    for (int i = 0; i < lookups; i++) {
+        int key = rng() % (total_insert * 2);
+        dbs::index::IndexValue search_value(-1, -1, std::vector<int>{key, 7});
+        ASSERT_TRUE(im->searchIndex(str_path.c_str(), search_value, result));
+        if (key < total_insert) {
+            ASSERT_EQ(result.size(), 1);
+            ASSERT_EQ(keys[result[0].page_id], key);
+        } else {
+            ASSERT_EQ(result.size(), 0);
+        }
+        found += result.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    ASSERT_GT(found, 0);
+
+    double insert_seconds =
+        std::chrono::duration<double>(mid - start).count();
+    double lookup_seconds = std::chrono::duration<double>(end - mid).count();
+    std::cout << "inserts/sec: " << total_insert / insert_seconds
+              << std::endl;
+    std::cout << "lookups/sec: " << lookups / lookup_seconds << std::endl;
+
+    ASSERT_TRUE(im->deleteIndexFile(str_path.c_str()));
+    delete im;
+    delete bpm;
+    delete fm;
+}
+
+TEST(IndexTest, BulkLoad) {
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::index::IndexManager* im = new dbs::index::IndexManager(fm, bpm);
+    if (!fm->existFolder("./data")) {
+        fm->createFolder("./data");
+    }
+    std::string insert_path = "./data/test_bulk_insert.txt";
+    std::string bulk_path = "./data/test_bulk_load.txt";
+    int key_num = 2;
+    int total_insert = 200000;
+    int range = 5000;
+    im->initializeIndexFile(insert_path.c_str(), key_num);
+    im->initializeIndexFile(bulk_path.c_str(), key_num);
+
+    std::mt19937 rng(2023);
+    std::vector<dbs::index::IndexValue> index_values;
+    for (int i = 0; i < total_insert; i++) {
+        index_values.push_back(dbs::index::IndexValue(
+            i, i % 480,
+            std::vector<int>{(int)(rng() % range), (int)(rng() % 3)}));
+    }
+
+    // 逐条插入
+    auto start = std::chrono::high_resolution_clock::now();
+    for (auto& index_value : index_values) {
+        ASSERT_TRUE(im->insertIndex(insert_path.c_str(), index_value));
+    }
+    auto mid = std::chrono::high_resolution_clock::now();
+    // 排序后批量建树
+    std::vector<dbs::index::IndexValue> sorted_values = index_values;
+    dbs::index::sortIndexValues(sorted_values);
+    ASSERT_TRUE(im->bulkLoadIndex(bulk_path.c_str(), sorted_values));
+    auto end = std::chrono::high_resolution_clock::now();
+
+    double insert_seconds =
+        std::chrono::duration<double>(mid - start).count();
+    double bulk_seconds = std::chrono::duration<double>(end - mid).count();
+    std::cout << "insertIndex:   " << total_insert / insert_seconds
+              << " rows/sec" << std::endl;
+    std::cout << "bulkLoadIndex: " << total_insert / bulk_seconds
+              << " rows/sec" << std::endl;
+
+    // 两棵树的查询结果 (包括相同键的顺序) 相同
+    auto checkSame = [&](const std::vector<int>& low,
+                         const std::vector<int>& high) {
+        std::vector<dbs::index::IndexValue> insert_results, bulk_results;
+        ASSERT_TRUE(im->searchIndexInRanges(
+            insert_path.c_str(), dbs::index::IndexValue(-1, -1, low),
+            dbs::index::IndexValue(-1, -1, high), insert_results));
+        ASSERT_TRUE(im->searchIndexInRanges(
+            bulk_path.c_str(), dbs::index::IndexValue(-1, -1, low),
+            dbs::index::IndexValue(-1, -1, high), bulk_results));
+        ASSERT_EQ(insert_results.size(), bulk_results.size());
+        for (size_t i = 0; i < insert_results.size(); i++) {
+            ASSERT_EQ(insert_results[i].page_id, bulk_results[i].page_id);
+            ASSERT_EQ(insert_results[i].slot_id, bulk_results[i].slot_id);
+            ASSERT_EQ(insert_results[i].key, bulk_results[i].key);
+        }
+    };
+    checkSame({INT_MIN, INT_MIN}, {INT_MAX, INT_MAX});
+    for (int i = 0; i < 200; i++) {
+        int key = rng() % range;
+        checkSame({key, 1}, {key, 1});
+        checkSame({key, 0}, {key + (int)(rng() % 50), 2});
+    }
+
+    // 批量建成的树上继续插入和删除
+    for (int i = 0; i < 20000; i++) {
+        if (rng() % 2 == 0) {
+            dbs::index::IndexValue insert_value(
+                total_insert + i, 0,
+                std::vector<int>{(int)(rng() % range), (int)(rng() % 3)});
+            ASSERT_TRUE(im->insertIndex(insert_path.c_str(), insert_value));
+            ASSERT_TRUE(im->insertIndex(bulk_path.c_str(), insert_value));
+        } else {
+            auto& delete_value = index_values[rng() % total_insert];
+            bool deleted =
+                im->deleteIndex(insert_path.c_str(), delete_value, true);
+            ASSERT_EQ(deleted,
+                      im->deleteIndex(bulk_path.c_str(), delete_value, true));
+        }
+    }
+    checkSame({INT_MIN, INT_MIN}, {INT_MAX, INT_MAX});
+
+    // 空的索引项, 以及重建已有的索引
+    ASSERT_TRUE(im->bulkLoadIndex(bulk_path.c_str(), {}));
+    std::vector<dbs::index::IndexValue> results;
+    ASSERT_TRUE(im->searchIndexInRanges(
+        bulk_path.c_str(), dbs::index::IndexValue(-1, -1, {INT_MIN, INT_MIN}),
+        dbs::index::IndexValue(-1, -1, {INT_MAX, INT_MAX}), results));
+    ASSERT_EQ(results.size(), 0);
+    ASSERT_FALSE(im->bulkLoadIndex(bulk_path.c_str(),
+                                   {dbs::index::IndexValue(0, 0, 3)}));
+
+    ASSERT_TRUE(im->deleteIndexFile(insert_path.c_str()));
+    ASSERT_TRUE(im->deleteIndexFile(bulk_path.c_str()));
+    delete im;
+    delete bpm;
+    delete fm;
+}
+
+TEST(IndexTest, TypedKeys) {
+    using dbs::record::DataTypeName;
+    using dbs::record::DataValue;
+    std::mt19937 rng(2023);
+    auto encode = [](const DataValue& value) {
+        std::vector<int> key;
+        dbs::index::appendIndexKey(value, key);
+        EXPECT_EQ(key.size(), dbs::index::getIndexKeyLength(value.type_name));
+        return key;
+    };
+
+    // 编码按 int 逐个比较 (std::vector<int> 的字典序) 与原值的大小关系一致
+    std::vector<double> floats = {0.0,   -0.0,     1.5,   -1.5, 1e-300,
+                                  -1e300, 1e300,   0.125, -3,   FLOAT_MAX,
+                                  -FLOAT_MAX, 7e-5, -7e-5};
+    for (int i = 0; i < 200; i++)
+        floats.push_back(((int)(rng() % 20001) - 10000) / 64.0);
+    for (double a : floats) {
+        for (double b : floats) {
+            auto key_a = encode(DataValue(DataTypeName::FLOAT, false, a));
+            auto key_b = encode(DataValue(DataTypeName::FLOAT, false, b));
+            ASSERT_EQ(a < b, key_a < key_b);
+            ASSERT_EQ(a == b, key_a == key_b);
+        }
+    }
+
+    std::vector<dbs::record::DateValue> dates = {{0, 1, 1},    {1999, 12, 31},
+                                                 {2000, 1, 1}, {2000, 1, 2},
+                                                 {2000, 2, 1}, {9999, 12, 31}};
+    for (int i = 0; i < 200; i++)
+        dates.push_back({1990 + (int)(rng() % 40), 1 + (int)(rng() % 12),
+                         1 + (int)(rng() % 28)});
+    auto dateTuple = [](const dbs::record::DateValue& date) {
+        return std::make_tuple(date.year, date.month, date.day);
+    };
+    for (auto& a : dates) {
+        for (auto& b : dates) {
+            auto key_a = encode(DataValue(DataTypeName::DATE, false, a));
+            auto key_b = encode(DataValue(DataTypeName::DATE, false, b));
+            ASSERT_EQ(dateTuple(a) < dateTuple(b), key_a < key_b);
+            ASSERT_EQ(dateTuple(a) == dateTuple(b), key_a == key_b);
+        }
+    }
+
+    // 字符串只保留前缀: 不同的值编码可能相同, 但不会颠倒顺序
+    std::vector<std::string> strings = {"",
+                                        "a",
+                                        "ab",
+                                        "abc",
+                                        "b",
+                                        "\xff",
+                                        "\x7f",
+                                        "\x80",
+                                        "same-prefix-16b-1",
+                                        "same-prefix-16b-2"};
+    for (int i = 0; i < 200; i++) {
+        std::string s;
+        int length = rng() % 24;
+        for (int j = 0; j < length; j++) s.push_back('a' + rng() % 4);
+        strings.push_back(s);
+    }
+    for (auto& a : strings) {
+        for (auto& b : strings) {
+            auto key_a = encode(DataValue(DataTypeName::VARCHAR, false, a));
+            auto key_b = encode(DataValue(DataTypeName::VARCHAR, false, b));
+            if (a < b) {
+                ASSERT_LE(key_a, key_b);
+            }
+            if (a == b) {
+                ASSERT_EQ(key_a, key_b);
+            }
+            if (a.substr(0, INDEX_VARCHAR_PREFIX_BYTE_LEN) <
+                b.substr(0, INDEX_VARCHAR_PREFIX_BYTE_LEN)) {
+                ASSERT_LT(key_a, key_b);
+            }
+        }
+    }
+    ASSERT_EQ(encode(DataValue(DataTypeName::VARCHAR, false,
+                               std::string("same-prefix-16b-1"))),
+              encode(DataValue(DataTypeName::VARCHAR, false,
+                               std::string("same-prefix-16b-2"))));
+
+    // FLOAT 键的索引上做范围查询
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::index::IndexManager* im = new dbs::index::IndexManager(fm, bpm);
+    if (!fm->existFolder("./data")) {
+        fm->createFolder("./data");
+    }
+    std::string str_path = "./data/test_typed.txt";
+    im->initializeIndexFile(
+        str_path.c_str(), dbs::index::getIndexKeyLength(DataTypeName::FLOAT));
+    for (size_t i = 0; i < floats.size(); i++) {
+        dbs::index::IndexValue insert_value(i, 0, 0);
+        dbs::index::appendIndexKey(
+            DataValue(DataTypeName::FLOAT, false, floats[i]), insert_value.key);
+        ASSERT_TRUE(im->insertIndex(str_path.c_str(), insert_value));
+    }
+    for (int i = 0; i < 100; i++) {
+        double low = floats[rng() % floats.size()];
+        double high = floats[rng() % floats.size()];
+        dbs::index::IndexValue low_value(-1, -1, 0), high_value(-1, -1, 0);
+        dbs::index::appendIndexKey(DataValue(DataTypeName::FLOAT, false, low),
+                                   low_value.key);
+        dbs::index::appendIndexKey(DataValue(DataTypeName::FLOAT, false, high),
+                                   high_value.key);
+        std::vector<dbs::index::IndexValue> results;
+        ASSERT_TRUE(im->searchIndexInRanges(str_path.c_str(), low_value,
+                                            high_value, results));
+        int expected = 0;
+        for (double value : floats) expected += low <= value && value <= high;
+        ASSERT_EQ(results.size(), expected);
+        for (auto& result : results) {
+            ASSERT_GE(floats[result.page_id], low);
+            ASSERT_LE(floats[result.page_id], high);
+        }
+    }
+    ASSERT_TRUE(im->deleteIndexFile(str_path.c_str()));
+    delete im;
+    delete bpm;
+    delete fm;
+}
+
+TEST(IndexTest, Cursor) {
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::index::IndexManager* im = new dbs::index::IndexManager(fm, bpm);
+    if (!fm->existFolder("./data")) {
+        fm->createFolder("./data");
+    }
+    std::string path_a = "./data/test_cursor_a.txt";
+    std::string path_b = "./data/test_cursor_b.txt";
+    int total_insert = 100000;
+    int range = 20000;
+    im->initializeIndexFile(path_a.c_str(), 1);
+    im->initializeIndexFile(path_b.c_str(), 1);
+
+    std::mt19937 rng(2023);
+    std::vector<dbs::index::IndexValue> index_values;
+    for (int i = 0; i < total_insert; i++) {
+        index_values.push_back(dbs::index::IndexValue(
+            i, i % 480, std::vector<int>{(int)(rng() % range)}));
+        ASSERT_TRUE(im->insertIndex(path_b.c_str(), index_values.back()));
+    }
+    dbs::index::sortIndexValues(index_values);
+    ASSERT_TRUE(im->bulkLoadIndex(path_a.c_str(), index_values));
+
+    auto bound = [](std::vector<int> key) {
+        return dbs::index::IndexValue(-1, -1, key);
+    };
+
+    // 与 searchIndexInRanges 的结果逐项相同
+    auto checkRange = [&](const std::string& path, int low, int high) {
+        std::vector<dbs::index::IndexValue> results;
+        ASSERT_TRUE(im->searchIndexInRanges(path.c_str(), bound({low}),
+                                            bound({high}), results));
+        dbs::index::IndexCursor cursor(im);
+        ASSERT_TRUE(cursor.seek(path.c_str(), bound({low}), bound({high})));
+        dbs::index::IndexValue index_value;
+        int n = 0;
+        while (cursor.next(index_value)) {
+            ASSERT_LT(n, results.size());
+            ASSERT_EQ(index_value.page_id, results[n].page_id);
+            ASSERT_EQ(index_value.slot_id, results[n].slot_id);
+            ASSERT_EQ(index_value.key, results[n].key);
+            n++;
+        }
+        ASSERT_EQ(n, results.size());
+        ASSERT_FALSE(cursor.next(index_value));
+        cursor.close();
+    };
+    checkRange(path_a, INT_MIN, INT_MAX);
+    checkRange(path_b, INT_MIN, INT_MAX);
+    checkRange(path_a, range, INT_MAX);
+    for (int i = 0; i < 100; i++) {
+        int key = rng() % range;
+        checkRange(path_a, key, key);
+        checkRange(path_b, key, key + (int)(rng() % 500));
+    }
+
+    // 两个游标交替前进, 读到的项互不影响, 可以在中途结束
+    {
+        dbs::index::IndexCursor cursor_a(im), cursor_b(im);
+        auto low = bound({INT_MIN}), high = bound({INT_MAX});
+        ASSERT_TRUE(cursor_a.seek(path_a.c_str(), low, high));
+        ASSERT_TRUE(cursor_b.seek(path_b.c_str(), low, high));
+        dbs::index::IndexValue value_a, value_b;
+        for (int i = 0; i < 5000; i++) {
+            ASSERT_TRUE(cursor_a.next(value_a));
+            ASSERT_TRUE(cursor_b.next(value_b));
+            ASSERT_EQ(value_a.key, index_values[i].key);
+            ASSERT_EQ(value_b.key, index_values[i].key);
+            ASSERT_EQ(value_a.page_id, value_b.page_id);
+        }
+        cursor_a.close();
+        ASSERT_FALSE(cursor_a.next(value_a));
+        ASSERT_TRUE(cursor_b.next(value_b));
+        ASSERT_EQ(value_b.page_id, index_values[5000].page_id);
+        cursor_b.close();
+    }
+
+    // key数量不符时失败, 空的范围没有项
+    dbs::index::IndexCursor cursor(im);
+    dbs::index::IndexValue index_value;
+    ASSERT_FALSE(cursor.seek(path_a.c_str(), bound({0, 0}), bound({1, 1})));
+    ASSERT_FALSE(cursor.next(index_value));
+    ASSERT_TRUE(
+        cursor.seek(path_a.c_str(), bound({range}), bound({INT_MAX})));
+    ASSERT_FALSE(cursor.next(index_value));
+    ASSERT_TRUE(cursor.seek(path_a.c_str(), bound({5}), bound({4})));
+    ASSERT_FALSE(cursor.next(index_value));
+
+    ASSERT_TRUE(im->deleteIndexFile(path_a.c_str()));
+    ASSERT_TRUE(im->deleteIndexFile(path_b.c_str()));
+    delete im;
+    delete bpm;
+    delete fm;
+}
+
+TEST(IndexTest, SearchBatch) {
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::index::IndexManager* im = new dbs::index::IndexManager(fm, bpm);
+    if (!fm->existFolder("./data")) {
+        fm->createFolder("./data");
+    }
+    std::string path = "./data/test_search_batch.txt";
+    int key_num = 2;
+    int range = 3000;
+    im->initializeIndexFile(path.c_str(), key_num);
+
+    std::mt19937 rng(2023);
+    for (int i = 0; i < 50000; i++) {
+        ASSERT_TRUE(im->insertIndex(
+            path.c_str(),
+            dbs::index::IndexValue(
+                i, 0,
+                std::vector<int>{(int)(rng() % range), (int)(rng() % 3)})));
+    }
+
+    // 稀疏和密集的键, 以及比所有键都小或都大的键, 与逐个查找的结果相同
+    for (int round = 0; round < 20; round++) {
+        int span = round % 2 == 0 ? range + 10 : 50;
+        int base = rng() % range;
+        std::vector<std::vector<int>> keys;
+        for (int i = 0; i < 500; i++)
+            keys.push_back({base + (int)(rng() % span) - 5, (int)(rng() % 4)});
+        keys.push_back({INT_MIN, INT_MIN});
+        keys.push_back({INT_MAX, INT_MAX});
+        std::sort(keys.begin(), keys.end());
+        std::vector<bool> found;
+        ASSERT_TRUE(im->searchIndexBatch(path.c_str(), keys, found));
+        ASSERT_EQ(found.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            std::vector<dbs::index::IndexValue> results;
+            ASSERT_TRUE(im->searchIndex(
+                path.c_str(), dbs::index::IndexValue(-1, -1, keys[i]),
+                results));
+            ASSERT_EQ(found[i], results.size() > 0);
+        }
+    }
+
+    std::vector<bool> found;
+    ASSERT_TRUE(im->searchIndexBatch(path.c_str(), {}, found));
+    ASSERT_EQ(found.size(), 0);
+    ASSERT_FALSE(im->searchIndexBatch(path.c_str(), {{1}}, found));
+
+    ASSERT_TRUE(im->deleteIndexFile(path.c_str()));
+    delete im;
+    delete bpm;
+    delete fm;
+}
@@ -17,4 +17,92 @@ TEST(InterpreterTest, ParserFail) {
     auto result = parser->parse("CREATE DATABASE DB;");
 
     assert(false);
-}
\ No newline at end of file
+}
+TEST(InterpreterTest, UniqueVarcharPrefix) {
+    dbs::fs::FileManager *fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager *bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager *rm = new dbs::record::RecordManager(fm, bpm);
+    dbs::index::IndexManager *im = new dbs::index::IndexManager(fm, bpm);
+    dbs::system::SystemManager *sm = new dbs::system::SystemManager(fm, rm, im);
+    dbs::parser::Parser *parser = new dbs::parser::Parser(rm, im, sm);
+    parser->setOutputMode(false);
+    sm->cleanSystem();
+    sm->initializeSystem();
+
+    ASSERT_TRUE(parser->parse("CREATE DATABASE unique_prefix;"));
+    ASSERT_TRUE(parser->parse("USE unique_prefix;"));
+    // 前 16 个字节相同, 索引键相同但值不同
+    ASSERT_TRUE(parser->parse("CREATE TABLE t (id INT, name VARCHAR(32));"));
+    ASSERT_TRUE(parser->parse(
+        "INSERT INTO t VALUES (1, 'customer_000000001'), "
+        "(2, 'customer_000000002'), (3, 'customer_0000000'), (4, NULL);"));
+    ASSERT_TRUE(parser->parse("ALTER TABLE t ADD UNIQUE u (name);"));
+    ASSERT_FALSE(
+        parser->parse("INSERT INTO t VALUES (5, 'customer_000000002');"));
+    ASSERT_TRUE(
+        parser->parse("INSERT INTO t VALUES (5, 'customer_000000003');"));
+
+    // 前缀相同的值中有真正重复的
+    ASSERT_TRUE(parser->parse("CREATE TABLE s (id INT, name VARCHAR(32));"));
+    ASSERT_TRUE(parser->parse(
+        "INSERT INTO s VALUES (1, 'customer_000000001'), "
+        "(2, 'customer_000000002'), (3, 'customer_000000001');"));
+    ASSERT_FALSE(parser->parse("ALTER TABLE s ADD UNIQUE u (name);"));
+
+    sm->cleanSystem();
+    delete parser;
+    delete sm;
+    delete im;
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(InterpreterTest, ColumnNumLimit) {
+    dbs::fs::FileManager *fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager *bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager *rm = new dbs::record::RecordManager(fm, bpm);
+    dbs::index::IndexManager *im = new dbs::index::IndexManager(fm, bpm);
+    dbs::system::SystemManager *sm = new dbs::system::SystemManager(fm, rm, im);
+    dbs::parser::Parser *parser = new dbs::parser::Parser(rm, im, sm);
+    parser->setOutputMode(false);
+    sm->cleanSystem();
+    sm->initializeSystem();
+
+    auto create_table = [&](const std::string &table_name, int column_num) {
+        std::string sql = "CREATE TABLE " + table_name + " (";
+        for (int i = 0; i < column_num; i++)
+            sql += (i ? ", c" : "c") + std::to_string(i) + " INT";
+        return parser->parse(sql + ");");
+    };
+    ASSERT_TRUE(parser->parse("CREATE DATABASE column_limit;"));
+    ASSERT_TRUE(parser->parse("USE column_limit;"));
+    ASSERT_TRUE(create_table("t", MAX_COLUMN_NUM));
+    ASSERT_FALSE(create_table("s", MAX_COLUMN_NUM + 1));
+
+    // 旧版本建的列数超过上限的表, 其列的元数据与空闲页链表重叠
+    char *table_path = nullptr, *record_path = nullptr;
+    sm->getTableRecordPath(sm->getDatabaseId("column_limit"),
+                           sm->getTableId("t"), &table_path);
+    dbs::utils::concatPath(table_path, RECORD_FILE_NAME, &record_path);
+    rm->closeAllCurrentFile();
+    int file_id = fm->openFile(record_path);
+    BufType page = new unsigned int[BUF_PER_PAGE];
+    ASSERT_TRUE(fm->readPage(file_id, 0, page, 0));
+    page[4] = MAX_COLUMN_NUM + 1;
+    ASSERT_TRUE(fm->writePage(file_id, 0, page, 0));
+    fm->closeFile(file_id);
+    delete[] page;
+    EXPECT_EQ(rm->getColumnSlotNum(record_path), MAX_COLUMN_NUM + 1);
+    delete[] table_path;
+    delete[] record_path;
+    EXPECT_FALSE(parser->parse("USE column_limit;"));
+
+    sm->cleanSystem();
+    delete parser;
+    delete sm;
+    delete im;
+    delete rm;
+    delete bpm;
+    delete fm;
+}
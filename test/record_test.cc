@@ -1,10 +1,28 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+
 #include "common/Config.hpp"
 #include "fs/BufPageManager.hpp"
 #include "fs/FileManager.hpp"
 #include "record/RecordManager.hpp"
 
+// 单个条件的约束
+static dbs::system::SearchConstraint makeConstraint(
+    int column_id, dbs::record::DataTypeName type,
+    dbs::system::ConstraintType constraint_type,
+    const dbs::record::DataValue& value) {
+    dbs::system::SearchConstraint constraint;
+    constraint.column_id = column_id;
+    constraint.data_type = type;
+    constraint.constraint_types.push_back(constraint_type);
+    constraint.constraint_values.push_back(value);
+    return constraint;
+}
+
 TEST(RecordTest, Basics) {
     srand(time(0));
     dbs::fs::FileManager* fm = new dbs::fs::FileManager();
@@ -369,4 +387,994 @@ TEST(RecordTest, Basics) {
     delete rm;
     delete bpm;
     delete fm;
-}
\ No newline at end of file
+}
+TEST(RecordTest, InsertThroughput) {
+    const int total = 40000, bucket = 5000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types;
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, true,
+                                true, dbs::record::DefaultValue(), "id"));
+    column_types.push_back(dbs::record::ColumnType(
+        dbs::record::DataTypeName::VARCHAR, 10, 0, false, false,
+        dbs::record::DefaultValue(), "name"));
+    const char* path = "./data/insert_bench.txt";
+    rm->initializeRecordFile(path, column_types);
+    auto makeItem = [](int id) {
+        dbs::record::DataItem data_item;
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false, id));
+        data_item.column_ids.push_back(0);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::VARCHAR, false, "name"));
+        data_item.column_ids.push_back(1);
+        return data_item;
+    };
+
+    // 表不断变大时, 单条插入的耗时应保持不变
+    std::vector<dbs::record::RecordLocation> locations;
+    for (int start = 0; start < total; start += bucket) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int i = start; i < start + bucket; i++)
+            locations.push_back(rm->insertRecord(path, makeItem(i)));
+        auto end = std::chrono::steady_clock::now();
+        std::cout << "rows " << start << "-" << start + bucket << ": "
+                  << std::chrono::duration<double, std::micro>(end - begin)
+                             .count() /
+                         bucket
+                  << " us/insert" << std::endl;
+    }
+    int page_num = rm->getTotalPageNum(path);
+
+    // 删除的位置被之后的插入复用, 不追加新页
+    std::vector<dbs::record::RecordLocation> deleted;
+    for (int i = 0; i < total; i += 97) {
+        ASSERT_TRUE(rm->deleteRecord(path, locations[i]));
+        deleted.push_back(locations[i]);
+    }
+    for (size_t i = 0; i < deleted.size(); i++) {
+        auto location = rm->insertRecord(path, makeItem(total + i));
+        ASSERT_NE(location.page_id, -1);
+        ASSERT_LE(location.page_id, page_num);
+    }
+    EXPECT_EQ(rm->getTotalPageNum(path), page_num);
+
+    // 更新不改变空位
+    dbs::record::DataItem update_item;
+    update_item.data_values.push_back(
+        dbs::record::DataValue(dbs::record::DataTypeName::INT, false, 7));
+    update_item.column_ids.push_back(0);
+    ASSERT_TRUE(rm->updateRecord(path, locations[1], update_item));
+    dbs::record::DataItem data_item;
+    ASSERT_TRUE(rm->getRecord(path, locations[1], data_item));
+    EXPECT_EQ(data_item.data_values[0].value.int_value, 7);
+    auto location = rm->insertRecord(path, makeItem(-1));
+    EXPECT_FALSE(location.page_id == locations[1].page_id &&
+                 location.slot_id == locations[1].slot_id);
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, CompactFormat) {
+    const int total = 30000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types;
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, true,
+                                true, dbs::record::DefaultValue(), "id"));
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::FLOAT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "score"));
+    column_types.push_back(dbs::record::ColumnType(
+        dbs::record::DataTypeName::VARCHAR, 10, 0, false, false,
+        dbs::record::DefaultValue(), "name"));
+    const char* path = "./data/compact_bench.txt";
+    rm->initializeRecordFile(path, column_types);
+
+    // 把格式字改为 0, 模拟旧格式的文件
+    rm->closeAllCurrentFile();
+    int file_id = fm->openFile(path);
+    BufType page = new unsigned int[BUF_PER_PAGE];
+    ASSERT_TRUE(fm->readPage(file_id, 0, page, 0));
+    page[RECORD_FORMAT_BUF] = 0;
+    ASSERT_TRUE(fm->writePage(file_id, 0, page, 0));
+    fm->closeFile(file_id);
+
+    std::vector<dbs::record::RecordLocation> locations;
+    for (int i = 0; i < total; i++) {
+        dbs::record::DataItem data_item;
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false, i));
+        data_item.column_ids.push_back(0);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::FLOAT, false, i * 0.5));
+        data_item.column_ids.push_back(1);
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::VARCHAR,
+                                   i % 3 == 0, "n" + std::to_string(i)));
+        data_item.column_ids.push_back(2);
+        locations.push_back(rm->insertRecord(path, data_item));
+        ASSERT_NE(locations.back().page_id, -1);
+    }
+    for (int i = 0; i < total; i += 7) {
+        ASSERT_TRUE(rm->deleteRecord(path, locations[i]));
+    }
+
+    // 去掉空闲页链表标记, 并在格式字和溢出页链表所在的 buf 中留下任意值,
+    // 模拟这些 buf 从未写过的旧文件, 这时应当按格式 0 处理
+    rm->closeAllCurrentFile();
+    file_id = fm->openFile(path);
+    page = new unsigned int[BUF_PER_PAGE];
+    ASSERT_TRUE(fm->readPage(file_id, 0, page, 0));
+    page[RECORD_FREE_LIST_BUF] = 0;
+    page[RECORD_FORMAT_BUF] = RECORD_FORMAT_PAX;
+    page[RECORD_OVERFLOW_LIST_BUF] = 12345;
+    ASSERT_TRUE(fm->writePage(file_id, 0, page, 0));
+    fm->closeFile(file_id);
+
+    std::vector<dbs::record::DataItem> before, after;
+    auto scan = [&](std::vector<dbs::record::DataItem>& data_items) {
+        auto begin = std::chrono::steady_clock::now();
+        for (int round = 0; round < 10; round++)
+            rm->getAllRecords(path, data_items, locations);
+        auto end = std::chrono::steady_clock::now();
+        int page_num = rm->getTotalPageNum(path);
+        std::cout << page_num << " pages, "
+                  << (double)data_items.size() / page_num << " rows/page, "
+                  << std::chrono::duration<double, std::milli>(end - begin)
+                             .count() /
+                         10
+                  << " ms/scan" << std::endl;
+        return page_num;
+    };
+    int page_num_before = scan(before);
+    int page_num_after = rm->compactRecordFile(path);
+    EXPECT_EQ(scan(after), page_num_after);
+    EXPECT_LT(page_num_after * 2, page_num_before + 2);
+
+    // 重排后记录的内容和顺序不变
+    ASSERT_EQ(before.size(), after.size());
+    for (size_t i = 0; i < before.size(); i++) {
+        EXPECT_EQ(before[i].data_id, after[i].data_id);
+        EXPECT_EQ(before[i].data_values[0].value.int_value,
+                  after[i].data_values[0].value.int_value);
+        EXPECT_EQ(before[i].data_values[2].is_null,
+                  after[i].data_values[2].is_null);
+        EXPECT_EQ(before[i].data_values[2].value.char_value,
+                  after[i].data_values[2].value.char_value);
+    }
+
+    // 紧凑格式下新插入的记录先填满已有的页
+    dbs::record::DataItem data_item = before[0];
+    data_item.data_values[0].value.int_value = total;
+    auto location = rm->insertRecord(path, data_item);
+    EXPECT_LE(location.page_id, page_num_after);
+    ASSERT_TRUE(rm->getRecord(path, location, data_item));
+    EXPECT_EQ(data_item.data_values[0].value.int_value, total);
+
+    // 重排时写入空闲页链表标记, 溢出页链表为空
+    rm->closeAllCurrentFile();
+    file_id = fm->openFile(path);
+    ASSERT_TRUE(fm->readPage(file_id, 0, page, 0));
+    EXPECT_EQ(page[RECORD_FREE_LIST_BUF], RECORD_FREE_LIST_MAGIC);
+    EXPECT_EQ(page[RECORD_FORMAT_BUF], RECORD_FORMAT_COMPACT);
+    EXPECT_EQ((int)page[RECORD_OVERFLOW_LIST_BUF], -1);
+    fm->closeFile(file_id);
+    delete[] page;
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, SlottedVarchar) {
+    const int total = 20000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types;
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, true,
+                                true, dbs::record::DefaultValue(), "id"));
+    column_types.push_back(dbs::record::ColumnType(
+        dbs::record::DataTypeName::VARCHAR, 255, 0, false, false,
+        dbs::record::DefaultValue(), "name"));
+    column_types.push_back(dbs::record::ColumnType(
+        dbs::record::DataTypeName::VARCHAR, 20000, 0, false, false,
+        dbs::record::DefaultValue(), "text"));
+    const char* path = "./data/slotted_bench.txt";
+    rm->initializeRecordFile(path, column_types);
+    auto makeItem = [](int id, const std::string& name,
+                       const std::string& text) {
+        dbs::record::DataItem data_item;
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false, id));
+        data_item.column_ids.push_back(0);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::VARCHAR, false, name));
+        data_item.column_ids.push_back(1);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::VARCHAR, text.empty(), text));
+        data_item.column_ids.push_back(2);
+        return data_item;
+    };
+
+    // 短字符串: 定长格式每行要为两列 VARCHAR 预留 40KB 以上
+    std::vector<dbs::record::RecordLocation> locations;
+    for (int i = 0; i < total; i++) {
+        locations.push_back(
+            rm->insertRecord(path, makeItem(i, "name" + std::to_string(i), "")));
+        ASSERT_NE(locations.back().page_id, -1);
+    }
+    int page_num = rm->getTotalPageNum(path);
+    std::cout << page_num << " pages, " << (double)total / page_num
+              << " rows/page" << std::endl;
+    EXPECT_GT(total / page_num, 200);
+
+    // 长字符串放入溢出页, 删除后溢出页被复用
+    std::string long_text(12000, 'x');
+    for (int i = 0; i < 12000; i++) long_text[i] = 'a' + i % 26;
+    auto location = rm->insertRecord(path, makeItem(-1, "long", long_text));
+    dbs::record::DataItem data_item;
+    ASSERT_TRUE(rm->getRecord(path, location, data_item));
+    EXPECT_EQ(data_item.data_values[2].value.char_value, long_text);
+    int page_num_with_overflow = rm->getTotalPageNum(path);
+    ASSERT_TRUE(rm->deleteRecord(path, location));
+    location = rm->insertRecord(path, makeItem(-2, "long", long_text));
+    EXPECT_EQ(rm->getTotalPageNum(path), page_num_with_overflow);
+
+    // 更新时变长变短, 槽号不变
+    dbs::record::DataItem update_item;
+    update_item.data_values.push_back(dbs::record::DataValue(
+        dbs::record::DataTypeName::VARCHAR, false, long_text.substr(0, 3000)));
+    update_item.column_ids.push_back(2);
+    for (int i = 0; i < total; i += 101)
+        ASSERT_TRUE(rm->updateRecord(path, locations[i], update_item));
+    update_item.data_values[0] = dbs::record::DataValue(
+        dbs::record::DataTypeName::VARCHAR, false, "short");
+    ASSERT_TRUE(rm->updateRecord(path, locations[202], update_item));
+    for (int i = 0; i < total; i += 101) {
+        ASSERT_TRUE(rm->getRecord(path, locations[i], data_item));
+        EXPECT_EQ(data_item.data_values[0].value.int_value, i);
+        EXPECT_EQ(data_item.data_values[1].value.char_value,
+                  "name" + std::to_string(i));
+        EXPECT_EQ(data_item.data_values[2].value.char_value,
+                  i == 202 ? "short" : long_text.substr(0, 3000));
+    }
+
+    // 扫描跳过溢出页
+    std::vector<dbs::record::DataItem> data_items;
+    std::vector<dbs::record::RecordLocation> record_locations;
+    rm->getAllRecords(path, data_items, record_locations);
+    EXPECT_EQ(data_items.size(), total + 1);
+    EXPECT_EQ(data_items.back().data_values[2].value.char_value, long_text);
+
+    // 放不下较长记录的页留在空闲页链表中, 之后的短记录仍填入这些页
+    for (int i = 0; i < total; i += 8)
+        ASSERT_TRUE(rm->deleteRecord(path, locations[i]));
+    page_num = rm->getTotalPageNum(path);
+    location = rm->insertRecord(
+        path, makeItem(-3, "long", long_text.substr(0, 1500)));
+    ASSERT_NE(location.page_id, -1);
+    for (int i = 0; i < total; i += 8) {
+        location =
+            rm->insertRecord(path, makeItem(i, "name" + std::to_string(i), ""));
+        ASSERT_NE(location.page_id, -1);
+    }
+    EXPECT_LE(rm->getTotalPageNum(path), page_num + 1);
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, ScanWithConstraint) {
+    const int total = 30000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types;
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, true,
+                                true, dbs::record::DefaultValue(), "id"));
+    column_types.push_back(
+        dbs::record::ColumnType(dbs::record::DataTypeName::FLOAT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "score"));
+    column_types.push_back(dbs::record::ColumnType(
+        dbs::record::DataTypeName::VARCHAR, 10, 0, false, false,
+        dbs::record::DefaultValue(), "name"));
+    const char* path = "./data/view_bench.txt";
+    rm->initializeRecordFile(path, column_types);
+    for (int i = 0; i < total; i++) {
+        dbs::record::DataItem data_item;
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false, i));
+        data_item.column_ids.push_back(0);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::FLOAT, i % 5 == 0, i * 0.5));
+        data_item.column_ids.push_back(1);
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::VARCHAR,
+                                   i % 3 == 0, "n" + std::to_string(i % 100)));
+        data_item.column_ids.push_back(2);
+        ASSERT_NE(rm->insertRecord(path, data_item).page_id, -1);
+    }
+
+    std::vector<std::vector<dbs::system::SearchConstraint>> cases = {
+        {makeConstraint(0, dbs::record::DataTypeName::INT,
+                        dbs::system::ConstraintType::LT,
+                        dbs::record::DataValue(dbs::record::DataTypeName::INT,
+                                               false, 1000))},
+        {makeConstraint(1, dbs::record::DataTypeName::FLOAT,
+                        dbs::system::ConstraintType::GEQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::FLOAT, false, 14000.0))},
+        {makeConstraint(2, dbs::record::DataTypeName::VARCHAR,
+                        dbs::system::ConstraintType::EQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::VARCHAR, false, "n7")),
+         makeConstraint(1, dbs::record::DataTypeName::FLOAT,
+                        dbs::system::ConstraintType::NEQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::FLOAT, true))},
+        {makeConstraint(2, dbs::record::DataTypeName::VARCHAR,
+                        dbs::system::ConstraintType::EQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::VARCHAR, true))},
+        {makeConstraint(0, dbs::record::DataTypeName::INT,
+                        dbs::system::ConstraintType::GT,
+                        dbs::record::DataValue(dbs::record::DataTypeName::INT,
+                                               false, 20000)),
+         makeConstraint(2, dbs::record::DataTypeName::VARCHAR,
+                        dbs::system::ConstraintType::LEQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::VARCHAR, false, "n3")),
+         makeConstraint(1, dbs::record::DataTypeName::FLOAT,
+                        dbs::system::ConstraintType::LT,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::FLOAT, false, 12000.0))},
+    };
+    for (auto& constraints : cases) {
+        // 先读出所有 DataItem 再过滤, 作为对照
+        std::vector<dbs::record::DataItem> all_items, expected, result;
+        std::vector<dbs::record::RecordLocation> all_locations,
+            expected_locations, result_locations;
+        auto begin = std::chrono::steady_clock::now();
+        rm->getAllRecords(path, all_items, all_locations);
+        dbs::system::filterConstraints(constraints, all_items, all_locations,
+                                       expected, expected_locations);
+        auto middle = std::chrono::steady_clock::now();
+        rm->getAllRecordWithConstraint(path, result, result_locations,
+                                       constraints);
+        auto end = std::chrono::steady_clock::now();
+        std::cout << expected.size() << " rows, materialize then filter "
+                  << std::chrono::duration<double, std::milli>(middle - begin)
+                         .count()
+                  << " ms, filter on page "
+                  << std::chrono::duration<double, std::milli>(end - middle)
+                         .count()
+                  << " ms" << std::endl;
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_TRUE(expected[i].same(result[i]));
+            EXPECT_EQ(expected_locations[i].page_id,
+                      result_locations[i].page_id);
+            EXPECT_EQ(expected_locations[i].slot_id,
+                      result_locations[i].slot_id);
+        }
+
+        // 按位置读取 (走索引时) 也在页上过滤
+        rm->getRecordsWithConstraint(path, all_locations, constraints, result,
+                                     result_locations);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_TRUE(expected[i].same(result[i]));
+            EXPECT_EQ(expected_locations[i].slot_id,
+                      result_locations[i].slot_id);
+        }
+
+        // 指定输出列时只读出这些列
+        std::vector<int> output_column_ids = {2, 0};
+        rm->getAllRecordWithConstraint(path, result, result_locations,
+                                       constraints, &output_column_ids);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            ASSERT_EQ(result[i].column_ids, output_column_ids);
+            EXPECT_TRUE(result[i].data_values[0].same(
+                expected[i].data_values[2]));
+            EXPECT_TRUE(result[i].data_values[1].same(
+                expected[i].data_values[0]));
+        }
+    }
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, DataItemSortAndJoin) {
+    const int total = 200000;
+    std::vector<dbs::record::DataItem> left, right;
+    for (int i = 0; i < total; i++) {
+        dbs::record::DataItem data_item;
+        data_item.data_id = i;
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false, i));
+        data_item.column_ids.push_back(0);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::INT, false, (i * 7919) % total));
+        data_item.column_ids.push_back(1);
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::FLOAT, false, i * 0.25));
+        data_item.column_ids.push_back(2);
+        data_item.data_values.push_back(
+            dbs::record::DataValue(dbs::record::DataTypeName::VARCHAR, false,
+                                   "name" + std::to_string(i % 1000)));
+        data_item.column_ids.push_back(3);
+        left.push_back(data_item);
+        if (i % 2 == 0) right.push_back(data_item);
+    }
+    // 左表 total 行, 右表 total / 2 行, 每行 4 个值
+    double bytes = (double)total * 1.5 * 4 * sizeof(dbs::record::DataValue);
+    std::cout << "sizeof(DataValue) = " << sizeof(dbs::record::DataValue)
+              << std::endl;
+
+    // 与 visitSelect_table 的多表连接一样, 先按连接列排序再归并
+    auto begin = std::chrono::steady_clock::now();
+    auto byKey = [](const dbs::record::DataItem& a,
+                    const dbs::record::DataItem& b) {
+        return a.data_values[1] < b.data_values[1];
+    };
+    std::sort(left.begin(), left.end(), byKey);
+    std::sort(right.begin(), right.end(), byKey);
+    auto middle = std::chrono::steady_clock::now();
+    std::vector<dbs::record::DataItem> joined;
+    size_t j = 0;
+    for (auto& data_item : left) {
+        while (j < right.size() &&
+               right[j].data_values[1] < data_item.data_values[1])
+            j++;
+        if (j < right.size() &&
+            right[j].data_values[1] == data_item.data_values[1]) {
+            dbs::record::DataItem new_data = data_item;
+            for (size_t k = 0; k < right[j].data_values.size(); k++) {
+                new_data.data_values.push_back(right[j].data_values[k]);
+                new_data.column_ids.push_back(right[j].column_ids[k] + 4);
+            }
+            joined.push_back(std::move(new_data));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double sort_ms =
+        std::chrono::duration<double, std::milli>(middle - begin).count();
+    double join_ms =
+        std::chrono::duration<double, std::milli>(end - middle).count();
+    std::cout << "values " << bytes / 1e6 << " MB, sort " << sort_ms
+              << " ms, join " << join_ms << " ms" << std::endl;
+
+    for (size_t i = 1; i < left.size(); i++) {
+        ASSERT_FALSE(byKey(left[i], left[i - 1]));
+    }
+    ASSERT_EQ(joined.size(), right.size());
+    for (auto& data_item : joined) {
+        ASSERT_EQ(data_item.data_values.size(), 8);
+        EXPECT_TRUE(data_item.data_values[1].same(data_item.data_values[5]));
+        EXPECT_EQ(data_item.data_values[3].value.char_value,
+                  data_item.data_values[7].value.char_value);
+    }
+}
+
+TEST(RecordTest, FilterKernels) {
+    // 构造一个定长格式的页: id, null 位图, INT, FLOAT, DATE
+    const int stride = 6;
+    const int slot_num = (BUF_PER_PAGE - RECORD_PAGE_HEADER / BYTE_PER_BUF) /
+                         stride;  // 不是 8 的倍数, 覆盖逐个比较的尾部
+    unsigned int page[BUF_PER_PAGE] = {};
+    unsigned int* records = page + RECORD_PAGE_HEADER / BYTE_PER_BUF;
+    srand(17);
+    for (int slot = 0; slot < slot_num; slot++) {
+        unsigned int* record = records + slot * stride;
+        record[0] = slot;
+        record[1] = rand() % 7 == 0 ? 0x7 : 0;
+        record[2] = dbs::utils::int2bit32(rand() % 41 - 20);
+        double value = slot % 53 == 0 ? NAN : (rand() % 41 - 20) * 0.5;
+        dbs::utils::float2bit32(value, record[3], record[4]);
+        dbs::utils::set2Bytes(record[5], 0, 2000 + rand() % 3);
+        dbs::utils::set1Byte(record[5], 2, rand() % 13);
+        dbs::utils::set1Byte(record[5], 3, rand() % 29);
+        if (rand() % 3 != 0) dbs::utils::setBitFromBuf(page, slot, true);
+    }
+    auto stripe = [&](int offset, int column_index) {
+        return dbs::record::ColumnStripe{records + offset, records + 1,
+                                         1U << column_index, stride, stride};
+    };
+    auto expect = [](dbs::system::ConstraintType constraint_type, bool less,
+                     bool equal) {
+        switch (constraint_type) {
+            case dbs::system::ConstraintType::EQ:
+                return equal;
+            case dbs::system::ConstraintType::NEQ:
+                return !equal;
+            case dbs::system::ConstraintType::GT:
+                return !less && !equal;
+            case dbs::system::ConstraintType::GEQ:
+                return !less;
+            case dbs::system::ConstraintType::LT:
+                return less;
+            default:
+                return less || equal;
+        }
+    };
+    auto check = [&](const unsigned int* selection, auto valid) {
+        for (int slot = 0; slot < slot_num; slot++) {
+            bool occupied = dbs::utils::getBitFromBuf(page, slot);
+            ASSERT_EQ(dbs::utils::getBitFromBuf((BufType)selection, slot),
+                      occupied && valid(records + slot * stride))
+                << "slot " << slot;
+        }
+    };
+    std::vector<dbs::system::ConstraintType> constraint_types = {
+        dbs::system::ConstraintType::EQ,  dbs::system::ConstraintType::NEQ,
+        dbs::system::ConstraintType::GT,  dbs::system::ConstraintType::GEQ,
+        dbs::system::ConstraintType::LT,  dbs::system::ConstraintType::LEQ};
+    unsigned int selection[MAX_ITEM_PER_PAGE / BIT_PER_BUF];
+    for (auto constraint_type : constraint_types) {
+        bool null_valid = constraint_type == dbs::system::ConstraintType::NEQ;
+        for (int target : {-21, -3, 0, 7, 20}) {
+            memcpy(selection, page, sizeof(selection));
+            dbs::record::filterInt(stripe(2, 0), constraint_type, target,
+                                   slot_num, selection);
+            check(selection, [&](const unsigned int* record) {
+                if (record[1] & 1) return null_valid;
+                int value = dbs::utils::bit322int(record[2]);
+                return expect(constraint_type, value < target,
+                              value == target);
+            });
+        }
+        for (double target : {-10.5, -0.0, 3.5, 4.25, (double)NAN}) {
+            memcpy(selection, page, sizeof(selection));
+            dbs::record::filterFloat(stripe(3, 1), constraint_type, target,
+                                     slot_num, selection);
+            check(selection, [&](const unsigned int* record) {
+                if (record[1] & 2) return null_valid;
+                double value = dbs::utils::bit322float(record[3], record[4]);
+                return expect(constraint_type, value < target,
+                              value == target);
+            });
+        }
+        // 月份和日期超出一个字节的约束值也要与逐字段比较一致
+        for (auto target :
+             {dbs::record::DateValue(2001, 6, 10),
+              dbs::record::DateValue(2001, 200, 1),
+              dbs::record::DateValue(2001, -200, 1),
+              dbs::record::DateValue(2002, 12, 300),
+              dbs::record::DateValue(1999, 1, 1)}) {
+            memcpy(selection, page, sizeof(selection));
+            dbs::record::filterDate(stripe(5, 2), constraint_type, target,
+                                    slot_num, selection);
+            check(selection, [&](const unsigned int* record) {
+                if (record[1] & 4) return null_valid;
+                dbs::record::DateValue value(
+                    dbs::utils::get2Bytes(record[5], 0),
+                    dbs::utils::get1Byte(record[5], 2),
+                    dbs::utils::get1Byte(record[5], 3));
+                auto a = std::tie(value.year, value.month, value.day);
+                auto b = std::tie(target.year, target.month, target.day);
+                return expect(constraint_type, a < b, a == b);
+            });
+        }
+    }
+    for (bool is_null : {true, false}) {
+        memcpy(selection, page, sizeof(selection));
+        dbs::record::filterNull(stripe(2, 0), is_null, slot_num, selection);
+        check(selection, [&](const unsigned int* record) {
+            return (bool)(record[1] & 1) == is_null;
+        });
+    }
+
+    // 与逐行读出再比较的耗时对比
+    const int rounds = 20000;
+    int count = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (int round = 0; round < rounds; round++) {
+        for (int slot = 0; slot < slot_num; slot++) {
+            if (!dbs::utils::getBitFromBuf(page, slot)) continue;
+            const unsigned int* record = records + slot * stride;
+            if (record[1] & 3) continue;
+            if (dbs::utils::bit322int(record[2]) >= 5) continue;
+            // 与 RecordFilter 一致, GT 即既不小于也不等于
+            double value = dbs::utils::bit322float(record[3], record[4]);
+            if (value < -4.0 || value == -4.0) continue;
+            count++;
+        }
+    }
+    auto middle = std::chrono::steady_clock::now();
+    int batch_count = 0;
+    for (int round = 0; round < rounds; round++) {
+        memcpy(selection, page, sizeof(selection));
+        dbs::record::filterInt(stripe(2, 0), dbs::system::ConstraintType::LT,
+                               5, slot_num, selection);
+        dbs::record::filterFloat(stripe(3, 1),
+                                 dbs::system::ConstraintType::GT, -4.0,
+                                 slot_num, selection);
+        for (int i = 0; i < MAX_ITEM_PER_PAGE / BIT_PER_BUF; i++)
+            batch_count += __builtin_popcount(selection[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    EXPECT_EQ(count, batch_count);
+    std::cout << "filter " << rounds << " pages, row by row "
+              << std::chrono::duration<double, std::milli>(middle - begin)
+                     .count()
+              << " ms, batch "
+              << std::chrono::duration<double, std::milli>(end - middle)
+                     .count()
+              << " ms" << std::endl;
+}
+
+TEST(RecordTest, PaxFormat) {
+    const int total = 20000;
+    const int column_num = 60;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types;
+    for (int i = 0; i < column_num; i++) {
+        auto type_name = i % 3 == 0   ? dbs::record::DataTypeName::INT
+                         : i % 3 == 1 ? dbs::record::DataTypeName::FLOAT
+                                      : dbs::record::DataTypeName::VARCHAR;
+        column_types.push_back(dbs::record::ColumnType(
+            type_name, 6, 0, false, false, dbs::record::DefaultValue(),
+            "c" + std::to_string(i)));
+    }
+    const char* compact_path = "./data/pax_compact.txt";
+    const char* pax_path = "./data/pax_bench.txt";
+    rm->initializeRecordFile(compact_path, column_types);
+    rm->initializeRecordFile(pax_path, column_types, RECORD_FORMAT_PAX);
+
+    auto makeItem = [&](int i) {
+        dbs::record::DataItem data_item;
+        for (int j = 0; j < column_num; j++) {
+            bool is_null = j > 0 && (i + j) % 11 == 0;
+            switch (j % 3) {
+                case 0:
+                    data_item.data_values.push_back(dbs::record::DataValue(
+                        dbs::record::DataTypeName::INT, is_null, i * j));
+                    break;
+                case 1:
+                    data_item.data_values.push_back(
+                        dbs::record::DataValue(dbs::record::DataTypeName::FLOAT,
+                                               is_null, i + j * 0.5));
+                    break;
+                default:
+                    data_item.data_values.push_back(dbs::record::DataValue(
+                        dbs::record::DataTypeName::VARCHAR, is_null,
+                        std::to_string(i % 1000 + j)));
+                    break;
+            }
+            data_item.column_ids.push_back(j);
+        }
+        return data_item;
+    };
+    std::vector<dbs::record::RecordLocation> compact_locations, pax_locations;
+    for (int i = 0; i < total; i++) {
+        auto data_item = makeItem(i);
+        compact_locations.push_back(rm->insertRecord(compact_path, data_item));
+        pax_locations.push_back(rm->insertRecord(pax_path, data_item));
+        ASSERT_NE(pax_locations.back().page_id, -1);
+    }
+    // 两种格式每页的槽数相同, 位置也相同
+    EXPECT_EQ(rm->getTotalPageNum(compact_path), rm->getTotalPageNum(pax_path));
+    for (int i = 0; i < total; i += 5) {
+        ASSERT_TRUE(rm->deleteRecord(compact_path, compact_locations[i]));
+        ASSERT_TRUE(rm->deleteRecord(pax_path, pax_locations[i]));
+    }
+    dbs::record::DataItem update;
+    update.column_ids = {2, 31};
+    update.data_values.push_back(dbs::record::DataValue(
+        dbs::record::DataTypeName::VARCHAR, false, "upd"));
+    update.data_values.push_back(
+        dbs::record::DataValue(dbs::record::DataTypeName::FLOAT, true));
+    for (int i = 1; i < total; i += 13) {
+        if (i % 5 == 0) continue;
+        ASSERT_TRUE(
+            rm->updateRecord(compact_path, compact_locations[i], update));
+        ASSERT_TRUE(rm->updateRecord(pax_path, pax_locations[i], update));
+    }
+
+    auto expectSame = [&]() {
+        std::vector<dbs::record::DataItem> expected, result;
+        std::vector<dbs::record::RecordLocation> expected_locations,
+            result_locations;
+        rm->getAllRecords(compact_path, expected, expected_locations);
+        rm->getAllRecords(pax_path, result, result_locations);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_EQ(expected[i].data_id, result[i].data_id);
+            EXPECT_TRUE(expected[i].same(result[i]));
+        }
+    };
+    expectSame();
+
+    // 只读一列并按另一列过滤, PAX 格式只访问这两列的 minipage
+    dbs::system::SearchConstraint constraint;
+    constraint.column_id = 3;
+    constraint.data_type = dbs::record::DataTypeName::INT;
+    constraint.constraint_types.push_back(dbs::system::ConstraintType::GEQ);
+    constraint.constraint_values.push_back(
+        dbs::record::DataValue(dbs::record::DataTypeName::INT, false, 30000));
+    std::vector<dbs::system::SearchConstraint> constraints = {constraint};
+    std::vector<int> output_column_ids = {58};
+    auto scan = [&](const char* path,
+                    std::vector<dbs::record::DataItem>& data_items) {
+        std::vector<dbs::record::RecordLocation> locations;
+        auto begin = std::chrono::steady_clock::now();
+        for (int round = 0; round < 10; round++)
+            rm->getAllRecordWithConstraint(path, data_items, locations,
+                                           constraints, &output_column_ids);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - begin).count() /
+               10;
+    };
+    std::vector<dbs::record::DataItem> compact_items, pax_items;
+    double compact_ms = scan(compact_path, compact_items);
+    double pax_ms = scan(pax_path, pax_items);
+    std::cout << compact_items.size() << " rows, compact " << compact_ms
+              << " ms/scan, pax " << pax_ms << " ms/scan" << std::endl;
+    ASSERT_EQ(compact_items.size(), pax_items.size());
+    for (size_t i = 0; i < compact_items.size(); i++)
+        EXPECT_TRUE(compact_items[i].same(pax_items[i]));
+
+    // 重排后仍为 PAX 格式, 内容和顺序不变
+    rm->compactRecordFile(compact_path);
+    rm->compactRecordFile(pax_path);
+    expectSame();
+
+    ASSERT_TRUE(rm->deleteRecordFile(compact_path));
+    ASSERT_TRUE(rm->deleteRecordFile(pax_path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, ZoneMap) {
+    const int total = 50000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types = {
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "t"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::FLOAT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "v"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::DATE, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "d"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::VARCHAR, 16, 0,
+                                false, false, dbs::record::DefaultValue(),
+                                "s")};
+    const char* path = "./data/zone_map.txt";
+    rm->initializeRecordFile(path, column_types);
+
+    // 按时间顺序插入, 每页的 t 和 d 只覆盖一小段
+    std::vector<dbs::record::RecordLocation> locations;
+    for (int i = 0; i < total; i++) {
+        dbs::record::DataItem data_item;
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::INT, i % 97 == 0, i * 2));
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::FLOAT, false, (i % 1000) * 0.5));
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::DATE, false,
+            dbs::record::DateValue{2000 + i / 5000, i / 500 % 10 + 1,
+                                   i / 20 % 25 + 1}));
+        data_item.data_values.push_back(dbs::record::DataValue(
+            dbs::record::DataTypeName::VARCHAR, false, std::to_string(i)));
+        for (int j = 0; j < 4; j++) data_item.column_ids.push_back(j);
+        locations.push_back(rm->insertRecord(path, data_item));
+    }
+
+    auto intConstraint = [](dbs::system::ConstraintType constraint_type,
+                             int value) {
+        return makeConstraint(
+            0, dbs::record::DataTypeName::INT, constraint_type,
+            dbs::record::DataValue(dbs::record::DataTypeName::INT, false,
+                                   value));
+    };
+    std::vector<std::vector<dbs::system::SearchConstraint>> cases = {
+        {intConstraint(dbs::system::ConstraintType::GEQ, 60000),
+         intConstraint(dbs::system::ConstraintType::LT, 60400)},
+        {intConstraint(dbs::system::ConstraintType::EQ, 12346)},
+        {intConstraint(dbs::system::ConstraintType::GT, 99990)},
+        {makeConstraint(2, dbs::record::DataTypeName::DATE,
+                        dbs::system::ConstraintType::LT,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::DATE, false,
+                            dbs::record::DateValue{2000, 2, 1}))},
+        {makeConstraint(0, dbs::record::DataTypeName::INT,
+                        dbs::system::ConstraintType::EQ,
+                        dbs::record::DataValue(dbs::record::DataTypeName::INT,
+                                               true)),
+         makeConstraint(1, dbs::record::DataTypeName::FLOAT,
+                        dbs::system::ConstraintType::LEQ,
+                        dbs::record::DataValue(
+                            dbs::record::DataTypeName::FLOAT, false, 1.0))},
+    };
+    auto expectSame = [&](const std::vector<dbs::system::SearchConstraint>&
+                              constraints) {
+        std::vector<dbs::record::DataItem> all_items, expected, result;
+        std::vector<dbs::record::RecordLocation> all_locations,
+            expected_locations, result_locations;
+        rm->getAllRecords(path, all_items, all_locations);
+        dbs::system::filterConstraints(constraints, all_items, all_locations,
+                                       expected, expected_locations);
+        rm->getAllRecordWithConstraint(path, result, result_locations,
+                                       constraints);
+        ASSERT_EQ(expected.size(), result.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            EXPECT_TRUE(expected[i].same(result[i]));
+            EXPECT_EQ(expected_locations[i].page_id,
+                      result_locations[i].page_id);
+            EXPECT_EQ(expected_locations[i].slot_id,
+                      result_locations[i].slot_id);
+        }
+    };
+    for (auto& constraints : cases) expectSame(constraints);
+
+    // 页摘要在创建时建立, 范围查询只读少数页
+    std::vector<dbs::record::DataItem> result;
+    std::vector<dbs::record::RecordLocation> result_locations;
+    auto begin = std::chrono::steady_clock::now();
+    for (int round = 0; round < 10; round++)
+        rm->getAllRecordWithConstraint(path, result, result_locations,
+                                       cases[0]);
+    auto middle = std::chrono::steady_clock::now();
+    std::vector<dbs::system::SearchConstraint> no_skip = {
+        makeConstraint(3, dbs::record::DataTypeName::VARCHAR,
+                       dbs::system::ConstraintType::EQ,
+                       dbs::record::DataValue(
+                           dbs::record::DataTypeName::VARCHAR, false, "30100"))};
+    for (int round = 0; round < 10; round++)
+        rm->getAllRecordWithConstraint(path, result, result_locations,
+                                       no_skip);
+    auto end = std::chrono::steady_clock::now();
+    std::cout << "range scan with zone map "
+              << std::chrono::duration<double, std::milli>(middle - begin)
+                         .count() /
+                     10
+              << " ms, full scan "
+              << std::chrono::duration<double, std::milli>(end - middle)
+                         .count() /
+                     10
+              << " ms" << std::endl;
+
+    // 更新到原来被排除的页的范围外, 删除后再查询
+    dbs::record::DataItem update;
+    update.column_ids = {0};
+    update.data_values.push_back(
+        dbs::record::DataValue(dbs::record::DataTypeName::INT, false, 60001));
+    ASSERT_TRUE(rm->updateRecord(path, locations[5], update));
+    update.data_values[0] =
+        dbs::record::DataValue(dbs::record::DataTypeName::INT, true);
+    ASSERT_TRUE(rm->updateRecord(path, locations[total - 2], update));
+    for (int i = 30000; i < 30150; i++)
+        ASSERT_TRUE(rm->deleteRecord(path, locations[i]));
+    for (auto& constraints : cases) expectSame(constraints);
+
+    // 重排后页摘要在下一次扫描时重新建立
+    rm->compactRecordFile(path);
+    for (auto& constraints : cases) expectSame(constraints);
+    for (auto& constraints : cases) expectSame(constraints);
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}
+
+TEST(RecordTest, CsvLoad) {
+    // 调大 total 即可在数 GB 的文件上测吞吐
+    const int total = 400000;
+    dbs::fs::FileManager* fm = new dbs::fs::FileManager();
+    dbs::fs::BufPageManager* bpm = new dbs::fs::BufPageManager(fm);
+    dbs::record::RecordManager* rm = new dbs::record::RecordManager(fm, bpm);
+    if (!fm->existFolder("./data")) fm->createFolder("./data");
+    std::vector<dbs::record::ColumnType> column_types = {
+        dbs::record::ColumnType(dbs::record::DataTypeName::INT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "id"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::FLOAT, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "f"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::VARCHAR, 24, 0,
+                                false, false, dbs::record::DefaultValue(),
+                                "s"),
+        dbs::record::ColumnType(dbs::record::DataTypeName::DATE, 0, 0, false,
+                                false, dbs::record::DefaultValue(), "d")};
+    for (size_t i = 0; i < column_types.size(); i++)
+        column_types[i].column_id = i;
+
+    // 单独解析一行: 与 stoi 和 istream 相同地处理空白, '+' 和无法解析的 FLOAT
+    dbs::record::CsvReader reader(column_types, ',');
+    dbs::record::DataItem data_item;
+    ASSERT_TRUE(reader.parseLine(" +12,abc,x y,2023-1-09", data_item));
+    EXPECT_EQ(data_item.data_values[0].value.int_value, 12);
+    EXPECT_EQ(data_item.data_values[1].value.float_value, 0);
+    EXPECT_EQ(data_item.data_values[2].value.char_value.str(), "x y");
+    EXPECT_EQ(data_item.data_values[3].value.date_value.year, 2023);
+    EXPECT_EQ(data_item.data_values[3].value.date_value.month, 1);
+    EXPECT_EQ(data_item.data_values[3].value.date_value.day, 9);
+    EXPECT_FALSE(reader.parseLine("1,2.5,s", data_item));
+    EXPECT_FALSE(reader.parseLine("1,2.5,s,2023-1-1,x", data_item));
+    EXPECT_FALSE(reader.parseLine("x,2.5,s,2023-1-1", data_item));
+    EXPECT_FALSE(reader.parseLine("1,2.5,s,20230101", data_item));
+
+    const char* csv_path = "./data/csv_load.csv";
+    {
+        std::ofstream csv_file(csv_path);
+        for (int i = 0; i < total; i++) {
+            csv_file << i << ',' << std::to_string(i * 0.25) << ",name" << i % 1000 << ','
+                     << 1990 + i % 30 << '-' << i % 12 + 1 << '-'
+                     << i % 28 + 1;
+            // 最后一行没有换行符
+            if (i + 1 < total) csv_file << '\n';
+        }
+    }
+    const char* path = "./data/csv_load.txt";
+    rm->initializeRecordFile(path, column_types);
+    std::vector<dbs::record::RecordLocation> locations;
+    auto begin = std::chrono::steady_clock::now();
+    int data_item_per_page = rm->insertRecordsToEmptyRecord(
+        path, csv_path, ",", false,
+        [&](const dbs::record::DataItem& data_item,
+            const dbs::record::RecordLocation& location) {
+            locations.push_back(location);
+        });
+    auto end = std::chrono::steady_clock::now();
+    ASSERT_NE(data_item_per_page, -1);
+    ASSERT_TRUE(reader.open(csv_path));
+    double mb = (double)reader.size() / (1 << 20);
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count();
+    std::cout << total << " rows, " << mb << " MB, " << ms << " ms, "
+              << mb / (ms / 1000) << " MB/s" << std::endl;
+
+    std::vector<dbs::record::DataItem> data_items;
+    std::vector<dbs::record::RecordLocation> result_locations;
+    rm->getAllRecords(path, data_items, result_locations);
+    ASSERT_EQ(data_items.size(), total);
+    ASSERT_EQ(locations.size(), total);
+    for (int i = 0; i < total; i += 997) {
+        auto& data_values = data_items[i].data_values;
+        EXPECT_EQ(data_values[0].value.int_value, i);
+        EXPECT_EQ(data_values[1].value.float_value, i * 0.25);
+        EXPECT_EQ(data_values[2].value.char_value.str(),
+                  "name" + std::to_string(i % 1000));
+        EXPECT_EQ(data_values[3].value.date_value.day, i % 28 + 1);
+        EXPECT_EQ(locations[i].page_id, result_locations[i].page_id);
+        EXPECT_EQ(locations[i].slot_id, result_locations[i].slot_id);
+    }
+
+    // 格式错误时返回 -1
+    {
+        std::ofstream csv_file(csv_path);
+        csv_file << "1,1.5,a,2000-1-1\n2,2.5,b\n";
+    }
+    EXPECT_EQ(rm->insertRecordsToEmptyRecord(path, csv_path, ",", false), -1);
+
+    ASSERT_TRUE(rm->deleteRecordFile(path));
+    delete rm;
+    delete bpm;
+    delete fm;
+}